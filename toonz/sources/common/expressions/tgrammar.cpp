@@ -14,6 +14,9 @@
 
 // STD includes
 #include <map>
+#include <tuple>
+#include <cstdint>
+#include <cstring>
 #include <math.h>
 #include <functional>
 #include <memory>
@@ -86,6 +89,226 @@ public:
   }
 };
 
+//===================================================================
+//
+// CalculatorProgram
+//
+//   A calculator node tree flattened to a sequence of instructions
+//   working on numbered registers. Identical subexpressions are
+//   computed once, and functions of constants are folded.
+//
+//-------------------------------------------------------------------
+
+class CalculatorProgram {
+public:
+  typedef double (*Function1)(double);
+  typedef double (*Function2)(double, double);
+  typedef double (*Function3)(double, double, double);
+
+private:
+  enum OpCode {
+    Value,
+    Variable,
+    Negate,
+    Not,
+    Apply1,
+    Apply2,
+    Apply3,
+    Call,
+    Move,
+    Jump,
+    JumpIfZero
+  };
+
+  struct Instruction {
+    OpCode m_code;
+    int m_dst;
+    int m_a, m_b, m_c;  //!< Source registers (m_b is the target of jumps)
+    double m_value;
+    void (*m_function)();  //!< One of the FunctionN types
+    const CalculatorNode *m_node;
+  };
+
+  // opcode, function, operands and value bits of an instruction, used to
+  // find instructions computing the same thing
+  typedef std::tuple<int, std::uintptr_t, int, int, int, std::uint64_t> Key;
+
+  std::vector<Instruction> m_instructions;
+  std::map<Key, int> m_registerByKey;
+  std::vector<std::pair<bool, double>> m_constants;  //!< By register
+  int m_result;
+
+public:
+  CalculatorProgram() : m_result(-1) {}
+
+  void compile(const CalculatorNode *root) { m_result = root->compile(*this); }
+
+  int addValue(double value) { return add(Value, nullptr, -1, -1, -1, value); }
+  int addVariable(int varIdx) {
+    return add(Variable, nullptr, varIdx, -1, -1, 0);
+  }
+  int addNegate(int a) {
+    if (m_constants[a].first) return addValue(-m_constants[a].second);
+    return add(Negate, nullptr, a, -1, -1, 0);
+  }
+  int addNot(int a) {
+    if (m_constants[a].first) return addValue(m_constants[a].second == 0);
+    return add(Not, nullptr, a, -1, -1, 0);
+  }
+  int addFunction(Function1 f, int a) {
+    if (m_constants[a].first) return addValue(f(m_constants[a].second));
+    return add(Apply1, (void (*)())f, a, -1, -1, 0);
+  }
+  int addFunction(Function2 f, int a, int b) {
+    if (m_constants[a].first && m_constants[b].first)
+      return addValue(f(m_constants[a].second, m_constants[b].second));
+    return add(Apply2, (void (*)())f, a, b, -1, 0);
+  }
+  int addFunction(Function3 f, int a, int b, int c) {
+    if (m_constants[a].first && m_constants[b].first && m_constants[c].first)
+      return addValue(f(m_constants[a].second, m_constants[b].second,
+                        m_constants[c].second));
+    return add(Apply3, (void (*)())f, a, b, c, 0);
+  }
+
+  //! Nodes called as a whole are never shared, since they may depend on
+  //! data other than their arguments.
+  int addCall(const CalculatorNode *node) {
+    Instruction instruction = {Call, newRegister(), -1, -1, -1, 0, nullptr,
+                               node};
+    m_instructions.push_back(instruction);
+    return instruction.m_dst;
+  }
+
+  int addCondition(const CalculatorNode *a, const CalculatorNode *b,
+                   const CalculatorNode *c) {
+    int cond = a->compile(*this);
+    if (m_constants[cond].first)
+      return (m_constants[cond].second != 0) ? b->compile(*this)
+                                             : c->compile(*this);
+
+    int dst = newRegister();
+
+    // Subexpressions found inside a branch are not available outside it
+    std::map<Key, int> registerByKey = m_registerByKey;
+
+    int jumpToC = addJump(JumpIfZero, cond);
+    addMove(dst, b->compile(*this));
+    int jumpToEnd               = addJump(Jump, -1);
+    m_registerByKey             = registerByKey;
+    m_instructions[jumpToC].m_b = (int)m_instructions.size();
+
+    addMove(dst, c->compile(*this));
+    m_registerByKey               = registerByKey;
+    m_instructions[jumpToEnd].m_b = (int)m_instructions.size();
+    return dst;
+  }
+
+  double run(double vars[3]) const {
+    double localRegisters[32];
+    std::vector<double> allocatedRegisters;
+    double *r = localRegisters;
+    if (m_constants.size() > 32) {
+      allocatedRegisters.resize(m_constants.size());
+      r = &allocatedRegisters[0];
+    }
+
+    int count = (int)m_instructions.size();
+    for (int i = 0; i < count;) {
+      const Instruction &ins = m_instructions[i++];
+      switch (ins.m_code) {
+      case Value:
+        r[ins.m_dst] = ins.m_value;
+        break;
+      case Variable:
+        r[ins.m_dst] = vars[ins.m_a];
+        break;
+      case Negate:
+        r[ins.m_dst] = -r[ins.m_a];
+        break;
+      case Not:
+        r[ins.m_dst] = r[ins.m_a] == 0;
+        break;
+      case Apply1:
+        r[ins.m_dst] = ((Function1)ins.m_function)(r[ins.m_a]);
+        break;
+      case Apply2:
+        r[ins.m_dst] = ((Function2)ins.m_function)(r[ins.m_a], r[ins.m_b]);
+        break;
+      case Apply3:
+        r[ins.m_dst] =
+            ((Function3)ins.m_function)(r[ins.m_a], r[ins.m_b], r[ins.m_c]);
+        break;
+      case Call:
+        r[ins.m_dst] = ins.m_node->compute(vars);
+        break;
+      case Move:
+        r[ins.m_dst] = r[ins.m_a];
+        break;
+      case Jump:
+        i = ins.m_b;
+        break;
+      case JumpIfZero:
+        if (r[ins.m_a] == 0) i = ins.m_b;
+        break;
+      }
+    }
+    return r[m_result];
+  }
+
+private:
+  int newRegister() {
+    m_constants.push_back(std::make_pair(false, 0.0));
+    return (int)m_constants.size() - 1;
+  }
+
+  int add(OpCode code, void (*function)(), int a, int b, int c,
+          double value) {
+    std::uint64_t valueBits;
+    std::memcpy(&valueBits, &value, sizeof(value));
+    Key key(code, reinterpret_cast<std::uintptr_t>(function), a, b, c,
+            valueBits);
+    std::map<Key, int>::iterator it = m_registerByKey.find(key);
+    if (it != m_registerByKey.end()) return it->second;
+
+    Instruction instruction = {code, newRegister(), a, b, c, value,
+                               function, nullptr};
+    m_instructions.push_back(instruction);
+    if (code == Value)
+      m_constants[instruction.m_dst] = std::make_pair(true, value);
+    m_registerByKey[key] = instruction.m_dst;
+    return instruction.m_dst;
+  }
+
+  void addMove(int dst, int src) {
+    Instruction instruction = {Move, dst, src, -1, -1, 0, nullptr, nullptr};
+    m_instructions.push_back(instruction);
+  }
+
+  int addJump(OpCode code, int cond) {
+    Instruction instruction = {code, -1, cond, -1, -1, 0, nullptr, nullptr};
+    m_instructions.push_back(instruction);
+    return (int)m_instructions.size() - 1;
+  }
+};
+
+//-------------------------------------------------------------------
+
+template <class Op>
+double apply1(double a) {
+  return Op()(a);
+}
+
+template <class Op>
+double apply2(double a, double b) {
+  return Op()(a, b);
+}
+
+template <class Op>
+double apply3(double a, double b, double c) {
+  return Op()(a, b, c);
+}
+
 //===================================================================
 // Calculator
 //-------------------------------------------------------------------
@@ -102,9 +325,45 @@ void Calculator::setRootNode(CalculatorNode *node) {
   if (node != m_rootNode) {
     delete m_rootNode;
     m_rootNode = node;
+
+    // The tree is complete when it becomes the root: compile it once here,
+    // so that compute() stays reentrant
+    m_program.reset();
+    if (m_rootNode) {
+      m_program.reset(new CalculatorProgram());
+      m_program->compile(m_rootNode);
+    }
   }
 }
 
+//-------------------------------------------------------------------
+
+double Calculator::compute(double t, double frame, double rframe) {
+  double vars[3];
+  vars[0] = t, vars[1] = frame, vars[2] = rframe;
+  return m_program ? m_program->run(vars) : m_rootNode->compute(vars);
+}
+
+//===================================================================
+// Node compilation
+//-------------------------------------------------------------------
+
+int CalculatorNode::compile(CalculatorProgram &program) const {
+  return program.addCall(this);
+}
+
+//-------------------------------------------------------------------
+
+int NumberNode::compile(CalculatorProgram &program) const {
+  return program.addValue(m_value);
+}
+
+//-------------------------------------------------------------------
+
+int VariableNode::compile(CalculatorProgram &program) const {
+  return program.addVariable(m_varIdx);
+}
+
 //===================================================================
 // Nodes
 //-------------------------------------------------------------------
@@ -135,6 +394,10 @@ public:
     return op(m_a->compute(vars));
   }
 
+  int compile(CalculatorProgram &program) const override {
+    return program.addFunction(&apply1<Op>, m_a->compile(program));
+  }
+
   void accept(CalculatorNodeVisitor &visitor) override { m_a->accept(visitor); }
 };
 
@@ -154,6 +417,11 @@ public:
     return op(m_a->compute(vars), m_b->compute(vars));
   }
 
+  int compile(CalculatorProgram &program) const override {
+    int a = m_a->compile(program);
+    return program.addFunction(&apply2<Op>, a, m_b->compile(program));
+  }
+
   void accept(CalculatorNodeVisitor &visitor) override {
     m_a->accept(visitor), m_b->accept(visitor);
   }
@@ -176,6 +444,11 @@ public:
     return op(m_a->compute(vars), m_b->compute(vars), m_c->compute(vars));
   }
 
+  int compile(CalculatorProgram &program) const override {
+    int a = m_a->compile(program), b = m_b->compile(program);
+    return program.addFunction(&apply3<Op>, a, b, m_c->compile(program));
+  }
+
   void accept(CalculatorNodeVisitor &visitor) override {
     m_a->accept(visitor), m_b->accept(visitor), m_c->accept(visitor);
   }
@@ -190,6 +463,9 @@ public:
   ChsNode(Calculator *calc, CalculatorNode *a) : CalculatorNode(calc), m_a(a) {}
 
   double compute(double vars[3]) const override { return -m_a->compute(vars); }
+  int compile(CalculatorProgram &program) const override {
+    return program.addNegate(m_a->compile(program));
+  }
   void accept(CalculatorNodeVisitor &visitor) override { m_a->accept(visitor); }
 };
 
@@ -207,6 +483,10 @@ public:
     return (m_a->compute(vars) != 0) ? m_b->compute(vars) : m_c->compute(vars);
   }
 
+  int compile(CalculatorProgram &program) const override {
+    return program.addCondition(m_a.get(), m_b.get(), m_c.get());
+  }
+
   void accept(CalculatorNodeVisitor &visitor) override {
     m_a->accept(visitor), m_b->accept(visitor), m_c->accept(visitor);
   }
@@ -223,6 +503,9 @@ public:
   double compute(double vars[3]) const override {
     return m_a->compute(vars) == 0;
   }
+  int compile(CalculatorProgram &program) const override {
+    return program.addNot(m_a->compile(program));
+  }
   void accept(CalculatorNodeVisitor &visitor) override { m_a->accept(visitor); }
 };
 //-------------------------------------------------------------------
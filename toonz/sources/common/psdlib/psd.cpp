@@ -8,6 +8,14 @@
 #include "trasterimage.h"
 #include "trop.h"
 #include "tpixelutils.h"
+#include "tsystem.h"
+
+#include <QThread>
+#include <QDateTime>
+
+#include <algorithm>
+#include <map>
+#include <vector>
 
 /*
   The entire content of this file is ridden with LEAKS. A bug has been filed,
@@ -51,6 +59,131 @@ static char swapByte(unsigned char src) {
   return out;
 }
 
+//---------------------------- Parsed PSD index
+
+/*
+  Parsing the layer records takes a lot of small reads, and every layer level
+  built from a psd has its own readers. The parsed header infos are therefore
+  kept in a process-wide index, keyed by the psd path and invalidated as soon
+  as the file's modification time or size change. Only the most recently used
+  psds are kept.
+*/
+
+namespace {
+
+const int MaxParsedPsds = 16;
+
+struct ParsedPsd {
+  QDateTime m_lastModified;
+  TINT64 m_size;
+  std::shared_ptr<TPSDHeaderInfo> m_info;
+  TUINT64 m_lastUse;
+};
+
+QMutex parsedPsdsMutex;
+std::map<std::wstring, ParsedPsd> parsedPsds;
+TUINT64 parsedPsdsUse = 0;  // Incremented on each access
+
+// Drops the least recently used psds exceeding MaxParsedPsds. Readers still
+// using them keep their own reference.
+void trimParsedPsds() {
+  while ((int)parsedPsds.size() > MaxParsedPsds) {
+    auto lru = parsedPsds.begin();
+    for (auto it = parsedPsds.begin(); it != parsedPsds.end(); ++it)
+      if (it->second.m_lastUse < lru->second.m_lastUse) lru = it;
+    parsedPsds.erase(lru);
+  }
+}
+
+void releaseHeaderInfo(TPSDHeaderInfo *headerInfo) {
+  for (int i = 0; i < headerInfo->layersCount; ++i) {
+    TPSDLayerInfo *li = headerInfo->linfo + i;
+    free(li->chan);
+    if (li->chindex) free(li->chindex - 2);
+    free(li->name);
+    free(li->nameno);
+  }
+  free(headerInfo->linfo);
+  delete headerInfo;
+}
+
+//----------------------------------------------------------------------
+
+// Decodes a subset of the rows of a layer channel into a memory buffer.
+// Each decoder reads through its own file handle, so that the channels
+// of a layer can be decoded concurrently.
+class ChannelDecoder final : public QThread {
+  TFilePath m_path;
+  const TPSDChannelInfo *m_chan;
+  psdPixel m_firstRow, m_rowStep;
+  int m_rowCount, m_wrap;
+  unsigned char *m_buffer;
+  bool m_failed;
+
+public:
+  ChannelDecoder(const TFilePath &path, const TPSDChannelInfo *chan,
+                 psdPixel firstRow, psdPixel rowStep, int rowCount,
+                 unsigned char *buffer, int wrap)
+      : m_path(path)
+      , m_chan(chan)
+      , m_firstRow(firstRow)
+      , m_rowStep(rowStep)
+      , m_rowCount(rowCount)
+      , m_wrap(wrap)
+      , m_buffer(buffer)
+      , m_failed(false) {}
+
+  bool failed() const { return m_failed; }
+
+  // Stores the decoded rows in the buffer, 'wrap' bytes apart. The buffer
+  // must be zeroed: rows which are short or missing in the file are left
+  // untouched.
+  void run() override {
+    FILE *file = fopen(m_path, "rb");
+    if (!file) {
+      m_failed = true;
+      return;
+    }
+    psdPixel lastRow = m_firstRow + (m_rowCount - 1) * m_rowStep;
+    if (lastRow >= m_chan->rows) lastRow = m_chan->rows - 1;
+
+    if (m_chan->comptype == RLECOMP) {
+      // read all the compressed rows at once, then unpack them in memory
+      if (lastRow >= m_firstRow) {
+        psdByte begin = m_chan->rowpos[m_firstRow];
+        psdByte end   = m_chan->rowpos[lastRow + 1];
+        // unpackrow() may read past the end of truncated rows
+        std::vector<unsigned char> data(end - begin + m_chan->rowbytes);
+        psdByte read = 0;
+        if (fseek(file, begin, SEEK_SET) != -1)
+          read = (psdByte)fread(data.data(), 1, end - begin, file);
+        for (int i = 0; i < m_rowCount; ++i) {
+          psdPixel row = m_firstRow + i * m_rowStep;
+          if (row > lastRow) break;
+          psdByte rowBegin = m_chan->rowpos[row] - begin;
+          psdByte rowEnd   = std::min(m_chan->rowpos[row + 1] - begin, read);
+          if (rowEnd > rowBegin)
+            unpackrow(m_buffer + i * m_wrap, data.data() + rowBegin,
+                      m_chan->rowbytes, rowEnd - rowBegin);
+        }
+      }
+    } else {
+      std::vector<unsigned char> rleData(2 * m_chan->rowbytes);
+      TPSDChannelInfo *chan = const_cast<TPSDChannelInfo *>(m_chan);
+      for (int i = 0; i < m_rowCount; ++i) {
+        psdPixel row = m_firstRow + i * m_rowStep;
+        if (row > lastRow) break;
+        readrow(file, chan, row, m_buffer + i * m_wrap, rleData.data());
+      }
+    }
+    fclose(file);
+  }
+};
+
+}  // namespace
+
+//---------------------------- TPSDReader
+
 TPSDReader::TPSDReader(const TFilePath &path)
     : m_shrinkX(1), m_shrinkY(1), m_region(TRect()) {
   m_layerId    = 0;
@@ -62,12 +195,44 @@ TPSDReader::TPSDReader(const TFilePath &path)
   m_path = path.getParentDir() + TFilePath(name.toStdString());
   // m_path = path;
   QMutexLocker sl(&m_mutex);
-  openFile();
-  if (!doInfo()) {
+
+  TFileStatus status(m_path);
+  QDateTime lastModified = status.getLastModificationTime();
+  TINT64 size            = status.getSize();
+  {
+    QMutexLocker indexLocker(&parsedPsdsMutex);
+    auto it = parsedPsds.find(m_path.getWideString());
+    if (it != parsedPsds.end() && it->second.m_lastModified == lastModified &&
+        it->second.m_size == size) {
+      it->second.m_lastUse = ++parsedPsdsUse;
+      m_sharedInfo         = it->second.m_info;
+    }
+  }
+
+  if (!m_sharedInfo) {
+    memset(&m_headerInfo, 0, sizeof(m_headerInfo));
+    openFile();
+    bool ok;
+    try {
+      ok = doInfo();
+    } catch (...) {
+      fclose(m_file);
+      throw;
+    }
     fclose(m_file);
-    throw TImageException(m_path, "Do PSD INFO ERROR");
+    if (!ok) throw TImageException(m_path, "Do PSD INFO ERROR");
+
+    m_sharedInfo.reset(new TPSDHeaderInfo(m_headerInfo), releaseHeaderInfo);
+
+    QMutexLocker indexLocker(&parsedPsdsMutex);
+    ParsedPsd &parsed      = parsedPsds[m_path.getWideString()];
+    parsed.m_lastModified = lastModified;
+    parsed.m_size         = size;
+    parsed.m_info         = m_sharedInfo;
+    parsed.m_lastUse      = ++parsedPsdsUse;
+    trimParsedPsds();
   }
-  fclose(m_file);
+  m_headerInfo = *m_sharedInfo;
 }
 TPSDReader::~TPSDReader() {
   /*for(int i=0; i<m_headerInfo.layersCount;i++)
@@ -406,11 +571,28 @@ void TPSDReader::doImage(TRasterP &rasP, int layerId) {
     readImageData(rasP, NULL, mergedChans, tnzchannels, rows, cols);
     free(mergedChans);
   } else {
+    // the layer records are shared: the channels' data positions are
+    // retrieved in a local copy
+    std::vector<TPSDChannelInfo> chans(li->chan, li->chan + channels);
     for (ch = 0; ch < channels; ++ch) {
-      readChannel(m_file, li, li->chan + ch, 1, &m_headerInfo);
+      chans[ch].rowpos    = NULL;
+      chans[ch].unzipdata = NULL;
+      readChannel(m_file, li, &chans[ch], 1, &m_headerInfo);
     }
     imageDataEnd = ftell(m_file);
-    readImageData(rasP, li, li->chan, tnzchannels, rows, cols);
+    try {
+      readImageData(rasP, li, chans.data(), tnzchannels, rows, cols);
+    } catch (...) {
+      for (ch = 0; ch < channels; ++ch) {
+        free(chans[ch].rowpos);
+        free(chans[ch].unzipdata);
+      }
+      throw;
+    }
+    for (ch = 0; ch < channels; ++ch) {
+      free(chans[ch].rowpos);
+      free(chans[ch].unzipdata);
+    }
   }
   fseek(m_file, imageDataEnd, SEEK_SET);
 
@@ -524,16 +706,12 @@ void TPSDReader::readImageData(TRasterP &rasP, TPSDLayerInfo *li,
   if (rows == 0 || cols == 0) return;
   psdPixel j;
 
-  unsigned char *inrows[4], *rledata;
+  unsigned char *inrows[4];
 
   int ch, map[4];
 
-  rledata = (unsigned char *)mymalloc(chan->rowbytes * 2);
-
-  for (ch = 0; ch < chancount; ++ch) {
-    inrows[ch] = (unsigned char *)mymalloc(chan->rowbytes);
-    map[ch]    = li && chancount > 1 ? li->chindex[ch] : ch;
-  }
+  for (ch = 0; ch < chancount; ++ch)
+    map[ch] = li && chancount > 1 ? li->chindex[ch] : ch;
 
   // find the alpha channel, if needed
   if (li && (chancount == 2 || chancount == 4)) {  // grey+alpha
@@ -553,19 +731,13 @@ void TPSDReader::readImageData(TRasterP &rasP, TPSDLayerInfo *li,
   if (!m_region.isEmpty()) {
     x0 = m_region.getP00().x;
     // se x0 è fuori dalle dimensioni dell'immagine ritorna un'immagine vuota
-    if (x0 >= m_headerInfo.cols) {
-      free(rledata);
-      return;
-    }
+    if (x0 >= m_headerInfo.cols) return;
     x1 = x0 + m_region.getLx() - 1;
     // controllo che x1 rimanga all'interno dell'immagine
     if (x1 >= m_headerInfo.cols) x1 = m_headerInfo.cols - 1;
     y0 = m_region.getP00().y;
     // se y0 è fuori dalle dimensioni dell'immagine ritorna un'immagine vuota
-    if (y0 >= m_headerInfo.rows) {
-      free(rledata);
-      return;
-    }
+    if (y0 >= m_headerInfo.rows) return;
     y1 = y0 + m_region.getLy() - 1;
     // controllo che y1 rimanga all'interno dell'immagine
     if (y1 >= m_headerInfo.rows) y1 = m_headerInfo.rows - 1;
@@ -616,10 +788,7 @@ void TPSDReader::readImageData(TRasterP &rasP, TPSDLayerInfo *li,
   // Se è tutta fuori restutuisco TRasterImageP()
   layerSaveBox *= imageRect;
 
-  if (layerSaveBox == TRect() || layerSaveBox.isEmpty()) {
-    free(rledata);
-    return;
-  }
+  if (layerSaveBox == TRect() || layerSaveBox.isEmpty()) return;
   // Estraggo da rasP solo il rettangolo che si interseca con il livello
   // corrente
   // stando attento a prendere i pixel giusti.
@@ -655,16 +824,38 @@ void TPSDReader::readImageData(TRasterP &rasP, TPSDLayerInfo *li,
   // prima.
   int rowOffset = std::abs(sby1) % m_shrinkY;
   int rowCount  = rowOffset;
+
+  // Decode the rows to be read, each channel on its own thread
+  std::vector<unsigned char> channelRows[4];
+  int channelWraps[4];
+  std::vector<std::unique_ptr<ChannelDecoder>> decoders;
+  for (ch = 0; ch < chancount; ++ch) {
+    if (map[ch] < 0 || map[ch] > chancount) {
+      // warn("bad map[%d]=%d, skipping a channel", i, map[i]);
+      channelRows[ch].assign(chan->rowbytes, 0);  // a single, zeroed row
+      channelWraps[ch] = 0;
+      continue;
+    }
+    TPSDChannelInfo *mappedChan = chan + map[ch];
+    channelWraps[ch] = std::max(chan->rowbytes, mappedChan->rowbytes);
+    channelRows[ch].assign(channelWraps[ch] * smallRas->getLy(), 0);
+    decoders.emplace_back(new ChannelDecoder(
+        m_path, mappedChan, rowOffset, m_shrinkY, smallRas->getLy(),
+        channelRows[ch].data(), channelWraps[ch]));
+  }
+  for (int d = 1; d < (int)decoders.size(); ++d) decoders[d]->start();
+  if (!decoders.empty()) decoders[0]->run();
+  bool decodeFailed = false;
+  for (int d = 0; d < (int)decoders.size(); ++d) {
+    decoders[d]->wait();
+    decodeFailed = decodeFailed || decoders[d]->failed();
+  }
+  if (decodeFailed) throw TImageException(m_path, buildErrorString(2));
+
   // if(m_shrinkY==3) rowCount--;
   for (j = 0; j < smallRas->getLy(); j++) {
-    for (ch = 0; ch < chancount; ++ch) {
-      /* get row data */
-      if (map[ch] < 0 || map[ch] > chancount) {
-        // warn("bad map[%d]=%d, skipping a channel", i, map[i]);
-        memset(inrows[ch], 0, chan->rowbytes);  // zero out the row
-      } else
-        readrow(m_file, chan + map[ch], rowCount, inrows[ch], rledata);
-    }
+    for (ch = 0; ch < chancount; ++ch)
+      inrows[ch] = channelRows[ch].data() + j * channelWraps[ch];
     // se la riga corrente non rientra nell'immagine salto la copia
     if (sby1 - rowCount < 0 || sby1 - rowCount > m_headerInfo.rows - 1) {
       rowCount += m_shrinkY;
@@ -816,9 +1007,6 @@ void TPSDReader::readImageData(TRasterP &rasP, TPSDLayerInfo *li,
     rowCount += m_shrinkY;
   }
   fseek(m_file, savepos, SEEK_SET);  // restoring filepos
-
-  free(rledata);
-  for (ch = 0; ch < chancount; ++ch) free(inrows[ch]);
 }
 
 void TPSDReader::doExtraData(TPSDLayerInfo *li, psdByte length) {
@@ -6,6 +6,8 @@
 #include "psdutils.h"
 #include "timage_io.h"
 
+#include <memory>
+
 #define REF_LAYER_BY_NAME
 
 class TRasterImageP;
@@ -146,6 +148,8 @@ class DVAPI TPSDReader {
   FILE *m_file;
   int m_lx, m_ly;
   TPSDHeaderInfo m_headerInfo;
+  // parsed layer records, shared with all the readers of the same file
+  std::shared_ptr<TPSDHeaderInfo> m_sharedInfo;
   int m_layerId;
   int m_shrinkX;
   int m_shrinkY;
@@ -36,6 +36,7 @@
 
 // #include "tstopwatch.h"
 #include "tbigmemorymanager.h"
+#include "tmemorygovernor.h"
 
 #include "tstream.h"
 #include "tenv.h"
@@ -703,9 +704,11 @@ std::string TImageCache::getUniqueId(void) {
   return "IMAGECACHEUNIQUEID" + ss.str();
 }
 
-class TImageCache::Imp {
+class TImageCache::Imp final : public TMemoryConsumer {
 public:
-  Imp() : m_rootDir() {
+  Imp() : m_rootDir(), m_releaseTarget(-1) {
+    TMemoryGovernor::instance()->addConsumer(this, COMPRESSIBLE);
+
     // ATTENZIONE: e' molto piu' veloce se si usa memoria fisica
     // invece che virtuale: la virtuale e' tanta, non c'e' quindi bisogno
     // di comprimere le immagini, che grandi come sono vengono swappate su disco
@@ -716,10 +719,15 @@ public:
   }
 
   ~Imp() {
+    TMemoryGovernor::instance()->removeConsumer(this);
     if (m_rootDir != TFilePath()) TSystem::rmDirTree(m_rootDir);
   }
 
   bool inline notEnoughMemory() {
+    // Inside releaseMemory(), compress down to the governor's request
+    if (m_releaseTarget >= 0)
+      return TMemoryGovernor::instance()->getUsedMemory() > m_releaseTarget;
+
     if (TBigMemoryManager::instance()->isActive())
       return TBigMemoryManager::instance()->getAvailableMemoryinKb() <
              50 * 1024;
@@ -727,6 +735,22 @@ public:
       return TSystem::memoryShortage();
   }
 
+  /*!
+    Compresses, then moves to disk, images until \b size bytes of raster
+    buffers are released. The process budget is enforced here only, since
+    the buffers waiting in the raster pools are released by trimming them,
+    and checking the budget on each add() and get() would rescan the cache
+    as long as it is exceeded.
+  */
+  void releaseMemory(TINT64 size) override {
+    TThread::MutexLocker sl(&m_mutex);
+    m_releaseTarget =
+        std::max(TMemoryGovernor::instance()->getUsedMemory() - size,
+                 (TINT64)0);
+    doCompress();
+    m_releaseTarget = -1;
+  }
+
   void doCompress();
   void doCompress(std::string id);
   UCHAR *compressAndMalloc(TUINT32 requestedSize);  // compress in the cache
@@ -757,6 +781,7 @@ public:
                                                          // id, value is main id
   // memoria fisica totale della macchina che non puo' essere utilizzata;
   TINT64 m_reservedMemory;
+  TINT64 m_releaseTarget;  // Used memory to reach in releaseMemory(), or -1
   TThread::Mutex m_mutex;
 
   static int m_fileid;
@@ -912,9 +937,10 @@ void TImageCache::Imp::doCompress(std::string id) {
     return;
 
   // search id in m_itemHistory
-  std::map<TUINT32, std::string>::iterator itu = m_itemHistory.begin();
-  while (itu != m_itemHistory.end() && itu->second != id) ++itu;
-  if (itu == m_itemHistory.end()) return;  // id not found: return
+  std::map<TUINT32, std::string>::iterator itu =
+      m_itemHistory.find(item->m_historyCount);
+  if (itu == m_itemHistory.end() || itu->second != id)
+    return;  // id not found: return
 
 // delete itu from m_itemHistory
 #ifdef _WIN32
@@ -1813,6 +1839,8 @@ UINT TImageCache::getDiskUsage() const { return 0; }
 //------------------------------------------------------------------------------
 
 UINT TImageCache::getMemUsage(const std::string &id) const {
+  TThread::MutexLocker sl(&m_imp->m_mutex);
+
   std::map<std::string, CacheItemP>::iterator it =
       m_imp->m_uncompressedItems.find(id);
   if (it != m_imp->m_uncompressedItems.end()) return it->second->getSize();
@@ -1827,6 +1855,8 @@ UINT TImageCache::getMemUsage(const std::string &id) const {
 //! Returns the uncompressed image size (in KB) of the image associated with
 //! passd id, or 0 if none was found.
 UINT TImageCache::getUncompressedMemUsage(const std::string &id) const {
+  TThread::MutexLocker sl(&m_imp->m_mutex);
+
   std::map<std::string, CacheItemP>::iterator it =
       m_imp->m_uncompressedItems.find(id);
   if (it != m_imp->m_uncompressedItems.end()) return it->second->getSize();
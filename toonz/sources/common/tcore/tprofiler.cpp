@@ -0,0 +1,277 @@
+
+
+#include "tprofiler.h"
+#include "tfilepath_io.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+
+//***********************************************************************************
+//    Local namespace
+//***********************************************************************************
+
+namespace {
+
+std::atomic<bool> profilerActive(false);
+
+// Memory taken by the events of a recording at most: later ones are only
+// counted
+const size_t MaxRecordingSize = 256 << 20;
+
+TINT64 clockTime() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int threadIndex() {
+  static std::atomic<int> threadsCount(0);
+  thread_local int index = ++threadsCount;
+  return index;
+}
+
+//------------------------------------------------------------------------------
+
+struct Event {
+  char m_phase;  // Chrome trace phase: 'X' span, 'i' instant, 'C' counter
+  const char *m_category;
+  std::string m_name, m_args;
+  TINT64 m_start, m_duration;
+  int m_thread;
+};
+
+//------------------------------------------------------------------------------
+
+std::string quote(const std::string &str) {
+  std::string result("\"");
+  for (char c : str) {
+    switch (c) {
+    case '"':
+      result += "\\\"";
+      break;
+    case '\\':
+      result += "\\\\";
+      break;
+    case '\n':
+      result += "\\n";
+      break;
+    case '\t':
+      result += "\\t";
+      break;
+    default:
+      result += ((unsigned char)c < 0x20) ? ' ' : c;
+    }
+  }
+  return result + '"';
+}
+
+}  // namespace
+
+//***********************************************************************************
+//    TProfiler::Imp
+//***********************************************************************************
+
+class TProfiler::Imp {
+public:
+  mutable std::mutex m_mutex;
+  std::vector<Event> m_events;
+  std::map<std::string, TINT64> m_counters;
+  size_t m_size;  // Bytes taken by m_events
+  TINT64 m_droppedCount;
+  std::atomic<TINT64> m_start;  // In microseconds
+
+public:
+  Imp() : m_size(0), m_droppedCount(0), m_start(clockTime()) {}
+
+  void add(Event &&event) {
+    std::lock_guard<std::mutex> locker(m_mutex);
+    record(std::move(event));
+  }
+
+  // Requires m_mutex
+  void record(Event &&event) {
+    size_t size = sizeof(Event) + event.m_name.size() + event.m_args.size();
+    if (m_size + size <= MaxRecordingSize) {
+      m_events.push_back(std::move(event));
+      m_size += size;
+    } else
+      ++m_droppedCount;
+  }
+};
+
+//***********************************************************************************
+//    TProfiler implementation
+//***********************************************************************************
+
+TProfiler::TProfiler() : m_imp(new Imp) {}
+
+//------------------------------------------------------------------------------
+
+TProfiler::~TProfiler() { delete m_imp; }
+
+//------------------------------------------------------------------------------
+
+TProfiler *TProfiler::instance() {
+  static TProfiler theInstance;
+  return &theInstance;
+}
+
+//------------------------------------------------------------------------------
+
+bool TProfiler::isActive() {
+  return profilerActive.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+void TProfiler::start() {
+  {
+    std::lock_guard<std::mutex> locker(m_imp->m_mutex);
+    m_imp->m_events.clear();
+    m_imp->m_counters.clear();
+    m_imp->m_size         = 0;
+    m_imp->m_droppedCount = 0;
+    m_imp->m_start        = clockTime();
+  }
+  profilerActive = true;
+}
+
+//------------------------------------------------------------------------------
+
+void TProfiler::stop() { profilerActive = false; }
+
+//------------------------------------------------------------------------------
+
+TINT64 TProfiler::now() const { return clockTime() - m_imp->m_start; }
+
+//------------------------------------------------------------------------------
+
+void TProfiler::addSpan(const char *category, const std::string &name,
+                        const std::string &args, TINT64 start, TINT64 end) {
+  if (!isActive()) return;
+  m_imp->add({'X', category, name, args, start, end - start, threadIndex()});
+}
+
+//------------------------------------------------------------------------------
+
+void TProfiler::addInstant(const char *category, const std::string &name,
+                           const std::string &args) {
+  if (!isActive()) return;
+  m_imp->add({'i', category, name, args, now(), 0, threadIndex()});
+}
+
+//------------------------------------------------------------------------------
+
+void TProfiler::count(const char *name, TINT64 delta) {
+  if (!isActive()) return;
+
+  TINT64 time = now();
+
+  std::lock_guard<std::mutex> locker(m_imp->m_mutex);
+  TINT64 value = (m_imp->m_counters[name] += delta);
+  m_imp->record({'C', "counter", name, arg("value", value), time, 0, 0});
+}
+
+//------------------------------------------------------------------------------
+
+void TProfiler::setCounter(const char *name, TINT64 value) {
+  if (!isActive()) return;
+
+  TINT64 time = now();
+
+  std::lock_guard<std::mutex> locker(m_imp->m_mutex);
+  m_imp->m_counters[name] = value;
+  m_imp->record({'C', "counter", name, arg("value", value), time, 0, 0});
+}
+
+//------------------------------------------------------------------------------
+
+bool TProfiler::exportChromeTrace(const TFilePath &fp) const {
+  Tofstream os(fp);
+  if (!os) return false;
+
+  std::lock_guard<std::mutex> locker(m_imp->m_mutex);
+
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  for (const Event &event : m_imp->m_events) {
+    os << (first ? "\n" : ",\n");
+    first = false;
+
+    os << "{\"ph\":\"" << event.m_phase
+       << "\",\"cat\":" << quote(event.m_category)
+       << ",\"name\":" << quote(event.m_name)
+       << ",\"pid\":1,\"tid\":" << event.m_thread
+       << ",\"ts\":" << event.m_start;
+    if (event.m_phase == 'X') os << ",\"dur\":" << event.m_duration;
+    if (event.m_phase == 'i') os << ",\"s\":\"t\"";
+    if (!event.m_args.empty()) os << ",\"args\":{" << event.m_args << "}";
+    os << "}";
+  }
+
+  // Tell that the recording is incomplete, at its end
+  if (m_imp->m_droppedCount > 0)
+    os << ",\n{\"ph\":\"i\",\"cat\":\"profiler\",\"name\":\"events dropped\","
+          "\"pid\":1,\"tid\":0,\"ts\":"
+       << m_imp->m_events.back().m_start << ",\"s\":\"g\",\"args\":{"
+       << arg("count", m_imp->m_droppedCount) << "}}";
+
+  os << "\n]}\n";
+  return !os.fail();
+}
+
+//------------------------------------------------------------------------------
+
+std::string TProfiler::arg(const char *key, TINT64 value) {
+  return quote(key) + ":" + std::to_string(value);
+}
+
+//------------------------------------------------------------------------------
+
+std::string TProfiler::arg(const char *key, const std::string &value) {
+  return quote(key) + ":" + quote(value);
+}
+
+//------------------------------------------------------------------------------
+
+std::string TProfiler::digest(const std::string &str) {
+  // 64 bits FNV-1a
+  TUINT64 hash = 14695981039346656037ULL;
+  for (char c : str) hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+  return buf;
+}
+
+//***********************************************************************************
+//    TProfileSpan implementation
+//***********************************************************************************
+
+void TProfileSpan::begin(const char *category, const std::string &name,
+                         const std::string &args) {
+  if (!TProfiler::isActive()) return;
+
+  end();
+
+  m_category = category;
+  m_name     = name;
+  m_args     = args;
+  m_start    = TProfiler::instance()->now();
+}
+
+//------------------------------------------------------------------------------
+
+void TProfileSpan::end() {
+  if (!m_category) return;
+
+  TProfiler *profiler = TProfiler::instance();
+  profiler->addSpan(m_category, m_name, m_args, m_start, profiler->now());
+
+  m_category = 0;
+}
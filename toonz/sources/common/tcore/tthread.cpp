@@ -15,6 +15,7 @@
 // STL includes
 #include <set>
 #include <deque>
+#include <algorithm>
 
 // tcg includes
 #include "tcg/tcg_pool.h"
@@ -26,6 +27,8 @@
 #include <QWaitCondition>
 #include <QMetaType>
 #include <QCoreApplication>
+#include <QThreadPool>
+#include <QSemaphore>
 
 //==============================================================================
 
@@ -1135,3 +1138,65 @@ inline void Worker::takeTask() {
     }
   }
 }
+
+//=====================================================================
+
+//=============================
+//     Parallel runs
+//-----------------------------
+
+namespace {
+
+class HelperTask final : public QRunnable {
+  const std::function<void()> &m_function;
+  QSemaphore &m_done;
+
+public:
+  HelperTask(const std::function<void()> &function, QSemaphore &done)
+      : m_function(function), m_done(done) {}
+
+  void run() override {
+    m_function();
+    m_done.release();
+  }
+};
+
+//---------------------------------------------------------------------
+
+QThreadPool *helpersPool() {
+  // Never deleted, so that it outlives any static caller
+  static QThreadPool *pool = []() {
+    QThreadPool *pool = new QThreadPool;
+    pool->setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    return pool;
+  }();
+  return pool;
+}
+
+}  // namespace
+
+//---------------------------------------------------------------------
+
+void TThread::parallelRun(const std::function<void()> &function, int count) {
+  // Executor tasks declare their load in hundredths of a core
+  int freeCount = QThread::idealThreadCount();
+  if (globalImp) {
+    QMutexLocker sl(&globalImp->m_transitionMutex);
+    freeCount -= globalImp->m_activeLoad / 100;
+  }
+
+  // Helpers are only taken when idle, so that no call waits for another
+  QThreadPool *pool = helpersPool();
+  QSemaphore done;
+  int helpersCount = std::min(count, freeCount) - 1, startedCount = 0;
+  for (; startedCount < helpersCount; ++startedCount) {
+    HelperTask *task = new HelperTask(function, done);
+    if (!pool->tryStart(task)) {
+      delete task;
+      break;
+    }
+  }
+
+  function();
+  done.acquire(startedCount);
+}
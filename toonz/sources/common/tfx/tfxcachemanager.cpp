@@ -6,6 +6,7 @@
 #include "tcacheresourcepool.h"
 
 #include "tfxcachemanager.h"
+#include "tprofiler.h"
 
 // Debug
 //#define DIAGNOSTICS
@@ -108,6 +109,21 @@ inline bool contains(const QRegion &region, const TRect &rect) {
   return QRegion(toQRect(rect)).subtracted(region).isEmpty();
 }
 
+// Records whether a resource access found its tile already built. Resource
+// names embed the aliases of whole fx subtrees, so they are digested.
+inline void profileCacheAccess(const TCacheResourceP &resource,
+                               const TRectD &tile, bool hit) {
+  if (!TProfiler::isActive()) return;
+
+  TProfiler *profiler = TProfiler::instance();
+  profiler->addInstant(
+      "cache", hit ? "cache hit" : "cache miss",
+      TProfiler::arg("resource", TProfiler::digest(resource->getName())) +
+          "," + TProfiler::arg("lx", (int)tile.getLx()) + "," +
+          TProfiler::arg("ly", (int)tile.getLy()));
+  profiler->count(hit ? "cache hits" : "cache misses", 1);
+}
+
 bool getTilesToBuild(
     const ResourceData &data, const TRectD &rect,
     std::vector<ResourceDeclaration::TileData *> &rectsToCalculate);
@@ -740,7 +756,9 @@ void ResourceBuilder::build(const TRectD &tileRect) {
                       1);
 #endif
 
-    if (download(m_data.second)) return;
+    bool hit = download(m_data.second);
+    profileCacheAccess(m_data.second, tileRect, hit);
+    if (hit) return;
 
     compute(tileRect);
 
@@ -779,6 +797,8 @@ void ResourceBuilder::build(const TRectD &tileRect) {
   }
 
   // If necessary, calculate something
+  if (tiles.empty()) profileCacheAccess(m_data.second, tileRect, true);
+
   if (tiles.size() > 0) {
     // For every tile to build
     std::vector<ResourceDeclaration::TileData *>::iterator it;
@@ -800,7 +820,10 @@ void ResourceBuilder::build(const TRectD &tileRect) {
       TRect tileRectI(tileData.m_rect.x0, tileData.m_rect.y0,
                       tileData.m_rect.x1 - 1, tileData.m_rect.y1 - 1);
 
-      if (m_data.second->canDownloadAll(tileRectI)) {
+      bool hit = m_data.second->canDownloadAll(tileRectI);
+      profileCacheAccess(m_data.second, tileData.m_rect, hit);
+
+      if (hit) {
         if (!tileData.m_calculated && tileData.m_refCount > 0) {
           /*#ifdef WRITESTACK
 QString renderStr(DIAGNOSTICS_GLOSTRGET("compRenderStr"));
@@ -5,6 +5,8 @@
 #include "trenderer.h"
 #include "tcacheresource.h"
 #include "tcacheresourcepool.h"
+#include "tprofiler.h"
+#include "tconvert.h"
 
 #include "tpassivecachemanager.h"
 
@@ -126,6 +128,20 @@ considered coherent with what tcomposer
 * Our resources maintenance policy ensures that the memory usage should be
 stable over time - that is, no
   useless resource is kept in memory.
+
+BRANCH CACHE:
+
+Render instances may also require that the results of ALL their fx nodes at a
+given frame are kept in their context (see ::enableBranchCache(..)), as the
+Preview Fx does for the frame shown in its flipbooks. These resources are
+stored in the reserved column BranchCacheId of the table, and follow the
+maintenance policy above.
+
+No explicit invalidation is needed for them: resources are retrieved by alias,
+which describes the fx parameters at the frame and the whole input subtree. A
+changed node and its downstream consumers get new aliases and are recomputed,
+while upstream resources are found again - and kept by the new render. Level
+changes are still delivered to ::invalidateLevel(..).
   Of course, it is possibly more restrictive than what the user may desire. For
 example, closing 2 preview
   windows marks their resources for deletion, but only one of the two restored
@@ -146,6 +162,9 @@ inline QRect toQRect(const TRect &r) {
 inline TRect toTRect(const QRect &r) {
   return TRect(r.left(), r.top(), r.right(), r.bottom());
 }
+
+// Table column of the branch cache resources. Passive cache ids are positive.
+const int BranchCacheId = -1;
 }
 
 //---------------------------------------------------------------------------
@@ -435,11 +454,15 @@ TPassiveCacheManager::TPassiveCacheManager()
     , m_mutex(QMutex::Recursive)
     , m_resources(new ResourcesContainer) {
   reset();
+  TMemoryGovernor::instance()->addConsumer(this, RECOMPUTABLE);
 }
 
 //-------------------------------------------------------------------------
 
-TPassiveCacheManager::~TPassiveCacheManager() { delete m_resources; }
+TPassiveCacheManager::~TPassiveCacheManager() {
+  TMemoryGovernor::instance()->removeConsumer(this);
+  delete m_resources;
+}
 
 //-------------------------------------------------------------------------
 
@@ -480,6 +503,25 @@ std::string TPassiveCacheManager::getContextName() {
 
 //-------------------------------------------------------------------------
 
+void TPassiveCacheManager::enableBranchCache(unsigned long renderId,
+                                             double frame) {
+  QMutexLocker locker(&m_mutex);
+  m_branchCacheFrames[renderId] = frame;
+}
+
+//-------------------------------------------------------------------------
+
+bool TPassiveCacheManager::isBranchCached(double frame) {
+  QMutexLocker locker(&m_mutex);
+
+  std::map<unsigned long, double>::iterator it =
+      m_branchCacheFrames.find(TRenderer::renderId());
+
+  return it != m_branchCacheFrames.end() && it->second == frame;
+}
+
+//-------------------------------------------------------------------------
+
 void TPassiveCacheManager::setEnabled(bool enabled) { m_enabled = enabled; }
 
 //-------------------------------------------------------------------------
@@ -863,8 +905,10 @@ void TPassiveCacheManager::getResource(TCacheResourceP &resource,
                                        ResourceDeclaration *resData) {
   if (!(m_enabled && fx && rs.m_userCachable)) return;
 
-  StorageFlag flag = getStorageMode(fx.getPointer());
-  if (flag == NONE) return;
+  // Fxs without user cache are stored only in branch caches
+  StorageFlag flag  = getStorageMode(fx.getPointer());
+  bool branchCached = (flag == NONE) && isBranchCached(frame);
+  if (flag == NONE && !branchCached) return;
 
   std::string contextName(getContextName());
   if (contextName.empty()) return;
@@ -884,7 +928,10 @@ void TPassiveCacheManager::getResource(TCacheResourceP &resource,
   }
 #endif
 
-  if (flag & IN_MEMORY) {
+  if (branchCached) {
+    QMutexLocker locker(&m_mutex);
+    m_resources->getTable().value(contextName, BranchCacheId).insert(resource);
+  } else if (flag & IN_MEMORY) {
     QMutexLocker locker(&m_mutex);
 
     int passiveCacheId =
@@ -892,6 +939,15 @@ void TPassiveCacheManager::getResource(TCacheResourceP &resource,
             .m_passiveCacheId;
     m_resources->getTable().value(contextName, passiveCacheId).insert(resource);
   }
+
+  // Resources kept from previous renders already hold their tiles
+  if (TProfiler::isActive())
+    TProfiler::instance()->addInstant(
+        "cache",
+        (resource->size() > 0) ? "passive cache hit" : "passive cache miss",
+        TProfiler::arg("resource", TProfiler::digest(alias)) + "," +
+            TProfiler::arg("fx", ::to_string(fx->getFxId())) + "," +
+            TProfiler::arg("frame", (int)frame + 1));
 }
 
 //-------------------------------------------------------------------------
@@ -959,6 +1015,43 @@ void TPassiveCacheManager::releaseOldResources() {
 
 //-------------------------------------------------------------------------
 
+namespace {
+template <typename Iterator>
+TINT64 resourcesSize(Iterator it) {
+  TINT64 sizeInKb = 0;
+  for (; it; ++it)
+    for (const LockedResourceP &resource : *it) sizeInKb += resource->size();
+  return sizeInKb << 10;
+}
+}  // namespace
+
+//-------------------------------------------------------------------------
+
+//! Releases the resources that are cheaper to rebuild first: those waiting
+//! for release, then the branch caches, and the user caches last.
+//! Resources still in use by renders are freed when the renders drop them.
+void TPassiveCacheManager::releaseMemory(TINT64 size) {
+  QMutexLocker locker(&m_mutex);
+
+  ResourcesTable &table = m_resources->getTable();
+
+  std::map<std::string, ResourcesTable::Row>::iterator it =
+      table.rows().find("T");
+  if (it != table.rows().end()) {
+    size -= resourcesSize(ResourcesTable::RowIterator(it));
+    table.rows().erase(it);
+    if (size <= 0) return;
+  }
+
+  size -= resourcesSize(table.colBegin(BranchCacheId));
+  table.erase(BranchCacheId);
+  if (size <= 0) return;
+
+  table.clear();
+}
+
+//-------------------------------------------------------------------------
+
 void TPassiveCacheManager::onRenderInstanceStart(unsigned long renderId) {
   TFxCacheManagerDelegate::onRenderInstanceStart(renderId);
 
@@ -975,6 +1068,7 @@ void TPassiveCacheManager::onRenderInstanceEnd(unsigned long renderId) {
 
   releaseOldResources();
   m_contextNamesByRenderId.erase(renderId);
+  m_branchCacheFrames.erase(renderId);
 }
 
 //-------------------------------------------------------------------------
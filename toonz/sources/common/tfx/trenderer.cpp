@@ -13,6 +13,8 @@
 #include "trop.h"
 #include "timagecache.h"
 #include "tstopwatch.h"
+#include "tprofiler.h"
+#include "tmemorygovernor.h"
 
 // TnzBase includes
 #include "trenderresourcemanager.h"
@@ -31,6 +33,7 @@
 // #include "diagnostics.h"
 
 #include <queue>
+#include <atomic>
 #include <functional>
 
 #include <QOffscreenSurface>
@@ -104,7 +107,7 @@ inline void interlace(TRasterP f0, const TRasterP &f1, int field) {
 //! of allocating one raster for each rendered frame.
 //! Each frame-rendering task will lock a RasterItem as preallocated output
 //! before starting the
-//! render, therefore changing the \b RasterItem::m_busy attribute accordingly.
+//! render, moving it to the busy items of the RasterPool until it is released.
 //! As each frame is rendered on a separate thread, the number of RasterItems
 //! that
 //! TRenderer will allocate depends on the number of rendering threads specified
@@ -117,12 +120,10 @@ class RasterItem {
 
 public:
   int m_bpp;
-  bool m_busy;
 
   //---------------------------------------------------------
 
-  RasterItem(const TDimension &size, int bpp, bool busyFlag)
-      : m_rasterId(""), m_bpp(bpp), m_busy(busyFlag) {
+  RasterItem(const TDimension &size, int bpp) : m_rasterId(""), m_bpp(bpp) {
     TRasterP raster;
     if (bpp == 32)
       raster = TRaster32P(size);
@@ -162,17 +163,21 @@ private:
 //-------------------
 
 //! Stores a list of RasterItems under TRenderer's requests.
-class RasterPool {
+class RasterPool final : public TMemoryConsumer {
   TDimension m_size;
   int m_bpp;
 
-  typedef std::list<RasterItem *> RasterRepository;
-  RasterRepository m_rasterRepository;
+  // Busy items are keyed by their raster's buffer, which stays in place as
+  // long as the raster is referenced by its task
+  std::vector<RasterItem *> m_idleItems;
+  std::map<const UCHAR *, RasterItem *> m_busyItems;
 
   TThread::Mutex m_repositoryLock;
 
 public:
-  RasterPool() : m_size(-1, -1) {}
+  RasterPool() : m_size(-1, -1), m_bpp(0) {
+    TMemoryGovernor::instance()->addConsumer(this, IDLE_MEMORY);
+  }
   ~RasterPool();
 
   void setRasterSpecs(const TDimension &size, int bpp);
@@ -187,13 +192,17 @@ public:
   void releaseRaster(const TRasterP &r);
 
   void clear();
+
+  void releaseMemory(TINT64 size) override;
 };
 
 //---------------------------------------------------------
 
 void RasterPool::clear() {
   QMutexLocker sl(&m_repositoryLock);
-  clearPointerContainer(m_rasterRepository);
+  clearPointerContainer(m_idleItems);
+  for (auto &busyItem : m_busyItems) delete busyItem.second;
+  m_busyItems.clear();
 }
 
 //---------------------------------------------------------
@@ -209,67 +218,89 @@ void RasterPool::setRasterSpecs(const TDimension &size, int bpp) {
 //---------------------------------------------------------
 
 TRasterP RasterPool::getRaster(const TDimension &size, int bpp) {
-  assert(size == m_size && bpp == m_bpp);
-  return getRaster();
+  QMutexLocker sl(&m_repositoryLock);
+  if (size == m_size && bpp == m_bpp) return getRaster();
+
+  // Renders of different areas may overlap, so the specs may have changed
+  // since the requesting task was built. Such rasters are not recycled.
+  if (bpp == 32)
+    return TRaster32P(size);
+  else if (bpp == 64)
+    return TRaster64P(size);
+
+  assert(bpp == 128);
+  return TRasterFP(size);
 }
 
 //---------------------------------------------------------
 
-//! Returns for the first not-busy raster
+//! Returns the raster of an idle item, or of a new one if none is available
 TRasterP RasterPool::getRaster() {
   QMutexLocker sl(&m_repositoryLock);
 
-  RasterRepository::iterator it = m_rasterRepository.begin();
-  while (it != m_rasterRepository.end()) {
-    RasterItem *rasItem = *it;
-    if (rasItem->m_busy == false) {
-      TRasterP raster = rasItem->getRaster();
+  TRasterP raster;
+  RasterItem *rasItem = 0;
 
-      if (!raster) {
-        delete rasItem;
-        m_rasterRepository.erase(it++);
-        continue;
-      }
+  while (!m_idleItems.empty()) {
+    rasItem = m_idleItems.back();
+    m_idleItems.pop_back();
 
-      rasItem->m_busy = true;
+    // The image cache may have dropped the raster
+    if ((raster = rasItem->getRaster())) {
       raster->clear();
-      return raster;
+      break;
     }
 
-    ++it;
+    delete rasItem;
+    rasItem = 0;
   }
 
-  RasterItem *rasItem = new RasterItem(m_size, m_bpp, true);
-  m_rasterRepository.push_back(rasItem);
+  if (!rasItem) {
+    rasItem = new RasterItem(m_size, m_bpp);
+    raster  = rasItem->getRaster();
+  }
 
-  return rasItem->getRaster();
+  if (raster) m_busyItems[raster->getRawData()] = rasItem;
+  return raster;
 }
 
 //---------------------------------------------------------
 
-//! Cerca il raster \b r in m_rasterRepository; se lo trova setta a \b false il
-//! campo \b m_busy.
+//! Makes the item of the raster \b r available to the following getRaster()
+//! calls.
 void RasterPool::releaseRaster(const TRasterP &r) {
   if (!r) return;
 
   QMutexLocker sl(&m_repositoryLock);
-  for (RasterRepository::iterator it = m_rasterRepository.begin();
-       it != m_rasterRepository.end(); ++it) {
-    RasterItem *rasItem = *it;
-    if (rasItem->getRaster()->getRawData() == r->getRawData()) {
-      assert(rasItem->m_busy);
-      rasItem->m_busy = false;
-      return;
-    }
+  auto it = m_busyItems.find(r->getRawData());
+  if (it != m_busyItems.end()) {
+    m_idleItems.push_back(it->second);
+    m_busyItems.erase(it);
+  }
+}
+
+//---------------------------------------------------------
+
+//! Deletes idle items, whose rasters are kept in the image cache.
+void RasterPool::releaseMemory(TINT64 size) {
+  QMutexLocker sl(&m_repositoryLock);
+
+  TINT64 itemSize = (TINT64)m_size.lx * m_size.ly * (m_bpp >> 3);
+  while (size > 0 && !m_idleItems.empty()) {
+    delete m_idleItems.back();
+    m_idleItems.pop_back();
+    size -= itemSize;
   }
 }
 
 //---------------------------------------------------------
 
 RasterPool::~RasterPool() {
-  /*if (m_rasterRepository.size())
+  TMemoryGovernor::instance()->removeConsumer(this);
+
+  /*if (m_busyItems.size())
 TSystem::outputDebug("~RasterPool: itemCount = " + toString
-((int)m_rasterRepository.size())+" (should be 0)\n");*/
+((int)m_busyItems.size())+" (should be 0)\n");*/
 
   // Release all raster items
   clear();
@@ -315,6 +346,7 @@ public:
   unsigned long m_rendererId;
 
   Executor m_executor;
+  std::atomic<int> m_threadsCount;  // Requested, before memory throttling
 
   bool m_precomputingEnabled;
   RasterPool m_rasterPool;
@@ -352,7 +384,10 @@ public:
   void enablePrecomputing(bool on) { m_precomputingEnabled = on; }
   bool isPrecomputingEnabled() const { return m_precomputingEnabled; }
 
-  void setThreadsCount(int nThreads) { m_executor.setMaxActiveTasks(nThreads); }
+  void setThreadsCount(int nThreads) {
+    m_threadsCount = nThreads;
+    m_executor.setMaxActiveTasks(nThreads);
+  }
 
   inline void declareRenderStart(unsigned long renderId);
   inline void declareRenderEnd(unsigned long renderId);
@@ -394,6 +429,8 @@ class RenderTask final : public TThread::Runnable {
 
   bool m_fieldRender, m_stereoscopic;
 
+  TBigMemoryManager::ThreadStats m_rasterStats;
+
   Mutex m_rasterGuard;
   TTile m_tileA;  // in normal and field rendering, Rendered at given frame; in
                   // stereoscopic, rendered left frame
@@ -687,6 +724,7 @@ int TRenderer::getRenderStatus(unsigned long renderId) const {
 
 TRendererImp::TRendererImp(int nThreads)
     : m_executor()
+    , m_threadsCount(nThreads)
     , m_undoneTasks()
     , m_rendererId(m_rendererIdCounter++)
     , m_precomputingEnabled(true) {
@@ -930,7 +968,8 @@ RenderTask::RenderTask(unsigned long renderId, unsigned long taskId,
     , m_framePos(framePos)
     , m_rendererImp(rendererImp)
     , m_fieldRender(ri.m_fieldPrevalence != TRenderSettings::NoField)
-    , m_stereoscopic(ri.m_stereoscopic) {
+    , m_stereoscopic(ri.m_stereoscopic)
+    , m_rasterStats() {
   m_frames.push_back(frame);
 
   // Connect the onFinished slot
@@ -950,6 +989,12 @@ RenderTask::RenderTask(unsigned long renderId, unsigned long taskId,
 void RenderTask::preRun() {
   TRectD geom(m_framePos, TDimensionD(m_frameSize.lx, m_frameSize.ly));
 
+  TProfileSpan frameSpan;
+  if (TProfiler::isActive())
+    frameSpan.begin("frame",
+                    "Predict Frame " + std::to_string((int)m_frames[0] + 1),
+                    TProfiler::arg("renderId", m_renderId));
+
   if (m_fx.m_frameA) m_fx.m_frameA->dryCompute(geom, m_frames[0], m_info);
 
   if (m_fx.m_frameB)
@@ -970,6 +1015,13 @@ void RenderTask::run() {
     return;
   }
 
+  // Make room within the process memory budget, and run fewer frames at once
+  // as the budget fills up
+  TMemoryGovernor *governor = TMemoryGovernor::instance();
+  governor->enforce();
+  m_rendererImp->m_executor.setMaxActiveTasks(
+      governor->getAdmittedThreads(m_rendererImp->m_threadsCount));
+
   // Install the renderer in current thread
   rendererStorage.setLocalData(
       new (TRendererImp *)(m_rendererImp.getPointer()));
@@ -978,6 +1030,10 @@ void RenderTask::run() {
   // Inform the managers of frame start
   m_rendererImp->declareFrameStart(t);
 
+  // Intermediate tiles are drawn from the calling thread's raster pool, so
+  // the thread's raster statistics describe the frame
+  TBigMemoryManager::instance()->resetThreadRasterStats();
+
   auto sortedFxs = calculateSortedFxs(m_fx.m_frameA);
   for (auto fx : sortedFxs) {
     if (fx) const_cast<TFx *>(fx)->callStartRenderFrameHandler(&m_info, t);
@@ -988,6 +1044,11 @@ void RenderTask::run() {
 
     TStopWatch::global(8).start();
 
+    TProfileSpan frameSpan;
+    if (TProfiler::isActive())
+      frameSpan.begin("frame", "Frame " + std::to_string((int)t + 1),
+                      TProfiler::arg("renderId", m_renderId));
+
     if (!m_fieldRender && !m_stereoscopic) {
       // Common case - just build the first tile
       buildTile(m_tileA);
@@ -1020,8 +1081,16 @@ void RenderTask::run() {
       }
     }
 
+    frameSpan.end();
     TStopWatch::global(8).stop();
 
+    TBigMemoryManager::instance()->getThreadRasterStats(m_rasterStats);
+    if (TProfiler::isActive())
+      TProfiler::instance()->addInstant(
+          "memory", "Frame " + std::to_string((int)t + 1) + " rasters",
+          TProfiler::arg("allocated", m_rasterStats.m_allocSize) + "," +
+              TProfiler::arg("reused", m_rasterStats.m_reuseSize) + "," +
+              TProfiler::arg("peak", m_rasterStats.m_peakSize));
     onFrameCompleted();
   } catch (TException &e) {
     onFrameFailed(e);
@@ -1088,6 +1157,7 @@ void RenderTask::onFrameCompleted() {
 
   TRenderPort::RenderData rd(m_frames, m_info, rasA, rasB, m_renderId,
                              m_taskId);
+  rd.m_rasterStats = m_rasterStats;
   m_rendererImp->notifyRasterCompleted(rd);
 }
 
@@ -1344,9 +1414,12 @@ void TRendererImp::startRendering(
   //    Preliminary initializations
   //----------------------------------------------------------------------
 
-  // Calculate the overall render area - sum of all render ports' areas
-  TRectD renderArea;
-  {
+  // Calculate the overall render area - sum of all render ports' areas,
+  // unless the render specifies its own. The ports' areas are read when the
+  // queued render starts, so renders of different areas launched in a row
+  // must specify them.
+  TRectD renderArea(renderDatas[0].m_renderArea);
+  if (renderArea.isEmpty()) {
     QReadLocker sl(&m_portsLock);
 
     for (PortContainerIterator it = m_ports.begin(); it != m_ports.end(); ++it)
@@ -1437,6 +1510,16 @@ void TRendererImp::startRendering(
     if (alias.find("iwa_SmootherFx") != std::string::npos)
       forcePreComputation = true;
 
+    // Fxs with a temporal footprint compute their inputs at other frames than
+    // the rendered one. When multiple frames are rendered, precomputation
+    // lets the predictive cache compute each shared input frame once, and
+    // release it after its last use among the rendered frames.
+    if (!forcePreComputation && renderDatas.size() > 1 &&
+        (fx->hasTemporalFootprint(frame) ||
+         (renderData.m_fxRoot.m_frameB &&
+          renderData.m_fxRoot.m_frameB->hasTemporalFootprint(frame))))
+      forcePreComputation = true;
+
     // Search the alias among stored clusters - and store the frame
     jt = clusters.find(alias);
 
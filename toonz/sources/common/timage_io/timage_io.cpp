@@ -12,10 +12,15 @@
 #include "tiio.h"
 #include "tfilepath_io.h"
 #include "tpixelutils.h"
+#include "tthread.h"
 
 // boost includes
 #include <boost/range.hpp>
 
+// STD includes
+#include <atomic>
+#include <functional>
+
 #ifdef _MSC_VER
 #pragma warning(disable : 4996)
 #endif
@@ -288,6 +293,42 @@ void readRaster_copyLines(const TRasterPT<Pix> &ras, Tiio::Reader *reader,
 
 //------------------------------------------------------------------------------------
 
+//! Reads the whole image with concurrent readBlock() calls. Returns false if
+//! the reader does not support block reading, or failed doing it.
+template <typename Pix>
+bool readRaster_blocks(const TRasterPT<Pix> &ras, Tiio::Reader *reader,
+                       int inLy) {
+  typedef typename pixel_traits<Pix>::buffer_type buffer_type;
+
+  int blockRows = reader->getBlockRowCount();
+  if (blockRows <= 0) return false;
+
+  int blockCount = (inLy + blockRows - 1) / blockRows;
+
+  // Rows in TOP2BOTTOM order are stored from the raster's top
+  bool topDown = (reader->getRowOrder() == Tiio::TOP2BOTTOM);
+  int wrap     = topDown ? -ras->getWrap() : ras->getWrap();
+
+  std::atomic<int> nextBlock(0);
+  std::atomic<bool> failed(false);
+
+  auto readBlocks = [&]() {
+    int b;
+    while (!failed && (b = nextBlock++) < blockCount) {
+      int y = b * blockRows;
+      buffer_type *buffer =
+          (buffer_type *)ras->pixels(topDown ? inLy - 1 - y : y);
+      if (!reader->readBlock(buffer, wrap, b)) failed = true;
+    }
+  };
+
+  TThread::parallelRun(readBlocks, blockCount);
+
+  return !failed;
+}
+
+//------------------------------------------------------------------------------------
+
 template <typename Pix>
 void readRaster(const TRasterPT<Pix> &ras, Tiio::Reader *reader, int x0, int y0,
                 int x1, int y1, int inLx, int inLy, int shrink) {
@@ -297,6 +338,13 @@ void readRaster(const TRasterPT<Pix> &ras, Tiio::Reader *reader, int x0, int y0,
     // Direct read
     ras->lock();
 
+    // Whole images may be read by blocks
+    if (x0 == 0 && y0 == 0 && x1 == inLx - 1 && y1 == inLy - 1 &&
+        readRaster_blocks(ras, reader, inLy)) {
+      ras->unlock();
+      return;
+    }
+
     ptrdiff_t linePad = -x0 * ras->getPixelSize();
 
     if (reader->getRowOrder() == Tiio::BOTTOM2TOP) {
@@ -18,7 +18,7 @@ DEFINE_CLASS_CODE(TRaster, 1)
 
 //------------------------------------------------------------
 
-TRaster::TRaster(int lx, int ly, int pixelSize)
+TRaster::TRaster(int lx, int ly, int pixelSize, bool clear)
     : TSmartObject(m_classCode)
     , m_pixelSize(pixelSize)
     , m_lx(lx)
@@ -26,6 +26,7 @@ TRaster::TRaster(int lx, int ly, int pixelSize)
     , m_wrap(lx)
     , m_parent(0)
     , m_bufferOwner(true)
+    , m_bufferAccount(0)
     , m_buffer(0)
     , m_lockCount(0)
     , m_isLinear(false)
@@ -38,7 +39,7 @@ TRaster::TRaster(int lx, int ly, int pixelSize)
   {
     assert(pixelSize > 0);
     assert(lx > 0 && ly > 0);
-    TBigMemoryManager::instance()->putRaster(this);
+    TBigMemoryManager::instance()->putRaster(this, true, clear);
 
     // m_buffer = new UCHAR[lx*ly*pixelSize];
 
@@ -83,6 +84,7 @@ TRaster::TRaster(int lx, int ly, int pixelSize, int wrap, UCHAR *buffer,
     , m_wrap(wrap)
     , m_buffer(buffer)
     , m_bufferOwner(bufferOwner)
+    , m_bufferAccount(0)
     , m_lockCount(0)
     , m_isLinear(false)
 #ifdef _DEBUG
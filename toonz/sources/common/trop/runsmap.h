@@ -39,7 +39,7 @@
 */
 class RunsMap final : public TRasterT<TPixelGR8> {
 public:
-  RunsMap(int lx, int ly) : TRasterT<TPixelGR8>(lx, ly) { clear(); }
+  RunsMap(int lx, int ly) : TRasterT<TPixelGR8>(lx, ly, false) { clear(); }
 
   const UCHAR &runHeader(int x, int y) const { return pixels(y)[x].value; }
   UCHAR &runHeader(int x, int y) { return pixels(y)[x].value; }
@@ -1271,11 +1271,15 @@ TSoundTrackP TSop::remove(TSoundTrackP src, double t0, double t1,
 
 template <class T>
 TSoundTrackP mixT(TSoundTrackT<T> *st1, double a1, TSoundTrackT<T> *st2,
-                  double a2) {
+                  double a2, bool inPlace) {
   TINT32 sampleCount = std::max(st1->getSampleCount(), st2->getSampleCount());
 
-  TSoundTrackT<T> *dst = new TSoundTrackT<T>(
-      st1->getSampleRate(), st1->getChannelCount(), sampleCount);
+  // when mixing in place, st1 is overwritten if long enough
+  TSoundTrackT<T> *dst =
+      (inPlace && st1->getSampleCount() == sampleCount)
+          ? st1
+          : new TSoundTrackT<T>(st1->getSampleRate(), st1->getChannelCount(),
+                                sampleCount);
 
   T *dstSample = dst->samples();
   T *endDstSample =
@@ -1292,8 +1296,9 @@ TSoundTrackP mixT(TSoundTrackT<T> *st1, double a1, TSoundTrackT<T> *st2,
 
   T *srcSample =
       st1->getSampleCount() > st2->getSampleCount() ? st1Sample : st2Sample;
-  endDstSample                                  = dst->samples() + sampleCount;
-  while (dstSample < endDstSample) *dstSample++ = *srcSample++;
+  endDstSample = dst->samples() + sampleCount;
+  if (srcSample != dstSample)
+    while (dstSample < endDstSample) *dstSample++ = *srcSample++;
 
   return TSoundTrackP(dst);
 }
@@ -1303,10 +1308,16 @@ TSoundTrackP mixT(TSoundTrackT<T> *st1, double a1, TSoundTrackT<T> *st2,
 class TSoundTrackMixer final : public TSoundTransform {
   double m_alpha1, m_alpha2;
   TSoundTrackP m_sndtrack;
+  bool m_inPlace;
 
 public:
-  TSoundTrackMixer(double a1, double a2, const TSoundTrackP &st2)
-      : TSoundTransform(), m_alpha1(a1), m_alpha2(a2), m_sndtrack(st2) {}
+  TSoundTrackMixer(double a1, double a2, const TSoundTrackP &st2,
+                   bool inPlace = false)
+      : TSoundTransform()
+      , m_alpha1(a1)
+      , m_alpha2(a2)
+      , m_sndtrack(st2)
+      , m_inPlace(inPlace) {}
 
   ~TSoundTrackMixer(){};
 
@@ -1316,7 +1327,7 @@ public:
     return (
         mixT(const_cast<TSoundTrackMono8Signed *>(&src), m_alpha1,
              dynamic_cast<TSoundTrackMono8Signed *>(m_sndtrack.getPointer()),
-             m_alpha2));
+             m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackMono8Unsigned &src) override {
@@ -1325,7 +1336,7 @@ public:
     return (
         mixT(const_cast<TSoundTrackMono8Unsigned *>(&src), m_alpha1,
              dynamic_cast<TSoundTrackMono8Unsigned *>(m_sndtrack.getPointer()),
-             m_alpha2));
+             m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackStereo8Signed &src) override {
@@ -1334,7 +1345,7 @@ public:
     return (
         mixT(const_cast<TSoundTrackStereo8Signed *>(&src), m_alpha1,
              dynamic_cast<TSoundTrackStereo8Signed *>(m_sndtrack.getPointer()),
-             m_alpha2));
+             m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackStereo8Unsigned &src) override {
@@ -1343,7 +1354,7 @@ public:
     return (mixT(
         const_cast<TSoundTrackStereo8Unsigned *>(&src), m_alpha1,
         dynamic_cast<TSoundTrackStereo8Unsigned *>(m_sndtrack.getPointer()),
-        m_alpha2));
+        m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackMono16 &src) override {
@@ -1351,7 +1362,7 @@ public:
 
     return (mixT(const_cast<TSoundTrackMono16 *>(&src), m_alpha1,
                  dynamic_cast<TSoundTrackMono16 *>(m_sndtrack.getPointer()),
-                 m_alpha2));
+                 m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackStereo16 &src) override {
@@ -1359,7 +1370,7 @@ public:
 
     return (mixT(const_cast<TSoundTrackStereo16 *>(&src), m_alpha1,
                  dynamic_cast<TSoundTrackStereo16 *>(m_sndtrack.getPointer()),
-                 m_alpha2));
+                 m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackMono24 &src) override {
@@ -1367,7 +1378,7 @@ public:
 
     return (mixT(const_cast<TSoundTrackMono24 *>(&src), m_alpha1,
                  dynamic_cast<TSoundTrackMono24 *>(m_sndtrack.getPointer()),
-                 m_alpha2));
+                 m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackStereo24 &src) override {
@@ -1375,7 +1386,7 @@ public:
 
     return (mixT(const_cast<TSoundTrackStereo24 *>(&src), m_alpha1,
                  dynamic_cast<TSoundTrackStereo24 *>(m_sndtrack.getPointer()),
-                 m_alpha2));
+                 m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackMono32Float &src) override {
@@ -1384,7 +1395,7 @@ public:
     return (
         mixT(const_cast<TSoundTrackMono32Float *>(&src), m_alpha1,
              dynamic_cast<TSoundTrackMono32Float *>(m_sndtrack.getPointer()),
-             m_alpha2));
+             m_alpha2, m_inPlace));
   }
 
   TSoundTrackP compute(const TSoundTrackStereo32Float &src) override {
@@ -1393,7 +1404,7 @@ public:
     return (
         mixT(const_cast<TSoundTrackStereo32Float *>(&src), m_alpha1,
              dynamic_cast<TSoundTrackStereo32Float *>(m_sndtrack.getPointer()),
-             m_alpha2));
+             m_alpha2, m_inPlace));
   }
 };
 
@@ -1408,6 +1419,16 @@ TSoundTrackP TSop::mix(const TSoundTrackP &st1, const TSoundTrackP &st2,
   return (snd);
 }
 
+//------------------------------------------------------------------------------
+
+TSoundTrackP TSop::mixInPlace(const TSoundTrackP &st1, const TSoundTrackP &st2,
+                              double a1, double a2) {
+  a1 = tcrop<double>(a1, 0.0, 1.0);
+  a2 = tcrop<double>(a2, 0.0, 1.0);
+  TSoundTrackMixer mixer(a1, a2, st2, true);
+  return st1->apply(&mixer);
+}
+
 //==============================================================================
 //
 // TSop::FadeIn
@@ -5,9 +5,17 @@
 #include "timagecache.h"
 #include "tsystem.h"
 #include "tconvert.h"
+#include "tprofiler.h"
 #include <set>
+#include <atomic>
 #include "tfilepath_io.h"
 
+#include <QThreadStorage>
+
+#ifdef LINUX
+#include <sys/mman.h>
+#endif
+
 #ifdef _DEBUG
 std::set<TRaster *> Rasters;
 #endif
@@ -62,6 +70,364 @@ unsigned long long allocationSumKB = 0;
 unsigned long allocationCount      = 0;
 }
 
+//******************************************************************************
+//    Raster buffers pool
+//******************************************************************************
+
+namespace {
+
+// Pooled buffers sizes range in (2^(MinSizeBits-1), 2^MaxSizeBits], with 8
+// size classes for each power of 2 - so a buffer wastes less than 1/8 of its
+// class size.
+const int MinSizeBits        = 16;
+const int MaxSizeBits        = 28;
+const int ClassesPerDoubling = 8;
+const int ClassesCount = (MaxSizeBits - MinSizeBits + 1) * ClassesPerDoubling;
+
+const TUINT32 HugePageSize = 2 << 20;
+
+//! Returns the size class of a buffer, or -1 if buffers of the specified size
+//! are not pooled.
+int getSizeClass(TUINT32 size, TUINT32 &classSize) {
+  if (size == 0) return -1;
+
+  int bits = 0;
+  while ((size - 1) >> bits) ++bits;
+  if (bits < MinSizeBits || bits > MaxSizeBits) return -1;
+
+  int shift     = bits - 4;
+  TUINT32 steps = ((size - 1) >> shift) + 1;  // In [9, 16]
+  classSize     = steps << shift;
+
+  return (bits - MinSizeBits) * ClassesPerDoubling + (steps - 9);
+}
+
+//------------------------------------------------------------------------------
+
+}  // namespace
+
+//! Referenced by its thread's pool and by the buffers allocated since the
+//! last stats reset, so that releases from other threads, or of buffers
+//! allocated before the reset, don't alter the live size of the thread.
+struct TBigMemoryManager::RasterAccount {
+  std::atomic<int> m_refCount;
+  std::atomic<TINT64> m_liveSize;  // Bytes allocated and not yet released
+
+  RasterAccount() : m_refCount(1), m_liveSize(0) {}
+
+  void addRef() { ++m_refCount; }
+  void release() {
+    if (--m_refCount == 0) delete this;
+  }
+};
+
+namespace {
+
+//! Buffers pooled by a thread. Buffers are released to the pool of the
+//! releasing thread, so the pool is normally accessed by its thread only -
+//! the mutex just guards it against trims.
+struct ThreadPool {
+  TThread::Mutex m_mutex;
+  std::vector<UCHAR *> m_buffers[ClassesCount];
+  TUINT32 m_size;  // Bytes currently pooled
+
+  // Allocations of the thread, accessed by the thread only
+  TBigMemoryManager::ThreadStats m_stats;
+  TBigMemoryManager::RasterAccount *m_account;
+
+  ThreadPool();
+  ~ThreadPool();
+
+  void trim();
+  void resetStats();
+};
+
+//------------------------------------------------------------------------------
+
+class RasterPool {
+  TThread::Mutex m_mutex;
+  std::set<ThreadPool *> m_pools;
+  QThreadStorage<ThreadPool *> m_threadPool;
+
+public:
+  std::atomic<TINT64> m_capacity;  // Bytes pooled by all the threads at most
+  std::atomic<bool> m_hugePages;
+
+  std::atomic<int> m_allocCounts[ClassesCount];
+  std::atomic<int> m_reuseCounts[ClassesCount];
+
+  // Bytes of the buffers in use and of those waiting in the pools
+  std::atomic<TINT64> m_liveBytes, m_pooledBytes;
+
+public:
+  RasterPool()
+      : m_capacity(256 << 20)
+      , m_hugePages(false)
+      , m_liveBytes(0)
+      , m_pooledBytes(0) {
+    for (int c = 0; c < ClassesCount; ++c)
+      m_allocCounts[c] = m_reuseCounts[c] = 0;
+  }
+
+  static RasterPool *instance() {
+    static RasterPool theInstance;
+    return &theInstance;
+  }
+
+  void addPool(ThreadPool *pool) {
+    TThread::MutexLocker sl(&m_mutex);
+    m_pools.insert(pool);
+  }
+
+  void removePool(ThreadPool *pool) {
+    TThread::MutexLocker sl(&m_mutex);
+    m_pools.erase(pool);
+  }
+
+  ThreadPool *localPool() {
+    if (!m_threadPool.hasLocalData()) m_threadPool.setLocalData(new ThreadPool);
+    return m_threadPool.localData();
+  }
+
+  // The buffer is charged to the returned account until released
+  UCHAR *allocate(TUINT32 size, bool clear,
+                  TBigMemoryManager::RasterAccount *&account);
+  void release(UCHAR *buffer, TUINT32 size,
+               TBigMemoryManager::RasterAccount *account);
+  void trim();
+  void getStats(std::vector<TBigMemoryManager::PoolStats> &stats);
+
+private:
+  UCHAR *allocateBuffer(TUINT32 size, bool clear);
+};
+
+//------------------------------------------------------------------------------
+
+ThreadPool::ThreadPool() : m_size(0), m_account(0) {
+  resetStats();
+  RasterPool::instance()->addPool(this);
+}
+
+ThreadPool::~ThreadPool() {
+  RasterPool::instance()->removePool(this);
+  trim();
+  m_account->release();
+}
+
+//------------------------------------------------------------------------------
+
+void ThreadPool::trim() {
+  TThread::MutexLocker sl(&m_mutex);
+  for (int c = 0; c < ClassesCount; ++c) {
+    for (UCHAR *buffer : m_buffers[c]) free(buffer);
+    std::vector<UCHAR *>().swap(m_buffers[c]);
+  }
+  RasterPool::instance()->m_pooledBytes -= m_size;
+  m_size = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void ThreadPool::resetStats() {
+  m_stats.m_peakSize = m_stats.m_allocSize = m_stats.m_reuseSize = 0;
+  m_stats.m_allocCount = m_stats.m_reuseCount = 0;
+
+  // Buffers allocated so far keep charging the previous account
+  if (m_account) m_account->release();
+  m_account = new TBigMemoryManager::RasterAccount;
+}
+
+//------------------------------------------------------------------------------
+
+UCHAR *RasterPool::allocateBuffer(TUINT32 size, bool clear) {
+#ifdef LINUX
+  if (m_hugePages && size >= HugePageSize) {
+    // Huge pages need aligned buffers. They are still released with free().
+    void *buffer = 0;
+    if (posix_memalign(&buffer, HugePageSize, size) != 0) return 0;
+    madvise(buffer, size, MADV_HUGEPAGE);
+    if (clear) memset(buffer, 0, size);
+    return (UCHAR *)buffer;
+  }
+#endif
+
+  return (UCHAR *)(clear ? calloc(size, 1) : malloc(size));
+}
+
+//------------------------------------------------------------------------------
+
+UCHAR *RasterPool::allocate(TUINT32 size, bool clear,
+                            TBigMemoryManager::RasterAccount *&account) {
+  ThreadPool *pool = localPool();
+
+  // Buffers in the pooled sizes range always get their class size, so they
+  // can be pooled on release whatever the capacity was on allocation
+  TUINT32 classSize = size;
+  int c             = getSizeClass(size, classSize);
+
+  UCHAR *buffer = 0;
+  if (c >= 0) {
+    ++m_allocCounts[c];
+
+    TThread::MutexLocker sl(&pool->m_mutex);
+    if (!pool->m_buffers[c].empty()) {
+      buffer = pool->m_buffers[c].back();
+      pool->m_buffers[c].pop_back();
+      pool->m_size -= classSize;
+      m_pooledBytes -= classSize;
+    }
+  }
+
+  if (buffer) {
+    // Recycled pages are already mapped, so clearing them is cheap
+    ++m_reuseCounts[c];
+    ++pool->m_stats.m_reuseCount;
+    pool->m_stats.m_reuseSize += size;
+    TProfiler::instance()->count("raster reuses", 1);
+    if (clear) memset(buffer, 0, size);
+  } else if (!(buffer = allocateBuffer(classSize, clear))) {
+    // Memory may be just waiting in the pools
+    trim();
+    if (!(buffer = allocateBuffer(classSize, clear))) return 0;
+  }
+
+  TINT64 liveBytes = (m_liveBytes += classSize);
+  ++pool->m_stats.m_allocCount;
+  pool->m_stats.m_allocSize += size;
+  account = pool->m_account;
+  account->addRef();
+  pool->m_stats.m_peakSize = std::max(pool->m_stats.m_peakSize,
+                                      (TINT64)(account->m_liveSize += size));
+
+  if (TProfiler::isActive()) {
+    TProfiler *profiler = TProfiler::instance();
+    profiler->count("raster allocations", 1);
+    profiler->setCounter("raster memory (bytes)", liveBytes);
+  }
+
+  return buffer;
+}
+
+//------------------------------------------------------------------------------
+
+void RasterPool::release(UCHAR *buffer, TUINT32 size,
+                         TBigMemoryManager::RasterAccount *account) {
+  ThreadPool *pool = localPool();
+  account->m_liveSize -= size;
+  account->release();
+
+  TUINT32 classSize = size;
+  int c             = getSizeClass(size, classSize);
+
+  // Buffers allocated before the profiler started are counted as well
+  TINT64 liveBytes = (m_liveBytes -= classSize);
+  TProfiler::instance()->setCounter("raster memory (bytes)", liveBytes);
+
+  if (c >= 0) {
+    // The capacity bounds the pools of all the threads, so that idle buffers
+    // don't grow with the threads count
+    if ((m_pooledBytes += classSize) <= m_capacity) {
+      TThread::MutexLocker sl(&pool->m_mutex);
+      pool->m_buffers[c].push_back(buffer);
+      pool->m_size += classSize;
+      return;
+    }
+    m_pooledBytes -= classSize;
+  }
+
+  free(buffer);
+}
+
+//------------------------------------------------------------------------------
+
+void RasterPool::trim() {
+  TThread::MutexLocker sl(&m_mutex);
+  for (ThreadPool *pool : m_pools) pool->trim();
+}
+
+//------------------------------------------------------------------------------
+
+void RasterPool::getStats(std::vector<TBigMemoryManager::PoolStats> &stats) {
+  int pooledCounts[ClassesCount] = {};
+  {
+    TThread::MutexLocker sl(&m_mutex);
+    for (ThreadPool *pool : m_pools) {
+      TThread::MutexLocker sl(&pool->m_mutex);
+      for (int c = 0; c < ClassesCount; ++c)
+        pooledCounts[c] += (int)pool->m_buffers[c].size();
+    }
+  }
+
+  stats.clear();
+  for (int c = 0; c < ClassesCount; ++c) {
+    if (!m_allocCounts[c]) continue;
+
+    int bits = c / ClassesPerDoubling + MinSizeBits;
+    TBigMemoryManager::PoolStats classStats;
+    classStats.m_bufferSize  = (TUINT32)(c % ClassesPerDoubling + 9)
+                              << (bits - 4);
+    classStats.m_allocCount  = m_allocCounts[c];
+    classStats.m_reuseCount  = m_reuseCounts[c];
+    classStats.m_pooledCount = pooledCounts[c];
+    stats.push_back(classStats);
+  }
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+
+void TBigMemoryManager::setRasterPoolCapacity(TUINT32 sizeInKb) {
+  RasterPool *pool  = RasterPool::instance();
+  pool->m_capacity = (TINT64)sizeInKb << 10;
+  pool->trim();
+}
+
+//------------------------------------------------------------------------------
+
+void TBigMemoryManager::enableHugePages(bool on) {
+  RasterPool::instance()->m_hugePages = on;
+}
+
+//------------------------------------------------------------------------------
+
+void TBigMemoryManager::trimRasterPool() { RasterPool::instance()->trim(); }
+
+//------------------------------------------------------------------------------
+
+void TBigMemoryManager::getRasterPoolStats(std::vector<PoolStats> &stats) {
+  RasterPool::instance()->getStats(stats);
+}
+
+//------------------------------------------------------------------------------
+
+TINT64 TBigMemoryManager::getRasterMemoryUsage() const {
+  if (isActive()) return m_allocatedMemory - m_availableMemory;
+
+  RasterPool *pool = RasterPool::instance();
+  return pool->m_liveBytes + pool->m_pooledBytes;
+}
+
+//------------------------------------------------------------------------------
+
+TINT64 TBigMemoryManager::getUsedRasterMemory() const {
+  if (isActive()) return m_allocatedMemory - m_availableMemory;
+
+  return RasterPool::instance()->m_liveBytes;
+}
+
+//------------------------------------------------------------------------------
+
+void TBigMemoryManager::resetThreadRasterStats() {
+  RasterPool::instance()->localPool()->resetStats();
+}
+
+//------------------------------------------------------------------------------
+
+void TBigMemoryManager::getThreadRasterStats(ThreadStats &stats) {
+  stats = RasterPool::instance()->localPool()->m_stats;
+}
+
 //------------------------------------------------------------------------------
 
 //! Returns the \b peak size, in KB, of the allocated rasters in current Toonz
@@ -245,7 +611,8 @@ void TBigMemoryManager::getRasterInfo(int &rasterCount,
 
 #endif
 
-bool TBigMemoryManager::putRaster(TRaster *ras, bool canPutOnDisk) {
+bool TBigMemoryManager::putRaster(TRaster *ras, bool canPutOnDisk,
+                                  bool clear) {
   if (!ras->m_parent && ras->m_buffer) {
 #ifdef _DEBUG
     if (ras->m_bufferOwner) Rasters.insert(ras);
@@ -273,7 +640,9 @@ bool TBigMemoryManager::putRaster(TRaster *ras, bool canPutOnDisk) {
       allocationCount++;
     }
 
-    if (!ras->m_parent && !(ras->m_buffer = (UCHAR *)calloc(size, 1))) {
+    RasterAccount *account = 0;
+    if (!ras->m_parent && !(ras->m_buffer = RasterPool::instance()->allocate(
+                                size, clear, account))) {
       // MessageBox( NULL, "Ouch!can't allocate!", "Warning", MB_OK);
       // non c'e' memoria; provo a comprimere
       /*TImageCache::instance()->doCompress(); 
@@ -303,6 +672,7 @@ bool TBigMemoryManager::putRaster(TRaster *ras, bool canPutOnDisk) {
       return ras->m_buffer != 0;
     } else {
       if (!ras->m_parent) {
+        ras->m_bufferAccount = account;
 #ifdef _DEBUG
         m_totRasterMemInKb += size >> 10;
         Rasters.insert(ras);
@@ -431,26 +801,37 @@ void TBigMemoryManager::printMap() {
 
 #endif
 
-bool TBigMemoryManager::releaseRaster(TRaster *ras) {
-  TThread::MutexLocker sl(&m_mutex);
-  UCHAR *buffer = (ras->m_parent) ? (ras->m_parent->m_buffer) : (ras->m_buffer);
-  std::map<UCHAR *, Chunkinfo>::iterator it = m_chunks.find(buffer);
-
-  if (m_theMemory == 0 || it == m_chunks.end()) {
-    assert(buffer);
-    if (!ras->m_parent && ras->m_bufferOwner) {
+bool TBigMemoryManager::releaseUnmanagedRaster(TRaster *ras, UCHAR *buffer) {
+  assert(buffer);
+  if (!ras->m_parent && ras->m_bufferOwner) {
+    TUINT32 size = ras->getPixelSize() * ras->getLx() * ras->getLy();
+    if (ras->m_bufferAccount)
+      RasterPool::instance()->release(buffer, size, ras->m_bufferAccount);
+    else
       free(buffer);
 #ifdef _DEBUG
-      m_totRasterMemInKb -=
-          (ras->getPixelSize() * ras->getLx() * ras->getLy()) >> 10;
-      Rasters.erase(ras);
+    m_totRasterMemInKb -= size >> 10;
+    Rasters.erase(ras);
 #endif
-    }
+  }
 
-    // assert(findRaster(ras)==0);
+  // assert(findRaster(ras)==0);
 
-    return false;
-  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
+bool TBigMemoryManager::releaseRaster(TRaster *ras) {
+  UCHAR *buffer = (ras->m_parent) ? (ras->m_parent->m_buffer) : (ras->m_buffer);
+
+  // No chunks are mapped while inactive: avoid locking the manager
+  if (m_theMemory == 0) return releaseUnmanagedRaster(ras, buffer);
+
+  TThread::MutexLocker sl(&m_mutex);
+  std::map<UCHAR *, Chunkinfo>::iterator it = m_chunks.find(buffer);
+
+  if (it == m_chunks.end()) return releaseUnmanagedRaster(ras, buffer);
 
   assert(ras->m_lockCount == 0);
 
@@ -0,0 +1,117 @@
+
+
+#include "tmemorygovernor.h"
+#include "tbigmemorymanager.h"
+#include "tprofiler.h"
+
+#include <algorithm>
+
+//***********************************************************************************
+//    TMemoryGovernor implementation
+//***********************************************************************************
+
+TMemoryGovernor::TMemoryGovernor() : m_budget(0) {}
+
+//------------------------------------------------------------------------------
+
+TMemoryGovernor *TMemoryGovernor::instance() {
+  static TMemoryGovernor theInstance;
+  return &theInstance;
+}
+
+//------------------------------------------------------------------------------
+
+void TMemoryGovernor::setBudget(TINT64 sizeInKb) {
+  m_budget = std::max(sizeInKb, (TINT64)0) << 10;
+}
+
+//------------------------------------------------------------------------------
+
+TINT64 TMemoryGovernor::getBudget() const { return m_budget >> 10; }
+
+//------------------------------------------------------------------------------
+
+void TMemoryGovernor::addConsumer(TMemoryConsumer *consumer, int rank) {
+  TThread::MutexLocker sl(&m_mutex);
+
+  ConsumerData data = {consumer, rank};
+
+  auto it = m_consumers.begin();
+  while (it != m_consumers.end() && it->m_rank <= rank) ++it;
+  m_consumers.insert(it, data);
+}
+
+//------------------------------------------------------------------------------
+
+//! Waits for any enforce() that may be using the consumer.
+void TMemoryGovernor::removeConsumer(TMemoryConsumer *consumer) {
+  TThread::MutexLocker sl(&m_mutex);
+
+  m_consumers.erase(std::remove_if(m_consumers.begin(), m_consumers.end(),
+                                   [consumer](const ConsumerData &data) {
+                                     return data.m_consumer == consumer;
+                                   }),
+                    m_consumers.end());
+}
+
+//------------------------------------------------------------------------------
+
+TINT64 TMemoryGovernor::getMemoryUsage() const {
+  return TBigMemoryManager::instance()->getRasterMemoryUsage();
+}
+
+//------------------------------------------------------------------------------
+
+TINT64 TMemoryGovernor::getUsedMemory() const {
+  return TBigMemoryManager::instance()->getUsedRasterMemory();
+}
+
+//------------------------------------------------------------------------------
+
+bool TMemoryGovernor::isOverBudget() const {
+  TINT64 budget = m_budget;
+  return budget > 0 && getMemoryUsage() > budget;
+}
+
+//------------------------------------------------------------------------------
+
+void TMemoryGovernor::enforce() {
+  if (!isOverBudget()) return;
+
+  TThread::MutexLocker sl(&m_mutex);
+
+  TINT64 usage               = getMemoryUsage();
+  TBigMemoryManager *manager = TBigMemoryManager::instance();
+
+  // Leave some room, so that the next allocations don't enforce again
+  TINT64 target = m_budget / 10 * 9;
+
+  // Memory released by the consumers goes back to the raster pools first
+  manager->trimRasterPool();
+
+  for (const ConsumerData &data : m_consumers) {
+    TINT64 excess = getMemoryUsage() - target;
+    if (excess <= 0) break;
+
+    data.m_consumer->releaseMemory(excess);
+    manager->trimRasterPool();
+  }
+
+  if (TProfiler::isActive())
+    TProfiler::instance()->addInstant(
+        "memory", "memory budget enforced",
+        TProfiler::arg("released", usage - getMemoryUsage()));
+}
+
+//------------------------------------------------------------------------------
+
+int TMemoryGovernor::getAdmittedThreads(int threadsCount) const {
+  TINT64 budget = m_budget;
+  if (budget <= 0 || threadsCount <= 1) return threadsCount;
+
+  double load = getMemoryUsage() / (double)budget;
+  if (load <= 0.75) return threadsCount;
+  if (load >= 1.0) return 1;
+
+  return 1 + (int)((threadsCount - 1) * (1.0 - load) / 0.25);
+}
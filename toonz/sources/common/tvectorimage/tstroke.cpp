@@ -10,6 +10,7 @@
 #include "cornerdetector.h"
 
 #include <limits>
+#include <atomic>
 
 #include "tstroke.h"
 
@@ -726,7 +727,7 @@ private:
 //-----------------------------------------------------------------------------
 
 namespace {
-int maxStrokeId = 0;
+std::atomic<int> maxStrokeId(0);  // Strokes may be built by multiple threads
 }
 
 /*! init() is required to initialize all variable
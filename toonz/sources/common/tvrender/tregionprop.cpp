@@ -126,13 +126,13 @@ void OutlineRegionProp::computeRegionOutline() {
   int subRegionNumber = getRegion()->getSubregionCount();
   TRegionOutline::PointVector app;
 
-  m_outline.m_exterior.clear();
+  // Also drops the cached triangulation
+  m_outline.clear();
 
   computeOutline(getRegion(), app, m_pixelSize);
   m_outline.m_doAntialiasing = true;
 
   m_outline.m_exterior.push_back(app);
-  m_outline.m_interior.clear();
   m_outline.m_interior.reserve(subRegionNumber);
   for (int i = 0; i < subRegionNumber; i++) {
     app.clear();
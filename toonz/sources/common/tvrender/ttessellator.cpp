@@ -10,20 +10,15 @@
 #include "tcg/tcg_numeric_ops.h"
 #include "trop.h"
 
+#include <deque>
+#include <limits>
+
 //#include "tlevel_io.h"
 
 #ifndef _WIN32
 #define CALLBACK
 #endif
-// To avoid linking problems with HP ZX2000
-#if defined(LINUX) || defined(FREEBSD)
-#ifdef GLU_VERSION_1_2
-#undef GLU_VERSION_1_2
-#endif
-#ifndef GLU_VERSION_1_1
-#define GLU_VERSION_1_1
-#endif
-#endif
+
 //==================================================================
 
 #ifndef checkErrorsByGL
@@ -40,248 +35,726 @@
   }
 #endif
 
-TglTessellator::GLTess::GLTess() {
-  m_tess = gluNewTess();
-  assert(m_tess);
+namespace {
+
+/*!
+  CPU triangulation of region outlines, based on the ear clipping scheme
+  (outer boundaries are joined to their holes through bridge edges, and
+  degenerate or self-intersecting boundaries are cured before being split
+  along valid diagonals).
+
+  Vertices are kept in a circular doubly linked list. Outer boundaries are
+  oriented counterclockwise, holes clockwise.
+*/
+
+struct EarNode {
+  int m_i;  // Index of the originating input vertex
+  TPointD m_p;
+  EarNode *m_prev, *m_next;
+  bool m_steiner;
+
+  EarNode(int i, const TPointD &p)
+      : m_i(i), m_p(p), m_prev(0), m_next(0), m_steiner(false) {}
+};
+
+//-------------------------------------------------------------------
+
+class EarClipper {
+  std::deque<EarNode> m_nodes;  // deque keeps nodes' addresses stable
+  std::vector<TPointD> &m_triangles;
+  int m_vertexCount;
+
+public:
+  EarClipper(std::vector<TPointD> &triangles)
+      : m_triangles(triangles), m_vertexCount(0) {}
+
+  void triangulate(const TRegionOutline::PointVector &exterior,
+                   const std::vector<const TRegionOutline::PointVector *>
+                       &holes);
+
+private:
+  // Twice the signed area of the triangle (p, q, r); negative when the
+  // triangle is counterclockwise.
+  static double area(const EarNode *p, const EarNode *q, const EarNode *r) {
+    return (q->m_p.y - p->m_p.y) * (r->m_p.x - q->m_p.x) -
+           (q->m_p.x - p->m_p.x) * (r->m_p.y - q->m_p.y);
+  }
+
+  static bool equals(const EarNode *a, const EarNode *b) {
+    return a->m_p.x == b->m_p.x && a->m_p.y == b->m_p.y;
+  }
+
+  static bool pointInTriangle(const TPointD &a, const TPointD &b,
+                              const TPointD &c, const TPointD &p) {
+    return (c.x - p.x) * (a.y - p.y) >= (a.x - p.x) * (c.y - p.y) &&
+           (a.x - p.x) * (b.y - p.y) >= (b.x - p.x) * (a.y - p.y) &&
+           (b.x - p.x) * (c.y - p.y) >= (c.x - p.x) * (b.y - p.y);
+  }
+
+  static int sign(double v) { return (v > 0) ? 1 : (v < 0) ? -1 : 0; }
+
+  static bool onSegment(const EarNode *p, const EarNode *q, const EarNode *r) {
+    return q->m_p.x <= std::max(p->m_p.x, r->m_p.x) &&
+           q->m_p.x >= std::min(p->m_p.x, r->m_p.x) &&
+           q->m_p.y <= std::max(p->m_p.y, r->m_p.y) &&
+           q->m_p.y >= std::min(p->m_p.y, r->m_p.y);
+  }
+
+  static bool intersects(const EarNode *p1, const EarNode *q1,
+                         const EarNode *p2, const EarNode *q2);
+  static bool intersectsPolygon(const EarNode *a, const EarNode *b);
+  static bool locallyInside(const EarNode *a, const EarNode *b);
+  static bool middleInside(const EarNode *a, const EarNode *b);
+  static bool isValidDiagonal(const EarNode *a, const EarNode *b);
+  static bool isEar(const EarNode *ear);
+
+  EarNode *insertNode(int i, const TPointD &p, EarNode *last);
+  static void removeNode(EarNode *p) {
+    p->m_next->m_prev = p->m_prev;
+    p->m_prev->m_next = p->m_next;
+  }
+
+  EarNode *linkedList(const TRegionOutline::PointVector &pts, bool ccw);
+  EarNode *filterPoints(EarNode *start, EarNode *end = 0);
+  EarNode *splitPolygon(EarNode *a, EarNode *b);
+
+  EarNode *eliminateHole(EarNode *hole, EarNode *outerNode);
+  EarNode *findHoleBridge(EarNode *hole, EarNode *outerNode);
+
+  void addTriangle(const EarNode *a, const EarNode *b, const EarNode *c) {
+    m_triangles.push_back(a->m_p);
+    m_triangles.push_back(b->m_p);
+    m_triangles.push_back(c->m_p);
+  }
+
+  void earcutLinked(EarNode *ear, int pass);
+  EarNode *cureLocalIntersections(EarNode *start);
+  void splitEarcut(EarNode *start);
+};
+
+//-------------------------------------------------------------------
+
+bool EarClipper::intersects(const EarNode *p1, const EarNode *q1,
+                            const EarNode *p2, const EarNode *q2) {
+  int o1 = sign(area(p1, q1, p2)), o2 = sign(area(p1, q1, q2)),
+      o3 = sign(area(p2, q2, p1)), o4 = sign(area(p2, q2, q1));
+
+  if (o1 != o2 && o3 != o4) return true;
+
+  if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+  if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+  if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+  if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+
+  return false;
 }
 
-//------------------------------------------------------------------
+//-------------------------------------------------------------------
 
-TglTessellator::GLTess::~GLTess() { gluDeleteTess(m_tess); }
+bool EarClipper::intersectsPolygon(const EarNode *a, const EarNode *b) {
+  const EarNode *p = a;
+  do {
+    if (p->m_i != a->m_i && p->m_next->m_i != a->m_i && p->m_i != b->m_i &&
+        p->m_next->m_i != b->m_i && intersects(p, p->m_next, a, b))
+      return true;
+    p = p->m_next;
+  } while (p != a);
 
-//==================================================================
+  return false;
+}
 
-namespace {
+//-------------------------------------------------------------------
 
-extern "C" {
-static void CALLBACK tessellateTexture(const GLdouble *tex) {
-  double u = tex[0] * 0.01;
-  double v = tex[1] * 0.01;
-  glTexCoord2d(u, v);
-  glVertex2dv(tex);
+bool EarClipper::locallyInside(const EarNode *a, const EarNode *b) {
+  return area(a->m_prev, a, a->m_next) < 0
+             ? area(a, b, a->m_next) >= 0 && area(a, a->m_prev, b) >= 0
+             : area(a, b, a->m_prev) < 0 || area(a, a->m_next, b) < 0;
 }
+
+//-------------------------------------------------------------------
+
+bool EarClipper::middleInside(const EarNode *a, const EarNode *b) {
+  const EarNode *p = a;
+  bool inside      = false;
+  double px = (a->m_p.x + b->m_p.x) * 0.5, py = (a->m_p.y + b->m_p.y) * 0.5;
+  do {
+    const TPointD &p0 = p->m_p, &p1 = p->m_next->m_p;
+    if (((p0.y > py) != (p1.y > py)) && p1.y != p0.y &&
+        (px < (p1.x - p0.x) * (py - p0.y) / (p1.y - p0.y) + p0.x))
+      inside = !inside;
+    p = p->m_next;
+  } while (p != a);
+
+  return inside;
 }
 
 //-------------------------------------------------------------------
 
-TThread::Mutex CombineDataGuard;
+bool EarClipper::isValidDiagonal(const EarNode *a, const EarNode *b) {
+  return a->m_next->m_i != b->m_i && a->m_prev->m_i != b->m_i &&
+         !intersectsPolygon(a, b) &&
+         ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+           (area(a->m_prev, a, b->m_prev) != 0 ||
+            area(a, b->m_prev, b) != 0)) ||
+          (equals(a, b) && area(a->m_prev, a, a->m_next) > 0 &&
+           area(b->m_prev, b, b->m_next) > 0));
+}
 
-static std::list<GLdouble *> Combine_data;
+//-------------------------------------------------------------------
 
-extern "C" {
-static void CALLBACK myCombine(GLdouble coords[3], GLdouble *d[4], GLfloat w[4],
-                               GLdouble **dataOut) {
-  GLdouble *newCoords = new GLdouble[3];
-
-  newCoords[0] = coords[0];
-  newCoords[1] = coords[1];
-  newCoords[2] = coords[2];
-  Combine_data.push_back(newCoords);
-  *dataOut = newCoords;
+bool EarClipper::isEar(const EarNode *ear) {
+  const EarNode *a = ear->m_prev, *b = ear, *c = ear->m_next;
+  if (area(a, b, c) >= 0) return false;  // Reflex vertex
+
+  double x0 = std::min(a->m_p.x, std::min(b->m_p.x, c->m_p.x)),
+         y0 = std::min(a->m_p.y, std::min(b->m_p.y, c->m_p.y)),
+         x1 = std::max(a->m_p.x, std::max(b->m_p.x, c->m_p.x)),
+         y1 = std::max(a->m_p.y, std::max(b->m_p.y, c->m_p.y));
+
+  // No other vertex may lie inside the candidate ear
+  for (const EarNode *p = c->m_next; p != a; p = p->m_next) {
+    if (p->m_p.x >= x0 && p->m_p.x <= x1 && p->m_p.y >= y0 &&
+        p->m_p.y <= y1 && pointInTriangle(a->m_p, b->m_p, c->m_p, p->m_p) &&
+        area(p->m_prev, p, p->m_next) >= 0)
+      return false;
+  }
+
+  return true;
 }
+
+//-------------------------------------------------------------------
+
+EarNode *EarClipper::insertNode(int i, const TPointD &p, EarNode *last) {
+  m_nodes.push_back(EarNode(i, p));
+  EarNode *node = &m_nodes.back();
+
+  if (!last)
+    node->m_prev = node->m_next = node;
+  else {
+    node->m_next         = last->m_next;
+    node->m_prev         = last;
+    last->m_next->m_prev = node;
+    last->m_next         = node;
+  }
+
+  return node;
 }
 
-//===================================================================
+//-------------------------------------------------------------------
+
+EarNode *EarClipper::linkedList(const TRegionOutline::PointVector &pts,
+                                bool ccw) {
+  int i, count = pts.size();
 
-// typedef std::vector<T3DPointD>::iterator Vect3D_iter;
+  double signedArea = 0.0;
+  for (i = 0; i < count; ++i) {
+    const T3DPointD &p0 = pts[(i + count - 1) % count], &p1 = pts[i];
+    signedArea += (p0.x - p1.x) * (p1.y + p0.y);
+  }
+
+  EarNode *last = 0;
+  if (ccw == (signedArea > 0))
+    for (i = 0; i < count; ++i)
+      last = insertNode(m_vertexCount + i, TPointD(pts[i].x, pts[i].y), last);
+  else
+    for (i = count - 1; i >= 0; --i)
+      last = insertNode(m_vertexCount + i, TPointD(pts[i].x, pts[i].y), last);
+
+  m_vertexCount += count;
+
+  if (last && equals(last, last->m_next)) {
+    removeNode(last);
+    last = (last == last->m_next) ? 0 : last->m_next;
+  }
+
+  return last;
+}
 
 //-------------------------------------------------------------------
+
+EarNode *EarClipper::filterPoints(EarNode *start, EarNode *end) {
+  if (!start) return start;
+  if (!end) end = start;
+
+  EarNode *p = start;
+  bool again;
+  do {
+    again = false;
+
+    if (!p->m_steiner &&
+        (equals(p, p->m_next) || area(p->m_prev, p, p->m_next) == 0)) {
+      removeNode(p);
+      p = end = p->m_prev;
+      if (p == p->m_next) break;
+      again = true;
+    } else
+      p = p->m_next;
+  } while (again || p != end);
+
+  return end;
 }
 
 //-------------------------------------------------------------------
 
-#ifdef _WIN32
-typedef GLvoid(CALLBACK *GluCallback)(void);
-#endif
+EarNode *EarClipper::splitPolygon(EarNode *a, EarNode *b) {
+  m_nodes.push_back(EarNode(a->m_i, a->m_p));
+  EarNode *a2 = &m_nodes.back();
+  m_nodes.push_back(EarNode(b->m_i, b->m_p));
+  EarNode *b2 = &m_nodes.back();
 
-#if defined(MACOSX) || defined(LINUX) || defined(FREEBSD) || defined(HAIKU)
+  EarNode *an = a->m_next, *bp = b->m_prev;
 
-typedef GLvoid (*GluCallback)();
+  a->m_next = b, b->m_prev = a;
+  a2->m_next = an, an->m_prev = a2;
+  b2->m_next = a2, a2->m_prev = b2;
+  bp->m_next = b2, b2->m_prev = bp;
 
-#endif
+  return b2;
+}
 
-void TglTessellator::doTessellate(GLTess &glTess, const TColorFunction *cf,
-                                  const bool antiAliasing,
-                                  TRegionOutline outline, const TAffine &aff) {
-  QMutexLocker sl(&CombineDataGuard);
+//-------------------------------------------------------------------
 
-  Combine_data.clear();
-  assert(glTess.m_tess);
+EarNode *EarClipper::findHoleBridge(EarNode *hole, EarNode *outerNode) {
+  EarNode *p = outerNode, *m = 0;
+  double hx = hole->m_p.x, hy = hole->m_p.y,
+         qx = -(std::numeric_limits<double>::max)();
+
+  // Find the outer segment to the left of the hole point which intersects
+  // the horizontal ray, and its endpoint with the lower x
+  do {
+    const TPointD &p0 = p->m_p, &p1 = p->m_next->m_p;
+    if (hy <= p0.y && hy >= p1.y && p1.y != p0.y) {
+      double x = p0.x + (hy - p0.y) * (p1.x - p0.x) / (p1.y - p0.y);
+      if (x <= hx && x > qx) {
+        qx = x;
+        m  = (p0.x < p1.x) ? p : p->m_next;
+        if (x == hx) return m;
+      }
+    }
+    p = p->m_next;
+  } while (p != outerNode);
+
+  if (!m) return 0;
+
+  // Look for reflex vertices inside the triangle (hole point, ray
+  // intersection, m); if any, pick the one with the minimum angle from the
+  // ray as the bridge's endpoint.
+  EarNode *stop = m;
+  TPointD mp    = m->m_p;
+  double tanMin = (std::numeric_limits<double>::max)();
+
+  p = m;
+  do {
+    if (hx >= p->m_p.x && p->m_p.x >= mp.x && hx != p->m_p.x &&
+        pointInTriangle(TPointD(hy < mp.y ? hx : qx, hy), mp,
+                        TPointD(hy < mp.y ? qx : hx, hy), p->m_p)) {
+      double tan = fabs(hy - p->m_p.y) / (hx - p->m_p.x);
+      if (locallyInside(p, hole) &&
+          (tan < tanMin ||
+           (tan == tanMin &&
+            (p->m_p.x > m->m_p.x ||
+             (p->m_p.x == m->m_p.x && area(m->m_prev, m, p->m_prev) < 0 &&
+              area(p->m_next, m, m->m_next) < 0))))) {
+        m      = p;
+        tanMin = tan;
+      }
+    }
+    p = p->m_next;
+  } while (p != stop);
 
-  gluTessCallback(glTess.m_tess, GLU_TESS_BEGIN, (GluCallback)glBegin);
-  gluTessCallback(glTess.m_tess, GLU_TESS_END, (GluCallback)glEnd);
+  return m;
+}
 
-  gluTessCallback(glTess.m_tess, GLU_TESS_COMBINE, (GluCallback)myCombine);
+//-------------------------------------------------------------------
 
-#ifdef GLU_VERSION_1_2
-  gluTessBeginPolygon(glTess.m_tess, NULL);
-  gluTessProperty(glTess.m_tess, GLU_TESS_WINDING_RULE,
-                  GLU_TESS_WINDING_POSITIVE);
-#else
-#ifdef GLU_VERSION_1_1
-  gluBeginPolygon(glTess.m_tess);
-#else
-  assert(false);
-#endif
-#endif
+EarNode *EarClipper::eliminateHole(EarNode *hole, EarNode *outerNode) {
+  EarNode *bridge = findHoleBridge(hole, outerNode);
+  if (!bridge) return outerNode;
 
-  for (TRegionOutline::Boundary::iterator poly_it = outline.m_exterior.begin();
-       poly_it != outline.m_exterior.end(); ++poly_it) {
-#ifdef GLU_VERSION_1_2
-    gluTessBeginContour(glTess.m_tess);
-#else
-#ifdef GLU_VERSION_1_1
-    gluNextContour(glTess.m_tess, GLU_EXTERIOR);
-#else
-    assert(false);
-#endif
-#endif
+  EarNode *bridgeReverse = splitPolygon(bridge, hole);
+  filterPoints(bridgeReverse, bridgeReverse->m_next);
+
+  return filterPoints(bridge, bridge->m_next);
+}
+
+//-------------------------------------------------------------------
+
+EarNode *EarClipper::cureLocalIntersections(EarNode *start) {
+  EarNode *p = start;
+  do {
+    EarNode *a = p->m_prev, *b = p->m_next->m_next;
+
+    if (!equals(a, b) && intersects(a, p, p->m_next, b) &&
+        locallyInside(a, b) && locallyInside(b, a)) {
+      addTriangle(a, p, b);
 
-    for (TRegionOutline::PointVector::iterator it = poly_it->begin();
-         it != poly_it->end(); ++it) {
-      // T3DPointD p = *it;
-      it->x = aff.a11 * it->x + aff.a12 * it->y;
-      it->y = aff.a21 * it->x + aff.a22 * it->y;
+      removeNode(p);
+      removeNode(p->m_next);
 
-      gluTessVertex(glTess.m_tess, &(it->x), &(it->x));
+      p = start = b;
     }
-#ifdef GLU_VERSION_1_2
-    gluTessEndContour(glTess.m_tess);
-#endif
-  }
+    p = p->m_next;
+  } while (p != start);
 
-  int subRegionNumber = outline.m_interior.size();
-  if (subRegionNumber > 0) {
-    for (TRegionOutline::Boundary::iterator poly_it =
-             outline.m_interior.begin();
-         poly_it != outline.m_interior.end(); ++poly_it) {
-#ifdef GLU_VERSION_1_2
-      gluTessBeginContour(glTess.m_tess);
-#else
-#ifdef GLU_VERSION_1_1
-      gluNextContour(glTess.m_tess, GLU_INTERIOR);
-#else
-      assert(false);
-#endif
-#endif
+  return filterPoints(p);
+}
 
-      for (TRegionOutline::PointVector::reverse_iterator rit =
-               poly_it->rbegin();
-           rit != poly_it->rend(); ++rit) {
-        // T3DPointD p = *rit;
-        rit->x = aff.a11 * rit->x + aff.a12 * rit->y;
-        rit->y = aff.a21 * rit->x + aff.a22 * rit->y;
-        gluTessVertex(glTess.m_tess, &(rit->x), &(rit->x));
+//-------------------------------------------------------------------
+
+void EarClipper::splitEarcut(EarNode *start) {
+  // Look for a valid diagonal that divides the polygon into two
+  EarNode *a = start;
+  do {
+    EarNode *b = a->m_next->m_next;
+    while (b != a->m_prev) {
+      if (a->m_i != b->m_i && isValidDiagonal(a, b)) {
+        EarNode *c = splitPolygon(a, b);
+
+        a = filterPoints(a, a->m_next);
+        c = filterPoints(c, c->m_next);
+
+        earcutLinked(a, 0);
+        earcutLinked(c, 0);
+        return;
       }
+      b = b->m_next;
+    }
+    a = a->m_next;
+  } while (a != start);
+}
 
-#ifdef GLU_VERSION_1_2
-      gluTessEndContour(glTess.m_tess);
-#endif
+//-------------------------------------------------------------------
+
+void EarClipper::earcutLinked(EarNode *ear, int pass) {
+  if (!ear) return;
+
+  EarNode *stop = ear, *prev, *next;
+
+  while (ear->m_prev != ear->m_next) {
+    prev = ear->m_prev, next = ear->m_next;
+
+    if (isEar(ear)) {
+      addTriangle(prev, ear, next);
+      removeNode(ear);
+
+      // Skipping the next vertex leads to less sliver triangles
+      ear = stop = next->m_next;
+      continue;
+    }
+
+    ear = next;
+
+    if (ear == stop) {
+      // No more ears were found. Filter out degenerate points and try
+      // again, then try curing self-intersections, and finally split the
+      // remaining polygon along a valid diagonal.
+      if (pass == 0)
+        earcutLinked(filterPoints(ear), 1);
+      else if (pass == 1)
+        earcutLinked(cureLocalIntersections(filterPoints(ear)), 2);
+      else if (pass == 2)
+        splitEarcut(ear);
+
+      break;
     }
   }
+}
 
-#ifdef GLU_VERSION_1_2
-  gluTessEndPolygon(glTess.m_tess);
-#else
-#ifdef GLU_VERSION_1_1
-  gluEndPolygon(glTess.m_tess);
-#else
-  assert(false);
-#endif
-#endif
+//-------------------------------------------------------------------
 
-  std::list<GLdouble *>::iterator beginIt, endIt;
-  endIt   = Combine_data.end();
-  beginIt = Combine_data.begin();
-  for (; beginIt != endIt; ++beginIt) delete[](*beginIt);
+inline bool leftmostLess(const EarNode *a, const EarNode *b) {
+  return a->m_p.x < b->m_p.x || (a->m_p.x == b->m_p.x && a->m_p.y < b->m_p.y);
 }
 
-void TglTessellator::doTessellate(GLTess &glTess, const TColorFunction *cf,
-                                  const bool antiAliasing,
-                                  TRegionOutline &outline) {
-  QMutexLocker sl(&CombineDataGuard);
+void EarClipper::triangulate(
+    const TRegionOutline::PointVector &exterior,
+    const std::vector<const TRegionOutline::PointVector *> &holes) {
+  EarNode *outerNode = linkedList(exterior, true);
+  if (!outerNode || outerNode->m_next == outerNode->m_prev) return;
 
-  Combine_data.clear();
-  assert(glTess.m_tess);
+  if (!holes.empty()) {
+    std::vector<EarNode *> queue;
+    queue.reserve(holes.size());
 
-  gluTessCallback(glTess.m_tess, GLU_TESS_BEGIN, (GluCallback)glBegin);
-  gluTessCallback(glTess.m_tess, GLU_TESS_END, (GluCallback)glEnd);
+    for (int h = 0, hCount = holes.size(); h < hCount; ++h) {
+      EarNode *list = linkedList(*holes[h], false);
+      if (!list) continue;
 
-  gluTessCallback(glTess.m_tess, GLU_TESS_COMBINE, (GluCallback)myCombine);
+      if (list == list->m_next) list->m_steiner = true;
 
-#ifdef GLU_VERSION_1_2
-  gluTessBeginPolygon(glTess.m_tess, NULL);
-  gluTessProperty(glTess.m_tess, GLU_TESS_WINDING_RULE,
-                  GLU_TESS_WINDING_POSITIVE);
-#else
-#ifdef GLU_VERSION_1_1
-  gluBeginPolygon(glTess.m_tess);
-#else
-  assert(false);
-#endif
-#endif
+      EarNode *p = list, *leftmost = list;
+      do {
+        if (leftmostLess(p, leftmost)) leftmost = p;
+        p = p->m_next;
+      } while (p != list);
 
-  for (TRegionOutline::Boundary::iterator poly_it = outline.m_exterior.begin();
-       poly_it != outline.m_exterior.end(); ++poly_it) {
-#ifdef GLU_VERSION_1_2
-    gluTessBeginContour(glTess.m_tess);
-#else
-#ifdef GLU_VERSION_1_1
-    gluNextContour(glTess.m_tess, GLU_EXTERIOR);
-#else
-    assert(false);
-#endif
-#endif
+      queue.push_back(leftmost);
+    }
 
-    for (TRegionOutline::PointVector::iterator it = poly_it->begin();
-         it != poly_it->end(); ++it)
-      gluTessVertex(glTess.m_tess, &(it->x), &(it->x));
+    std::sort(queue.begin(), queue.end(), leftmostLess);
 
-#ifdef GLU_VERSION_1_2
-    gluTessEndContour(glTess.m_tess);
-#endif
+    for (int h = 0, hCount = queue.size(); h < hCount; ++h)
+      outerNode = eliminateHole(queue[h], outerNode);
   }
 
-  int subRegionNumber = outline.m_interior.size();
-  if (subRegionNumber > 0) {
-    for (TRegionOutline::Boundary::iterator poly_it =
-             outline.m_interior.begin();
-         poly_it != outline.m_interior.end(); ++poly_it) {
-#ifdef GLU_VERSION_1_2
-      gluTessBeginContour(glTess.m_tess);
-#else
-#ifdef GLU_VERSION_1_1
-      gluNextContour(glTess.m_tess, GLU_INTERIOR);
-#else
-      assert(false);
-#endif
-#endif
+  earcutLinked(outerNode, 0);
+}
 
-      for (TRegionOutline::PointVector::reverse_iterator rit =
-               poly_it->rbegin();
-           rit != poly_it->rend(); ++rit)
-        gluTessVertex(glTess.m_tess, &(rit->x), &(rit->x));
+//-------------------------------------------------------------------
 
-#ifdef GLU_VERSION_1_2
-      gluTessEndContour(glTess.m_tess);
-#endif
+bool isInside(const TRegionOutline::PointVector &poly, const T3DPointD &p) {
+  bool inside = false;
+  for (int i = 0, j = poly.size() - 1, count = poly.size(); i < count;
+       j = i++) {
+    const T3DPointD &pi = poly[i], &pj = poly[j];
+    if (((pi.y > p.y) != (pj.y > p.y)) &&
+        (p.x < (pj.x - pi.x) * (p.y - pi.y) / (pj.y - pi.y) + pi.x))
+      inside = !inside;
+  }
+  return inside;
+}
+
+//-------------------------------------------------------------------
+
+/*!
+  Ear clipping needs simple boundaries: outer boundaries that neither cross
+  nor contain each other, and holes inside them. Other outlines, e.g. with
+  self-intersecting strokes, are left to the GLU tessellator, which applies
+  the positive winding rule.
+*/
+bool isSimpleOutline(const TRegionOutline &outline) {
+  struct Edge {
+    TPointD m_a, m_b;
+    double m_x0, m_x1;
+    int m_contour, m_i, m_count;
+  };
+
+  std::vector<Edge> edges;
+
+  int c = 0;
+  for (int b = 0; b < 2; ++b) {
+    const TRegionOutline::Boundary &boundary =
+        b ? outline.m_interior : outline.m_exterior;
+
+    for (int i = 0, count = boundary.size(); i < count; ++i, ++c) {
+      std::vector<TPointD> pts;
+      for (const T3DPointD &p : boundary[i])
+        if (pts.empty() || pts.back() != TPointD(p.x, p.y))
+          pts.push_back(TPointD(p.x, p.y));
+      while (pts.size() > 1 && pts.back() == pts.front()) pts.pop_back();
+
+      int n = pts.size();
+      if (n < 3) continue;
+
+      for (int j = 0; j < n; ++j) {
+        const TPointD &p0 = pts[j], &p1 = pts[(j + 1) % n];
+        Edge edge = {p0, p1, std::min(p0.x, p1.x), std::max(p0.x, p1.x),
+                     c, j, n};
+        edges.push_back(edge);
+      }
     }
   }
 
-#ifdef GLU_VERSION_1_2
-  gluTessEndPolygon(glTess.m_tess);
-#else
-#ifdef GLU_VERSION_1_1
-  gluEndPolygon(glTess.m_tess);
+  std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+    return a.m_x0 < b.m_x0;
+  });
+
+  auto orientation = [](const TPointD &p, const TPointD &q, const TPointD &r) {
+    double v = (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
+    return (v > 0) ? 1 : (v < 0) ? -1 : 0;
+  };
+  auto within = [](const TPointD &p, const TPointD &q, const TPointD &r) {
+    return q.x <= std::max(p.x, r.x) && q.x >= std::min(p.x, r.x) &&
+           q.y <= std::max(p.y, r.y) && q.y >= std::min(p.y, r.y);
+  };
+
+  // Sweep the edges by x, testing the pairs whose x ranges overlap
+  for (int i = 0, count = edges.size(); i < count; ++i) {
+    const Edge &e = edges[i];
+    for (int j = i + 1; j < count && edges[j].m_x0 <= e.m_x1; ++j) {
+      const Edge &f = edges[j];
+
+      if (e.m_contour == f.m_contour) {
+        int d = abs(e.m_i - f.m_i);
+        if (d == 1 || d == e.m_count - 1) continue;  // Consecutive edges
+      }
+
+      int o1 = orientation(e.m_a, e.m_b, f.m_a),
+          o2 = orientation(e.m_a, e.m_b, f.m_b),
+          o3 = orientation(f.m_a, f.m_b, e.m_a),
+          o4 = orientation(f.m_a, f.m_b, e.m_b);
+
+      if ((o1 != o2 && o3 != o4) || (o1 == 0 && within(e.m_a, f.m_a, e.m_b)) ||
+          (o2 == 0 && within(e.m_a, f.m_b, e.m_b)) ||
+          (o3 == 0 && within(f.m_a, e.m_a, f.m_b)) ||
+          (o4 == 0 && within(f.m_a, e.m_b, f.m_b)))
+        return false;
+    }
+  }
+
+  // With no crossings, a single vertex tells whether a boundary contains
+  // another
+  const TRegionOutline::Boundary &exterior = outline.m_exterior;
+  for (int e = 0, eCount = exterior.size(); e < eCount; ++e) {
+    if (exterior[e].empty()) continue;
+    for (int f = 0; f < eCount; ++f)
+      if (f != e && exterior[f].size() >= 3 &&
+          isInside(exterior[f], exterior[e].front()))
+        return false;
+  }
+
+  for (const TRegionOutline::PointVector &hole : outline.m_interior) {
+    if (hole.empty()) continue;
+
+    int e, eCount = exterior.size();
+    for (e = 0; e < eCount; ++e)
+      if (isInside(exterior[e], hole.front())) break;
+    if (e == eCount) return false;
+  }
+
+  return true;
+}
+
+//-------------------------------------------------------------------
+
+#ifdef _WIN32
+typedef GLvoid(CALLBACK *GluCallback)(void);
 #else
-  assert(false);
-#endif
+typedef GLvoid (*GluCallback)();
 #endif
 
-  std::list<GLdouble *>::iterator beginIt, endIt;
-  endIt   = Combine_data.end();
-  beginIt = Combine_data.begin();
-  for (; beginIt != endIt; ++beginIt) delete[](*beginIt);
+struct GluTriangulation {
+  std::vector<TPointD> &m_triangles;
+  std::deque<T3DPointD> m_combined;  // deque keeps the points in place
+
+  GluTriangulation(std::vector<TPointD> &triangles) : m_triangles(triangles) {}
+};
+
+extern "C" {
+static void CALLBACK tessVertex(void *vertex, void *data) {
+  const GLdouble *v = (const GLdouble *)vertex;
+  ((GluTriangulation *)data)->m_triangles.push_back(TPointD(v[0], v[1]));
+}
+
+// Its presence restricts the output to separate triangles
+static void CALLBACK tessEdgeFlag(GLboolean flag, void *data) {}
+
+static void CALLBACK tessCombine(GLdouble coords[3], void *vertexData[4],
+                                 GLfloat weight[4], void **outData,
+                                 void *data) {
+  std::deque<T3DPointD> &combined = ((GluTriangulation *)data)->m_combined;
+  combined.push_back(T3DPointD(coords[0], coords[1], coords[2]));
+  *outData = &combined.back().x;
+}
+}
+
+//-------------------------------------------------------------------
+
+//! Triangulates the outline with the GLU tessellator. Like ear clipping, it
+//! needs no GL context, and each call uses its own tessellator object.
+void gluTriangulate(TRegionOutline &outline) {
+  GLUtesselator *tess = gluNewTess();
+  if (!tess) return;
+
+  GluTriangulation triangulation(outline.m_triangles);
+
+  gluTessCallback(tess, GLU_TESS_VERTEX_DATA, (GluCallback)tessVertex);
+  gluTessCallback(tess, GLU_TESS_EDGE_FLAG_DATA, (GluCallback)tessEdgeFlag);
+  gluTessCallback(tess, GLU_TESS_COMBINE_DATA, (GluCallback)tessCombine);
+  gluTessProperty(tess, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_POSITIVE);
+
+  gluTessBeginPolygon(tess, &triangulation);
+
+  for (TRegionOutline::PointVector &contour : outline.m_exterior) {
+    gluTessBeginContour(tess);
+    for (T3DPointD &p : contour) gluTessVertex(tess, &p.x, &p.x);
+    gluTessEndContour(tess);
+  }
+
+  // Holes are reversed, as outlines store them in the exterior orientation
+  for (TRegionOutline::PointVector &contour : outline.m_interior) {
+    gluTessBeginContour(tess);
+    for (auto it = contour.rbegin(); it != contour.rend(); ++it)
+      gluTessVertex(tess, &it->x, &it->x);
+    gluTessEndContour(tess);
+  }
+
+  gluTessEndPolygon(tess);
+  gluDeleteTess(tess);
+}
+
+//-------------------------------------------------------------------
+
+void drawTriangles(const std::vector<TPointD> &triangles) {
+  if (triangles.empty()) return;
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(2, GL_DOUBLE, sizeof(TPointD), &triangles[0]);
+  glDrawArrays(GL_TRIANGLES, 0, triangles.size());
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+//-------------------------------------------------------------------
+
+void drawTexturedTriangles(const std::vector<TPointD> &triangles,
+                           const TAffine &aff) {
+  if (triangles.empty()) return;
+
+  std::vector<TPointD> vertices(triangles.size()), texCoords(triangles.size());
+  for (int i = 0, count = triangles.size(); i < count; ++i) {
+    const TPointD &p = triangles[i];
+    vertices[i] = TPointD(aff.a11 * p.x + aff.a12 * p.y,
+                          aff.a21 * p.x + aff.a22 * p.y);
+    texCoords[i] = vertices[i] * 0.01;
+  }
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_DOUBLE, sizeof(TPointD), &vertices[0]);
+  glTexCoordPointer(2, GL_DOUBLE, sizeof(TPointD), &texCoords[0]);
+  glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+//-------------------------------------------------------------------
+}  // namespace
+
+//==================================================================
+
+void TTessellator::triangulate(TRegionOutline &outline) {
+  if (outline.m_trianglesValid) return;
+
+  outline.m_triangles.clear();
+
+  if (!isSimpleOutline(outline)) {
+    gluTriangulate(outline);
+    outline.m_trianglesValid = true;
+    return;
+  }
+
+  // Assign each hole to the first exterior boundary enclosing it
+  int e, eCount = outline.m_exterior.size();
+  std::vector<std::vector<const TRegionOutline::PointVector *>> holes(eCount);
+
+  for (TRegionOutline::Boundary::const_iterator it = outline.m_interior.begin();
+       it != outline.m_interior.end(); ++it) {
+    if (it->empty() || eCount == 0) continue;
+
+    for (e = 0; e < eCount; ++e)
+      if (isInside(outline.m_exterior[e], it->front())) break;
+
+    holes[e < eCount ? e : 0].push_back(&*it);
+  }
+
+  for (e = 0; e < eCount; ++e) {
+    if (outline.m_exterior[e].size() < 3) continue;
+
+    EarClipper clipper(outline.m_triangles);
+    clipper.triangulate(outline.m_exterior[e], holes[e]);
+  }
+
+  outline.m_trianglesValid = true;
 }
 
 //------------------------------------------------------------------
@@ -301,11 +774,9 @@ void TglTessellator::tessellate(const TColorFunction *cf,
     tglEnableLineSmooth();
   }
 
-  TglTessellator::GLTess glTess;
-  gluTessCallback(glTess.m_tess, GLU_TESS_VERTEX, (GluCallback)glVertex3dv);
-
   //------------------------//
-  doTessellate(glTess, cf, antiAliasing, outline);
+  triangulate(outline);
+  drawTriangles(outline.m_triangles);
   //------------------------//
 
   if (antiAliasing && outline.m_doAntialiasing) {
@@ -420,17 +891,9 @@ void TglTessellator::tessellate(const TColorFunction *cf,
   texture->unlock();
   if (texImage != texture) texImage->unlock();
 
-  TglTessellator::GLTess glTess;
-  gluTessCallback(glTess.m_tess, GLU_TESS_VERTEX,
-                  (GluCallback)tessellateTexture);
-  checkErrorsByGL;
-
   //------------------------//
-  if (aff != TAffine())
-    doTessellate(glTess, cf, antiAliasing, outline,
-                 aff);  // Tessellate & render
-  else
-    doTessellate(glTess, cf, antiAliasing, outline);  // Tessellate & render
+  triangulate(outline);
+  drawTexturedTriangles(outline.m_triangles, aff);  // Render
   checkErrorsByGL;
   //------------------------//
   if (aff != TAffine()) glPopMatrix();
@@ -440,8 +903,4 @@ void TglTessellator::tessellate(const TColorFunction *cf,
   checkErrorsByGL;
 }
 
-//------------------------------------------------------------------
-
-// TglTessellator::GLTess TglTessellator::m_glTess;
-
 //=============================================================================
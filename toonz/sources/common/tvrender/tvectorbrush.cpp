@@ -967,6 +967,7 @@ void TOutlineUtil::makeOutline(const TStroke &path, const TRegion &region,
                                const TRectD &regionBox,
                                TRegionOutline &outline) {
   outline.m_doAntialiasing = true;
+  outline.invalidateTriangles();
 
   // Build the external boundary
   {
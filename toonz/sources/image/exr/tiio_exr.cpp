@@ -78,6 +78,13 @@ public:
   void readLine(char* buffer, int x0, int x1, int shrink) override;
   void readLine(short* buffer, int x0, int x1, int shrink) override;
   void readLine(float* buffer, int x0, int x1, int shrink) override;
+
+  // Blocks just convert rows of the decoded image, which is the costly part
+  // along with decoding
+  int getBlockRowCount() override;
+  bool readBlock(char* buffer, int wrap, int blockIndex) override;
+  bool readBlock(short* buffer, int wrap, int blockIndex) override;
+  bool readBlock(float* buffer, int wrap, int blockIndex) override;
   void loadImage();
   void setColorSpaceGamma(const double gamma) override {
     assert(gamma > 0);
@@ -248,6 +255,68 @@ void ExrReader::readLine(float* buffer, int x0, int x1, int shrink) {
   m_row++;
 }
 
+//------------------------------------------------------------
+
+namespace {
+const int ExrBlockRows = 32;
+}
+
+int ExrReader::getBlockRowCount() {
+  if (!m_rgbaBuf) loadImage();
+  return ExrBlockRows;
+}
+
+bool ExrReader::readBlock(char* buffer, int wrap, int blockIndex) {
+  int y0 = blockIndex * ExrBlockRows;
+  int y1 = std::min(y0 + ExrBlockRows, m_info.m_ly);
+  for (int y = y0; y < y1; y++) {
+    TPixel32* pix    = (TPixel32*)buffer + (y - y0) * wrap;
+    TPixel32* endPix = pix + m_info.m_lx;
+    float* v         = m_rgbaBuf + y * m_info.m_lx * 4;
+    for (; pix < endPix; ++pix, v += 4) {
+      pix->r = ftouc(v[0], m_colorSpaceGamma);
+      pix->g = ftouc(v[1], m_colorSpaceGamma);
+      pix->b = ftouc(v[2], m_colorSpaceGamma);
+      pix->m = ftouc(v[3], 1.0f);
+    }
+  }
+  return true;
+}
+
+bool ExrReader::readBlock(short* buffer, int wrap, int blockIndex) {
+  int y0 = blockIndex * ExrBlockRows;
+  int y1 = std::min(y0 + ExrBlockRows, m_info.m_ly);
+  for (int y = y0; y < y1; y++) {
+    TPixel64* pix    = (TPixel64*)buffer + (y - y0) * wrap;
+    TPixel64* endPix = pix + m_info.m_lx;
+    float* v         = m_rgbaBuf + y * m_info.m_lx * 4;
+    for (; pix < endPix; ++pix, v += 4) {
+      pix->r = ftous(v[0], m_colorSpaceGamma);
+      pix->g = ftous(v[1], m_colorSpaceGamma);
+      pix->b = ftous(v[2], m_colorSpaceGamma);
+      pix->m = ftous(v[3], 1.0f);
+    }
+  }
+  return true;
+}
+
+bool ExrReader::readBlock(float* buffer, int wrap, int blockIndex) {
+  int y0 = blockIndex * ExrBlockRows;
+  int y1 = std::min(y0 + ExrBlockRows, m_info.m_ly);
+  for (int y = y0; y < y1; y++) {
+    TPixelF* pix    = (TPixelF*)buffer + (y - y0) * wrap;
+    TPixelF* endPix = pix + m_info.m_lx;
+    float* v        = m_rgbaBuf + y * m_info.m_lx * 4;
+    for (; pix < endPix; ++pix, v += 4) {
+      pix->r = toNonlinear(v[0], m_colorSpaceGamma);
+      pix->g = toNonlinear(v[1], m_colorSpaceGamma);
+      pix->b = toNonlinear(v[2], m_colorSpaceGamma);
+      pix->m = toNonlinear(v[3], 1.0f);
+    }
+  }
+  return true;
+}
+
 //============================================================
 
 Tiio::ExrWriterProperties::ExrWriterProperties()
@@ -13,6 +13,15 @@
 #include "../compatibility/tfile_io.h"
 #include "tenv.h"
 
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <limits>
+#include <unordered_map>
+
 /*=====================================================================*/
 
 #if defined(MACOSX)
@@ -149,15 +158,24 @@ MyOfstream &MyOfstream::operator<<(const std::string &s) {
 class MyIfstream  // The input is done without stl; it was crashing in release
                   // version loading textures!!
 {
+  // The whole file is memory-mapped, so that reads are plain memory copies
+  // and concurrent readers of the same file share the same pages.
+
 private:
   bool m_isIrixEndian;
-  FILE *m_fp;
+  QFile m_file;
+  QByteArray m_fileData;  // Used only when the file could not be mapped
+  const UCHAR *m_data;
+  TUINT32 m_size, m_pos;
 
-public:
-  MyIfstream() : m_isIrixEndian(false) { m_fp = 0; }
-  ~MyIfstream() {
-    if (m_fp) fclose(m_fp);
+  void checkAvailable(TUINT32 length) const {
+    if (m_pos > m_size || m_size - m_pos < length)
+      throw TException("corrupted pli file: unexpected end of file");
   }
+
+public:
+  MyIfstream() : m_isIrixEndian(false), m_data(0), m_size(0), m_pos(0) {}
+  ~MyIfstream() { close(); }
   void setEndianness(bool isIrixEndian) { m_isIrixEndian = isIrixEndian; }
   MyIfstream &operator>>(TUINT32 &un);
   MyIfstream &operator>>(string &un);
@@ -165,37 +183,79 @@ public:
   MyIfstream &operator>>(UCHAR &un);
   MyIfstream &operator>>(char &un);
   void open(const TFilePath &filename);
-  void close() {
-    if (m_fp) fclose(m_fp);
-    m_fp = 0;
-  }
-  TUINT32 tellg() { return (TUINT32)ftell(m_fp); }
+  void close();
+  TUINT32 tellg() { return m_pos; }
   // void seekg(TUINT32 pos, ios_base::seek_dir type);
   void seekg(TUINT32 pos, int type);
   void read(char *m_buf, int length) {
-    fread((void *)m_buf, sizeof(char), length, m_fp);
+    // Like fread(), copies only the available bytes
+    if (m_pos >= m_size || length <= 0) return;
+    TUINT32 count = std::min((TUINT32)length, m_size - m_pos);
+    memcpy(m_buf, m_data + m_pos, count);
+    m_pos += count;
+  }
+  //! Returns the byte at the current position, without consuming it
+  UCHAR peek() const {
+    checkAvailable(1);
+    return m_data[m_pos];
+  }
+  bool isOpen() const { return m_file.isOpen(); }
+  TUINT32 size() const { return m_size; }
+  //! Updates the FNV-1a hash \b hash with the available bytes in
+  //! [offset, offset + length)
+  TUINT32 hash(TUINT32 offset, TUINT32 length, TUINT32 hash) const {
+    TUINT32 end =
+        (offset < m_size) ? offset + std::min(length, m_size - offset) : 0;
+    for (TUINT32 i = offset; i < end; ++i)
+      hash = (hash ^ m_data[i]) * 16777619u;
+    return hash;
   }
 };
 
 /*=====================================================================*/
 
 void MyIfstream::open(const TFilePath &filename) {
-  try {
-    m_fp = fopen(filename, "rb");
-  } catch (TException &) {
+  close();
+
+  m_file.setFileName(filename.getQString());
+  if (!m_file.open(QIODevice::ReadOnly))
     throw TImageException(filename, "File not found");
-  } catch (...) {
-    throw TImageException(filename, "Unhandled exception encountered");
+
+  qint64 size = m_file.size();
+  if (size > (qint64)std::numeric_limits<TUINT32>::max())
+    throw TImageException(filename, "File too large");
+
+  m_size = (TUINT32)size;
+  m_data = m_size ? m_file.map(0, m_size) : 0;
+  if (!m_data && m_size) {
+    // Mapping is not supported by the underlying file system
+    m_fileData = m_file.readAll();
+    if ((TUINT32)m_fileData.size() != m_size)
+      throw TImageException(filename, "Error on reading file");
+    m_data = (const UCHAR *)m_fileData.constData();
   }
+  m_pos = 0;
+}
+
+/*=====================================================================*/
+
+void MyIfstream::close() {
+  if (m_file.isOpen()) {
+    if (m_data && m_fileData.isEmpty()) m_file.unmap((uchar *)m_data);
+    m_file.close();
+  }
+  m_fileData.clear();
+  m_data = 0;
+  m_size = m_pos = 0;
 }
 
 /*=====================================================================*/
 
 void MyIfstream::seekg(TUINT32 pos, int type) {
   if (type == ios_base::beg)
-    fseek(m_fp, pos, SEEK_SET);
+    m_pos = pos;
   else if (type == ios_base::cur)
-    fseek(m_fp, pos, SEEK_CUR);
+    m_pos += pos;
   else
     assert(false);
 }
@@ -203,27 +263,25 @@ void MyIfstream::seekg(TUINT32 pos, int type) {
 /*=====================================================================*/
 
 inline MyIfstream &MyIfstream::operator>>(UCHAR &un) {
-  int ret = fread((void *)&un, sizeof(UCHAR), 1, m_fp);
-  if (ret < 1) throw TException("corrupted pli file: unexpected end of file");
-  // read((char *)&un, sizeof(UCHAR));
+  checkAvailable(sizeof(UCHAR));
+  un = m_data[m_pos++];
   return *this;
 }
 
 /*=====================================================================*/
 
 inline MyIfstream &MyIfstream::operator>>(char &un) {
-  int ret = fread((void *)&un, sizeof(char), 1, m_fp);
-  if (ret < 1) throw TException("corrupted pli file: unexpected end of file");
-  // read((char *)&un, sizeof(char));
+  checkAvailable(sizeof(char));
+  un = (char)m_data[m_pos++];
   return *this;
 }
 
 /*=====================================================================*/
 
 inline MyIfstream &MyIfstream::operator>>(USHORT &un) {
-  int ret = fread((void *)&un, sizeof(USHORT), 1, m_fp);
-  if (ret < 1) throw TException("corrupted pli file: unexpected end of file");
-  //  read((char *)&un, sizeof(USHORT));
+  checkAvailable(sizeof(USHORT));
+  memcpy(&un, m_data + m_pos, sizeof(USHORT));
+  m_pos += sizeof(USHORT);
 
   if (m_isIrixEndian) un = ((un & 0xff00) >> 8) | ((un & 0x00ff) << 8);
   return *this;
@@ -232,9 +290,9 @@ inline MyIfstream &MyIfstream::operator>>(USHORT &un) {
 /*=====================================================================*/
 
 inline MyIfstream &MyIfstream::operator>>(TUINT32 &un) {
-  int ret = fread((void *)&un, sizeof(TUINT32), 1, m_fp);
-  if (ret < 1) throw TException("corrupted pli file: unexpected end of file");
-  // read((char *)&un, sizeof(TUINT32));
+  checkAvailable(sizeof(TUINT32));
+  memcpy(&un, m_data + m_pos, sizeof(TUINT32));
+  m_pos += sizeof(TUINT32);
 
   if (m_isIrixEndian)
     un = ((un & 0xff000000) >> 24) | ((un & 0x00ff0000) >> 8) |
@@ -245,15 +303,12 @@ inline MyIfstream &MyIfstream::operator>>(TUINT32 &un) {
 /*=====================================================================*/
 
 inline MyIfstream &MyIfstream::operator>>(string &un) {
-  string s = "";
   USHORT length;
   (*this) >> length;
-  for (UINT i = 0; i < length; i++) {
-    UCHAR ch;
-    (*this) >> ch;
-    s.append(1, ch);
-  }
-  un = s;
+
+  checkAvailable(length);
+  un.assign((const char *)m_data + m_pos, length);
+  m_pos += length;
 
   return *this;
 }
@@ -312,6 +367,110 @@ public:
   }
 };
 
+/*=====================================================================*/
+
+namespace {
+
+/*!
+  The result of the tags scan performed by ParsedPliImp::loadInfo(): the
+  offsets of the frames, and those of the tags loadInfo() has to parse.
+
+  Indexes are cached process-wide by file path, last modification time and
+  size - so that the many level readers built on the same file (typically one
+  per frame load) only scan it once. Since a file rewritten with the same size
+  may keep its modification time, cached indexes are also checked against
+  the checksum of the tag headers they point to.
+*/
+struct PliInfoIndex {
+  struct InfoTag {
+    USHORT m_type;
+    TUINT32 m_offset;
+    UCHAR m_dynamicTypeBytesNum;  //!< Dynamic data size in effect at the tag
+  };
+
+  std::map<TFrameId, int> m_frameOffsInFile;
+  std::vector<InfoTag> m_infoTags;  //!< Styles, texts and the palette group,
+                                    //! in file order
+  TUINT32 m_checksum;
+};
+
+typedef std::shared_ptr<const PliInfoIndex> PliInfoIndexP;
+
+//-----------------------------------------------------------------------
+
+//! Hashes the file header, and the bytes the index relies on: those just
+//! before each frame offset (the frame tag header and id) and the headers
+//! of the info tags. They change whenever the layout of the file does.
+TUINT32 indexChecksum(const MyIfstream &is, const PliInfoIndex &index) {
+  const TUINT32 headerSize = 256, tagHeaderSize = 16;
+
+  TUINT32 hash = is.hash(0, headerSize, 2166136261u) ^ is.size();
+
+  std::map<TFrameId, int>::const_iterator ft;
+  for (ft = index.m_frameOffsInFile.begin();
+       ft != index.m_frameOffsInFile.end(); ++ft) {
+    TUINT32 offset = ft->second;
+    hash = is.hash(offset - std::min(offset, tagHeaderSize), tagHeaderSize,
+                   hash);
+  }
+
+  std::vector<PliInfoIndex::InfoTag>::const_iterator it;
+  for (it = index.m_infoTags.begin(); it != index.m_infoTags.end(); ++it)
+    hash = is.hash(it->m_offset, tagHeaderSize, hash);
+
+  return hash;
+}
+
+//-----------------------------------------------------------------------
+
+class PliInfoIndexCache {
+  struct Entry {
+    QDateTime m_lastModified;
+    qint64 m_size;
+    PliInfoIndexP m_index;
+  };
+
+  QMutex m_mutex;
+  std::map<QString, Entry> m_entries;
+
+  static const int c_maxEntries = 256;
+
+public:
+  static PliInfoIndexCache *instance() {
+    static PliInfoIndexCache theInstance;
+    return &theInstance;
+  }
+
+  PliInfoIndexP get(const QFileInfo &fi) {
+    QMutexLocker locker(&m_mutex);
+
+    std::map<QString, Entry>::iterator it =
+        m_entries.find(fi.absoluteFilePath());
+    if (it == m_entries.end()) return PliInfoIndexP();
+
+    if (it->second.m_lastModified != fi.lastModified() ||
+        it->second.m_size != fi.size()) {
+      m_entries.erase(it);
+      return PliInfoIndexP();
+    }
+
+    return it->second.m_index;
+  }
+
+  void set(const QFileInfo &fi, const PliInfoIndexP &index) {
+    QMutexLocker locker(&m_mutex);
+
+    if ((int)m_entries.size() >= c_maxEntries) m_entries.clear();
+
+    Entry &entry         = m_entries[fi.absoluteFilePath()];
+    entry.m_lastModified = fi.lastModified();
+    entry.m_size         = fi.size();
+    entry.m_index        = index;
+  }
+};
+
+}  // namespace
+
 /*=====================================================================*/
 class TContentHistory;
 
@@ -334,6 +493,11 @@ public:
   int m_precisionScale;
   std::map<TFrameId, int> m_frameOffsInFile;
 
+  // The file is mapped only while reading from it, so that it can be
+  // overwritten while its level is loaded
+  PliInfoIndexP m_infoIndex;
+  TUINT32 m_tagsOffset = 0;
+
   PliTag *readTextTag();
   PliTag *readPaletteTag();
   PliTag *readPaletteWithAlphaTag();
@@ -386,6 +550,13 @@ public:
   TagElem *findTag(PliTag *tag);
   USHORT readTagHeader();
 
+  void appendTag(TagElem *elem);
+  void clearTags();
+
+  void scanInfoTags(PliInfoIndex &index);
+  void readInfoTags(const PliInfoIndex &index, bool readPlt,
+                    TPalette *&palette, TContentHistory *&history);
+
 public:
   enum errorType {
     NO__ERROR = 0,
@@ -403,6 +574,9 @@ public:
   TagElem *m_lastTag;
   TagElem *m_currTag;
 
+  //! Read tags by file offset; used to resolve references among tags
+  std::unordered_map<TUINT32, PliTag *> m_tagsByOffset;
+
   MyIfstream m_iChan;
   MyOfstream *m_oChan;
 
@@ -539,6 +713,8 @@ ParsedPliImp::ParsedPliImp(const TFilePath &filename, bool readInfo)
   TagElem *tagElem;
   UCHAR maxThickness;
 
+  m_filePath = filename;
+
   // cerr<<m_filePath<<endl;
 
   //#ifdef _WIN32
@@ -601,17 +777,11 @@ ParsedPliImp::ParsedPliImp(const TFilePath &filename, bool readInfo)
 
     m_currDynamicTypeBytesNum = 2;
 
-    while ((tagElem = readTag())) {
-      if (!m_firstTag)
-        m_firstTag = m_lastTag = tagElem;
-      else {
-        m_lastTag->m_next = tagElem;
-        m_lastTag         = m_lastTag->m_next;
-      }
-    }
+    while ((tagElem = readTag())) appendTag(tagElem);
 
     for (tagElem = m_firstTag; tagElem; tagElem = tagElem->m_next)
       tagElem->m_offset = 0;
+    m_tagsByOffset.clear();
 
     m_iChan.close();
   }
@@ -660,9 +830,46 @@ void ParsedPliImp::loadInfo(bool readPlt, TPalette *&palette,
 
   m_currDynamicTypeBytesNum = 2;
 
-  // m_frameOffsInFile = new int[m_framesNumber];
-  // for (int i=0; i<m_framesNumber; i++)
-  //  m_frameOffsInFile[i] = -1;
+  m_tagsOffset = m_iChan.tellg();
+
+  // The tags scan is the expensive part: reuse the index built by previous
+  // readers of the same file, if any
+  QFileInfo fi(m_filePath.getQString());
+  PliInfoIndexP index = PliInfoIndexCache::instance()->get(fi);
+  if (index && index->m_checksum != indexChecksum(m_iChan, *index))
+    index.reset();
+  if (!index) {
+    std::shared_ptr<PliInfoIndex> newIndex(new PliInfoIndex);
+    scanInfoTags(*newIndex);
+    newIndex->m_checksum = indexChecksum(m_iChan, *newIndex);
+    PliInfoIndexCache::instance()->set(fi, newIndex);
+    index = newIndex;
+  }
+
+  m_frameOffsInFile = index->m_frameOffsInFile;
+  readInfoTags(*index, readPlt, palette, history);
+
+  m_infoIndex = index;
+  m_iChan.close();
+
+  assert(m_frameOffsInFile.size() == m_framesNumber);
+  // palette = new TPalette();
+  // for (int i=0; i<256; i++)
+  //  palette->getPage(0)->addStyle(TPixel::Black);
+
+  // File is missing frames!  Load what we can.
+  // Last frame is likely an unusable image. Allow to load in case it was also
+  // the 1st frame, so we don't crash.
+  if (m_framesNumber > m_frameOffsInFile.size()) {
+    m_framesNumber = m_frameOffsInFile.size();
+    throw TException("Not all frames loaded.");
+  }
+}
+
+/*=====================================================================*/
+
+void ParsedPliImp::scanInfoTags(PliInfoIndex &index) {
+  bool paletteFound = false;
 
   TUINT32 pos = m_iChan.tellg();
   USHORT type;
@@ -687,39 +894,24 @@ void ParsedPliImp::loadInfo(bool readPlt, TPalette *&palette,
         if (letter > 0) suffix = QByteArray(&letter, 1);
       }
 
-      m_frameOffsInFile[TFrameId(frame, QString::fromUtf8(suffix))] =
+      index.m_frameOffsInFile[TFrameId(frame, QString::fromUtf8(suffix))] =
           m_iChan.tellg();
 
       // m_iChan.seekg(m_tagLength, ios::cur);
       if (m_majorVersionNumber < 150) m_iChan.seekg(m_tagLength - 2, ios::cur);
-    } else if (type == PliTag::STYLE_NGOBJ) {
-      m_iChan.seekg(pos, ios::beg);
-      TagElem *tagElem = readTag();
-      addTag(*tagElem);
-      tagElem->m_tag = 0;
-      delete tagElem;
-    } else if (type == PliTag::TEXT) {
-      m_iChan.seekg(pos, ios::beg);
-      TagElem *tagElem = readTag();
-      TextTag *textTag = (TextTag *)tagElem->m_tag;
-      history          = new TContentHistory(true);
-      history->deserialize(QString::fromStdString(textTag->m_text));
-      delete tagElem;
-    }
-
-    else if (type == PliTag::GROUP_GOBJ && readPlt)  // la paletta!!!
-    {
-      m_iChan.seekg(pos, ios::beg);
-      TagElem *tagElem   = readTag();
-      GroupTag *grouptag = (GroupTag *)tagElem->m_tag;
-      if (grouptag->m_type == (UCHAR)GroupTag::PALETTE) {
-        readPlt = false;
-        palette = readPalette((GroupTag *)tagElem->m_tag, m_majorVersionNumber,
-                              m_minorVersionNumber);
-      } else
-        assert(grouptag->m_type == (UCHAR)GroupTag::STROKE);
-      delete tagElem;
     } else {
+      PliInfoIndex::InfoTag infoTag = {type, pos, m_currDynamicTypeBytesNum};
+
+      if (type == PliTag::STYLE_NGOBJ || type == PliTag::TEXT)
+        index.m_infoTags.push_back(infoTag);
+      else if (type == PliTag::GROUP_GOBJ && !paletteFound &&
+               m_tagLength > 0 &&
+               m_iChan.peek() == (UCHAR)GroupTag::PALETTE) {
+        // The group type is the first byte of its data
+        index.m_infoTags.push_back(infoTag);
+        paletteFound = true;
+      }
+
       m_iChan.seekg(m_tagLength, ios::cur);
       switch (type) {
       case PliTag::SET_DATA_8_CNTRL:
@@ -737,19 +929,41 @@ void ParsedPliImp::loadInfo(bool readPlt, TPalette *&palette,
     }
     pos = m_iChan.tellg();
   }
+}
 
-  assert(m_frameOffsInFile.size() == m_framesNumber);
-  // palette = new TPalette();
-  // for (int i=0; i<256; i++)
-  //  palette->getPage(0)->addStyle(TPixel::Black);
+/*=====================================================================*/
 
-  // File is missing frames!  Load what we can.
-  // Last frame is likely an unusable image. Allow to load in case it was also
-  // the 1st frame, so we don't crash.
-  if (m_framesNumber > m_frameOffsInFile.size()) {
-    m_framesNumber = m_frameOffsInFile.size();
-    throw TException("Not all frames loaded.");
+void ParsedPliImp::readInfoTags(const PliInfoIndex &index, bool readPlt,
+                                TPalette *&palette,
+                                TContentHistory *&history) {
+  std::vector<PliInfoIndex::InfoTag>::const_iterator it,
+      end = index.m_infoTags.end();
+  for (it = index.m_infoTags.begin(); it != end; ++it) {
+    if (it->m_type == PliTag::GROUP_GOBJ && !readPlt) continue;
+
+    m_iChan.seekg(it->m_offset, ios::beg);
+    m_currDynamicTypeBytesNum = it->m_dynamicTypeBytesNum;
+
+    TagElem *tagElem = readTag();
+    if (!tagElem) continue;
+
+    if (it->m_type == PliTag::STYLE_NGOBJ) {
+      addTag(*tagElem);
+      tagElem->m_tag = 0;
+    } else if (it->m_type == PliTag::TEXT) {
+      TextTag *textTag = (TextTag *)tagElem->m_tag;
+      history          = new TContentHistory(true);
+      history->deserialize(QString::fromStdString(textTag->m_text));
+    } else if (it->m_type == PliTag::GROUP_GOBJ) {
+      assert(((GroupTag *)tagElem->m_tag)->m_type == (UCHAR)GroupTag::PALETTE);
+      palette = readPalette((GroupTag *)tagElem->m_tag, m_majorVersionNumber,
+                            m_minorVersionNumber);
+    }
+
+    delete tagElem;
   }
+
+  m_currDynamicTypeBytesNum = 2;
 }
 
 /*=====================================================================*/
@@ -807,15 +1021,21 @@ USHORT ParsedPliImp::readTagHeader() {
 /*=====================================================================*/
 
 ImageTag *ParsedPliImp::loadFrame(const TFrameId &frameNumber) {
-  m_currDynamicTypeBytesNum = 2;
+  if (!m_iChan.isOpen()) {
+    m_iChan.open(m_filePath);
 
-  TagElem *tagElem = m_firstTag;
-  while (tagElem) {
-    TagElem *auxTag = tagElem;
-    tagElem         = tagElem->m_next;
-    delete auxTag;
+    // The frame offsets come from loadInfo()
+    if (m_infoIndex &&
+        m_infoIndex->m_checksum != indexChecksum(m_iChan, *m_infoIndex))
+      throw TImageException(m_filePath, "File changed while loading");
+
+    m_iChan.seekg(m_tagsOffset, ios::beg);
   }
-  m_firstTag = 0;
+
+  m_currDynamicTypeBytesNum = 2;
+
+  clearTags();
+  TagElem *tagElem;
 
   // PliTag *tag;
   USHORT type = PliTag::IMAGE_BEGIN_GOBJ;
@@ -858,25 +1078,25 @@ ImageTag *ParsedPliImp::loadFrame(const TFrameId &frameNumber) {
     }
 
   if (type == PliTag::END_CNTRL) {
+    m_iChan.close();
     throw TImageException(TFilePath(), "Pli: frame not found");
     return 0;
   }
 
   // trovato; leggo i suoi tag
+  ImageTag *imageTag = 0;
   while ((tagElem = readTag())) {
-    if (!m_firstTag)
-      m_firstTag = m_lastTag = tagElem;
-    else {
-      m_lastTag->m_next = tagElem;
-      m_lastTag         = m_lastTag->m_next;
-    }
+    appendTag(tagElem);
     if (tagElem->m_tag->m_type == PliTag::IMAGE_GOBJ) {
       assert(((ImageTag *)(tagElem->m_tag))->m_numFrame == frameId);
-      return (ImageTag *)tagElem->m_tag;
+      imageTag = (ImageTag *)tagElem->m_tag;
+      break;
     }
   }
 
-  return 0;
+  // Tags hold copies of their data
+  m_iChan.close();
+  return imageTag;
 }
 
 /*=====================================================================*/
@@ -1006,9 +1226,37 @@ TagElem *ParsedPliImp::readTag() {
 /*=====================================================================*/
 
 PliTag *ParsedPliImp::findTagFromOffset(UINT tagOffs) {
-  for (TagElem *elem = m_firstTag; elem; elem = elem->m_next)
-    if (elem->m_offset == tagOffs) return elem->m_tag;
-  return NULL;
+  std::unordered_map<TUINT32, PliTag *>::const_iterator it =
+      m_tagsByOffset.find(tagOffs);
+  return (it != m_tagsByOffset.end()) ? it->second : NULL;
+}
+
+/*=====================================================================*/
+
+void ParsedPliImp::appendTag(TagElem *elem) {
+  if (!m_firstTag)
+    m_firstTag = m_lastTag = elem;
+  else {
+    m_lastTag->m_next = elem;
+    m_lastTag         = m_lastTag->m_next;
+  }
+
+  // The first tag read at a given offset wins, as in the tags list
+  if (elem->m_offset)
+    m_tagsByOffset.insert(std::make_pair(elem->m_offset, elem->m_tag));
+}
+
+/*=====================================================================*/
+
+void ParsedPliImp::clearTags() {
+  TagElem *tagElem = m_firstTag;
+  while (tagElem) {
+    TagElem *auxTag = tagElem;
+    tagElem         = tagElem->m_next;
+    delete auxTag;
+  }
+  m_firstTag = m_lastTag = m_currTag = 0;
+  m_tagsByOffset.clear();
 }
 /*=====================================================================*/
 
@@ -1816,6 +2064,13 @@ bool ParsedPliImp::addTag(const TagElem &elem, bool addFront) {
     m_lastTag->m_next = _tag;
     m_lastTag         = m_lastTag->m_next;
   }
+
+  if (_tag->m_offset) {
+    if (addFront)
+      m_tagsByOffset[_tag->m_offset] = _tag->m_tag;
+    else
+      m_tagsByOffset.insert(std::make_pair(_tag->m_offset, _tag->m_tag));
+  }
   return true;
 }
 
@@ -2736,14 +2991,7 @@ double ParsedPli::getThickRatio() const { return imp->m_thickRatio; }
 
 /*=====================================================================*/
 
-ParsedPliImp::~ParsedPliImp() {
-  TagElem *tag = m_firstTag;
-  while (tag) {
-    TagElem *auxTag = tag;
-    tag             = tag->m_next;
-    delete auxTag;
-  }
-}
+ParsedPliImp::~ParsedPliImp() { clearTags(); }
 
 /*=====================================================================*/
 /*=====================================================================*/
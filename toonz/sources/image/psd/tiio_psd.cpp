@@ -76,16 +76,16 @@ void TLevelReaderPsd::load(TRasterImageP &rasP, int shrinkX, int shrinkY,
 }
 
 TLevelP TLevelReaderPsd::loadInfo() {
-  TPSDParser *psdparser = new TPSDParser(m_path);
+  TPSDParser psdparser(m_path);
   assert(m_layerId >= 0);
-  int framesCount = psdparser->getFramesCount(m_layerId);
+  int framesCount = psdparser.getFramesCount(m_layerId);
   TLevelP level;
-  level->setName(psdparser->getLevelName(m_layerId));
+  level->setName(psdparser.getLevelName(m_layerId));
   m_frameTable.clear();
   for (int i = 0; i < framesCount; i++) {
     TFrameId frame(i + 1);
     m_frameTable.insert(
-        std::make_pair(frame, psdparser->getFrameId(m_layerId, i)));
+        std::make_pair(frame, psdparser.getFrameId(m_layerId, i)));
     level->setFrame(frame, TImageP());
   }
   return level;
@@ -8,8 +8,12 @@
 #else
 #include <unistd.h>
 #endif
+#include <sys/stat.h>
 
 #include <memory>
+#include <functional>
+
+#include <QMutex>
 
 #include "tiio.h"
 #include "tpixel.h"
@@ -33,6 +37,85 @@ extern "C" {
 #include "windows.h"
 #endif
 
+//**************************************************************************
+//    Block reading  helpers
+//**************************************************************************
+
+namespace {
+
+/*
+  Blocks are decoded concurrently by separate TIFF handles, all reading the
+  same file descriptor through the procedures below. Each handle keeps its own
+  file offset, and the actual reads are serialized.
+*/
+
+struct TifSharedFile {
+  int m_fd;
+  toff_t m_size;
+  QMutex m_mutex;
+};
+
+struct TifClientFile {
+  TifSharedFile *m_file;
+  toff_t m_offset;
+};
+
+tmsize_t tifClientRead(thandle_t handle, void *buffer, tmsize_t size) {
+  TifClientFile *client = (TifClientFile *)handle;
+  QMutexLocker locker(&client->m_file->m_mutex);
+
+  int fd = client->m_file->m_fd;
+#ifdef _WIN32
+  if (_lseeki64(fd, client->m_offset, SEEK_SET) < 0) return -1;
+#else
+  if (lseek(fd, (off_t)client->m_offset, SEEK_SET) < 0) return -1;
+#endif
+
+  tmsize_t count = 0;
+  while (count < size) {
+#ifdef _WIN32
+    int n = _read(fd, (char *)buffer + count, (unsigned int)(size - count));
+#else
+    ssize_t n = read(fd, (char *)buffer + count, size - count);
+#endif
+    if (n <= 0) break;
+    count += n;
+  }
+
+  client->m_offset += count;
+  return count;
+}
+
+tmsize_t tifClientWrite(thandle_t, void *, tmsize_t) { return -1; }
+
+toff_t tifClientSeek(thandle_t handle, toff_t offset, int whence) {
+  TifClientFile *client = (TifClientFile *)handle;
+  switch (whence) {
+  case SEEK_SET:
+    client->m_offset = offset;
+    break;
+  case SEEK_CUR:
+    client->m_offset += offset;
+    break;
+  case SEEK_END:
+    client->m_offset = client->m_file->m_size + offset;
+    break;
+  }
+  return client->m_offset;
+}
+
+int tifClientClose(thandle_t) { return 0; }
+
+toff_t tifClientSize(thandle_t handle) {
+  return ((TifClientFile *)handle)->m_file->m_size;
+}
+
+int tifClientMap(thandle_t, void **, toff_t *) { return 0; }
+
+void tifClientUnmap(thandle_t, void *, toff_t) {}
+
+}  // namespace
+
 //**************************************************************************
 //    TifReader  implementation
 //**************************************************************************
@@ -50,6 +133,13 @@ class TifReader final : public Tiio::Reader {
   bool is16bitEnabled;
   bool m_isTzi;
   TRasterGR8P m_tmpRas;
+  std::unique_ptr<TifSharedFile> m_sharedFile;
+  int m_blockRows;
+
+  //! Decodes the strips of a block with a new TIFF handle, passing each
+  //! row (in reader row order) to copyRow.
+  bool readStrips(int blockIndex, bool is64,
+                  const std::function<void(int, const UCHAR *)> &copyRow);
 
 public:
   TifReader(bool isTzi);
@@ -66,6 +156,10 @@ public:
   int skipLines(int lineCount) override;
   void readLine(char *buffer, int x0, int x1, int shrink) override;
   void readLine(short *buffer, int x0, int x1, int shrink) override;
+
+  int getBlockRowCount() override;
+  bool readBlock(char *buffer, int wrap, int blockIndex) override;
+  bool readBlock(short *buffer, int wrap, int blockIndex) override;
 };
 
 //------------------------------------------------------------
@@ -82,7 +176,8 @@ TifReader::TifReader(bool isTzi)
     , m_rowOrder(Tiio::TOP2BOTTOM)
     , is16bitEnabled(true)
     , m_isTzi(isTzi)
-    , m_tmpRas(0) {
+    , m_tmpRas(0)
+    , m_blockRows(0) {
   TIFFSetWarningHandler(0);
 }
 
@@ -112,6 +207,13 @@ void TifReader::open(FILE *file) {
     throw(str);
   }
 
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == 0) {
+    m_sharedFile.reset(new TifSharedFile);
+    m_sharedFile->m_fd   = fd;
+    m_sharedFile->m_size = fileStat.st_size;
+  }
+
   uint32 w = 0, h = 0, rps = 0;
   uint16 bps = 0, spp = 0;
   uint32 tileWidth = 0, tileLength = 0;
@@ -664,6 +766,143 @@ void TifReader::readLine(char *buffer, int x0, int x1, int shrink) {
   m_row++;
 }
 
+//------------------------------------------------------------
+
+int TifReader::getBlockRowCount() {
+  // Toonz windows map rows differently - see readLine()
+  if (m_isTzi || !m_sharedFile || m_rowsPerStrip <= 0) return 0;
+
+  // Group strips in blocks of at least 64 rows, since each block requires
+  // its own TIFF handle
+  m_blockRows = m_rowsPerStrip * std::max(1, 64 / m_rowsPerStrip);
+  return m_blockRows;
+}
+
+//------------------------------------------------------------
+
+bool TifReader::readStrips(
+    int blockIndex, bool is64,
+    const std::function<void(int, const UCHAR *)> &copyRow) {
+  assert(m_blockRows > 0);
+
+  TifClientFile client = {m_sharedFile.get(), 0};
+  TIFF *tiff = TIFFClientOpen("", "rm", (thandle_t)&client, tifClientRead,
+                              tifClientWrite, tifClientSeek, tifClientClose,
+                              tifClientSize, tifClientMap, tifClientUnmap);
+  if (!tiff) return false;
+
+  uint16 orient = ORIENTATION_TOPLEFT;
+  TIFFGetField(tiff, TIFFTAG_ORIENTATION, &orient);
+
+  uint32 tileWidth = 0, tileHeight = 0;
+  bool tiled = TIFFIsTiled(tiff);
+  if (tiled) {
+    TIFFGetField(tiff, TIFFTAG_TILEWIDTH, &tileWidth);
+    TIFFGetField(tiff, TIFFTAG_TILELENGTH, &tileHeight);
+    assert(tileWidth > 0 && tileHeight > 0);
+  }
+
+  int pixelSize    = is64 ? 8 : 4;
+  int stripRowSize = m_rowLength * pixelSize;
+  std::vector<UCHAR> strip(m_rowsPerStrip * stripRowSize);
+  std::vector<UCHAR> tile(tileWidth * tileHeight * pixelSize);
+
+  int firstRow = blockIndex * m_blockRows;
+  int lastRow  = std::min(firstRow + m_blockRows, m_info.m_ly);
+
+  bool ok = true;
+  for (int y = firstRow; ok && y < lastRow; y += m_rowsPerStrip) {
+    // Retrieve the strip in the BOTTOM-UP orientation returned by TIFF
+    // functions, as readLine() does
+    if (tiled) {
+      int lastTy = std::min((int)tileHeight, m_info.m_ly - y);
+
+      for (int x = 0; ok && x < m_info.m_lx; x += tileWidth) {
+        ok = is64 ? TIFFReadRGBATile_64(tiff, x, y, (uint64 *)&tile[0])
+                  : TIFFReadRGBATile(tiff, x, y, (uint32 *)&tile[0]);
+
+        int tileRowSize = std::min((int)tileWidth, m_info.m_lx - x) * pixelSize;
+        for (int ty = 0; ty < lastTy; ++ty)
+          memcpy(&strip[(ty * m_rowLength + x) * pixelSize],
+                 &tile[ty * tileWidth * pixelSize], tileRowSize);
+      }
+    } else
+      ok = is64 ? TIFFReadRGBAStrip_64(tiff, y, (uint64 *)&strip[0])
+                : TIFFReadRGBAStrip(tiff, y, (uint32 *)&strip[0]);
+
+    if (!ok) break;
+
+    int stripRows = std::min(m_rowsPerStrip, m_info.m_ly - y);
+    for (int k = 0; k < stripRows; ++k) {
+      int r = m_rowsPerStrip - 1 - k;
+      switch (orient) {
+      case ORIENTATION_TOPLEFT:
+      case ORIENTATION_TOPRIGHT:
+      case ORIENTATION_LEFTTOP:
+      case ORIENTATION_RIGHTTOP:
+        r = stripRows - 1 - k;
+        break;
+
+      case ORIENTATION_BOTRIGHT:
+      case ORIENTATION_BOTLEFT:
+      case ORIENTATION_RIGHTBOT:
+      case ORIENTATION_LEFTBOT:
+        r = k;
+        break;
+      }
+
+      copyRow(y + k - firstRow, &strip[r * stripRowSize]);
+    }
+  }
+
+  TIFFClose(tiff);
+  return ok;
+}
+
+//------------------------------------------------------------
+
+bool TifReader::readBlock(char *buffer, int wrap, int blockIndex) {
+  int lx    = m_info.m_lx;
+  bool is64 = (m_info.m_bitsPerSample == 16 && m_info.m_samplePerPixel >= 3);
+
+  return readStrips(blockIndex, is64, [&](int row, const UCHAR *stripRow) {
+    TPixel32 *pix = (TPixel32 *)buffer + row * wrap, *endPix = pix + lx;
+
+    if (is64) {
+      const USHORT *v = (const USHORT *)stripRow;
+      for (; pix < endPix; ++pix, v += 4)
+        *pix = PixelConverter<TPixel32>::from(TPixel64(v[0], v[1], v[2], v[3]));
+    } else {
+      const uint32 *v = (const uint32 *)stripRow;
+      for (; pix < endPix; ++pix, ++v) {
+        uint32 c = *v;
+        pix->r   = (UCHAR)TIFFGetR(c);
+        pix->g   = (UCHAR)TIFFGetG(c);
+        pix->b   = (UCHAR)TIFFGetB(c);
+        pix->m   = (UCHAR)TIFFGetA(c);
+      }
+    }
+  });
+}
+
+//------------------------------------------------------------
+
+bool TifReader::readBlock(short *buffer, int wrap, int blockIndex) {
+  int lx = m_info.m_lx;
+
+  return readStrips(blockIndex, true, [&](int row, const UCHAR *stripRow) {
+    TPixel64 *pix = (TPixel64 *)buffer + row * wrap, *endPix = pix + lx;
+
+    const USHORT *v = (const USHORT *)stripRow;
+    for (; pix < endPix; ++pix, v += 4) {
+      pix->r = v[0];
+      pix->g = v[1];
+      pix->b = v[2];
+      pix->m = v[3];
+    }
+  });
+}
+
 //============================================================
 
 Tiio::TifWriterProperties::TifWriterProperties()
@@ -87,6 +87,9 @@ the deformed mesh vertices positions.
 \note In case the compilation step failed or was never invoked, this function
 will silently return the original, undeformed mesh vertices.
 
+\note Compiled data is only read by this function, which can therefore be
+invoked concurrently on the same compiled deformer.
+
 \warning Requires previous compile() invocation.
 */
   void deform(const TPointD *dstHandlePos, double *dstVerticesCoords) const;
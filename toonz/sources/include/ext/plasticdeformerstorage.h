@@ -36,7 +36,9 @@ class PlasticSkeletonDeformation;
 //! PlasticDeformerData contains all the data needed to perform the deformation
 //! of a single mesh.
 struct DVAPI PlasticDeformerData {
-  PlasticDeformer m_deformer;  //!< The mesh deformer itself
+  std::shared_ptr<PlasticDeformer>
+      m_deformer;  //!< The mesh deformer itself. Compiled deformers are
+                   //!< shared among groups using the same mesh and handles.
 
   std::unique_ptr<double[]> m_so;      //!< (owned) Faces' stacking order
   std::unique_ptr<double[]> m_output;  //!< (owned) Output vertex coordinates
@@ -227,6 +229,9 @@ caching issues.
 cached counterpart,
     in case the same deformation is repeatedly invoked.
     It is meant to be used only in absence of user interaction.
+    Compiled deformers are still looked up in (and added to) the storage's
+    compiled deformers cache, so that rendering multiple frames of the same
+    mesh and skeleton compiles them just once.
 
 \warning The returned pointer is owned by the \b caller, and must be manually
 deleted
@@ -17,6 +17,9 @@ class Chunkinfo;
 
 #include "tcommon.h"
 #include "tthreadmessage.h"
+
+#include <vector>
+
 class TRaster;
 
 class DVAPI TBigMemoryManager {
@@ -32,12 +35,36 @@ class DVAPI TBigMemoryManager {
   void checkConsistency();
   UCHAR *remap(TUINT32 RequestedSize);
   void printLog(TUINT32 size);
+  bool releaseUnmanagedRaster(TRaster *ras, UCHAR *buffer);
+
+public:
+  //! Usage statistics of a size class of pooled raster buffers.
+  struct PoolStats {
+    TUINT32 m_bufferSize;  //!< Size of the class buffers, in bytes
+    int m_allocCount;      //!< Buffers requested in the class
+    int m_reuseCount;      //!< Requests served by a pooled buffer
+    int m_pooledCount;     //!< Buffers currently waiting in the pools
+  };
+
+  //! Counters of a thread's allocations, charged by each pooled buffer until
+  //! it is released - by whichever thread.
+  struct RasterAccount;
+
+  //! Raster buffers allocated by a thread since its last
+  //! resetThreadRasterStats() call.
+  struct ThreadStats {
+    TINT64 m_peakSize;   //!< Peak of the bytes allocated and not released
+    TINT64 m_allocSize;  //!< Bytes allocated
+    TINT64 m_reuseSize;  //!< Bytes served by pooled buffers
+    int m_allocCount;    //!< Buffers allocated
+    int m_reuseCount;    //!< Buffers served from the pools
+  };
 
 public:
   TBigMemoryManager();
   ~TBigMemoryManager();
   bool init(TUINT32 sizeinKb);
-  bool putRaster(TRaster *ras, bool canPutOnDisk = true);
+  bool putRaster(TRaster *ras, bool canPutOnDisk = true, bool clear = true);
   bool releaseRaster(TRaster *ras);
   void lock(UCHAR *buffer);
   void unlock(UCHAR *buffer);
@@ -61,6 +88,25 @@ public:
 
   void setRunOutOfContiguousMemoryHandler(void (*callback)(unsigned long size));
 
+  /*!
+    When inactive, the manager recycles the buffers of released rasters in
+    thread-local pools, one per size class. The capacity bounds the buffers
+    pooled by all the threads together (256MB by default); 0 disables
+    pooling.
+  */
+  void setRasterPoolCapacity(TUINT32 sizeInKb);
+  void enableHugePages(bool on);  //!< Backs large buffers with huge pages
+  void trimRasterPool();          //!< Frees all the pooled buffers
+  void getRasterPoolStats(std::vector<PoolStats> &stats);
+
+  //! Bytes of the raster buffers in use or waiting in the pools.
+  TINT64 getRasterMemoryUsage() const;
+  //! Bytes of the raster buffers in use only.
+  TINT64 getUsedRasterMemory() const;
+
+  void resetThreadRasterStats();
+  void getThreadRasterStats(ThreadStats &stats);
+
 private:
   friend class TRaster;
   void (*m_runOutCallback)(unsigned long);
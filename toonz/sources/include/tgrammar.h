@@ -31,6 +31,7 @@ class TUnit;
 namespace TSyntax {
 class Token;
 class Calculator;
+class CalculatorProgram;
 }  // namespace TSyntax
 
 //==============================================
@@ -61,6 +62,11 @@ public:
   enum { T, FRAME, RFRAME };
   virtual double compute(double vars[3]) const = 0;
 
+  //! Appends the instructions computing the node to \b program, and returns
+  //! the register holding the result. By default the node's compute() is
+  //! called as a single instruction.
+  virtual int compile(CalculatorProgram &program) const;
+
   virtual void accept(CalculatorNodeVisitor &visitor) = 0;
 
   virtual bool hasReference() const { return false; }
@@ -75,6 +81,8 @@ private:
 
 class DVAPI Calculator {
   CalculatorNode *m_rootNode;  //!< (owned) Root calculator node
+  std::unique_ptr<CalculatorProgram>
+      m_program;  //!< The root node compiled to a flat register program
 
   TDoubleParam *m_param;  //!< (not owned) Owner of the calculator object
   const TUnit *m_unit;    //!< (not owned)
@@ -85,11 +93,7 @@ public:
 
   void setRootNode(CalculatorNode *node);
 
-  double compute(double t, double frame, double rframe) {
-    double vars[3];
-    vars[0] = t, vars[1] = frame, vars[2] = rframe;
-    return m_rootNode->compute(vars);
-  }
+  double compute(double t, double frame, double rframe);
 
   void accept(CalculatorNodeVisitor &visitor) { m_rootNode->accept(visitor); }
 
@@ -117,6 +121,7 @@ public:
       : CalculatorNode(calc), m_value(value) {}
 
   double compute(double vars[3]) const override { return m_value; }
+  int compile(CalculatorProgram &program) const override;
 
   void accept(CalculatorNodeVisitor &visitor) override {}
 };
@@ -131,6 +136,7 @@ public:
       : CalculatorNode(calc), m_varIdx(varIdx) {}
 
   double compute(double vars[3]) const override { return vars[m_varIdx]; }
+  int compile(CalculatorProgram &program) const override;
 
   void accept(CalculatorNodeVisitor &visitor) override {}
 };
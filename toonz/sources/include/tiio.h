@@ -60,6 +60,27 @@ public:
   // If not implemented returns 0;
   virtual int skipLines(int lineCount) = 0;
 
+  // Block reading, for formats storing their images in blocks of rows that
+  // can be decoded independently (eg tif strips, exr chunks). Blocks are
+  // read concurrently by multiple threads, in place of readLine().
+  // Returns the rows count of each block, or 0 if unsupported.
+  // It's invoked once, before any readBlock().
+  virtual int getBlockRowCount() { return 0; }
+
+  // Reads the full-width rows of the specified block, in getRowOrder()
+  // order. The first row is stored at buffer, and the following ones
+  // 'wrap' pixels apart (wrap may be negative). Must be thread-safe.
+  // Returns false on failure - the image is then read by lines.
+  virtual bool readBlock(char *buffer, int wrap, int blockIndex) {
+    return false;
+  }
+  virtual bool readBlock(short *buffer, int wrap, int blockIndex) {
+    return false;
+  }
+  virtual bool readBlock(float *buffer, int wrap, int blockIndex) {
+    return false;
+  }
+
   virtual RowOrder getRowOrder() const { return BOTTOM2TOP; }
   virtual bool read16BitIsEnabled() const { return false; }
 
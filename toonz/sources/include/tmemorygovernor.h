@@ -0,0 +1,114 @@
+#pragma once
+
+#ifndef TMEMORYGOVERNOR_INCLUDED
+#define TMEMORYGOVERNOR_INCLUDED
+
+#include "tcommon.h"
+#include "tthreadmessage.h"
+
+#include <atomic>
+#include <vector>
+
+#undef DVAPI
+#undef DVVAR
+#ifdef TNZCORE_EXPORTS
+#define DVAPI DV_EXPORT_API
+#define DVVAR DV_EXPORT_VAR
+#else
+#define DVAPI DV_IMPORT_API
+#define DVVAR DV_IMPORT_VAR
+#endif
+
+//===============================================================
+
+/*!
+  A TMemoryConsumer holds memory that it can give back on request of the
+  TMemoryGovernor - idle buffers, caches of recomputable results, images
+  that can be compressed.
+
+  releaseMemory() is called by TMemoryGovernor::enforce(), outside of any
+  cache lock, so consumers may take their own locks.
+*/
+class DVAPI TMemoryConsumer {
+public:
+  //! Consumers are asked to release memory in increasing rank order.
+  enum Rank {
+    IDLE_MEMORY,   //!< Allocated memory that nothing uses
+    RECOMPUTABLE,  //!< Results that can be rendered again
+    COMPRESSIBLE   //!< Data that can be compressed or moved to disk
+  };
+
+public:
+  virtual ~TMemoryConsumer() {}
+
+  //! Releases about \b size bytes, or as much as possible if less.
+  virtual void releaseMemory(TINT64 size) = 0;
+};
+
+//===============================================================
+
+/*!
+  The TMemoryGovernor keeps the memory of the process within a budget.
+
+  Raster buffers hold almost all the memory of a render - the images in
+  TImageCache, the fx cache tiles (which are stored in TImageCache) and the
+  intermediate tiles all come from TBigMemoryManager - so the governor
+  measures the buffers in use or pooled there, which is a lock-free read.
+
+  When the usage exceeds the budget, enforce() brings it back to 90% of the
+  budget by releasing the raster pools and then asking the registered
+  consumers by rank. Renderers also scale the number of their concurrent
+  frames by the load through getAdmittedThreads(), since each frame
+  allocates its own tiles.
+
+  The budget is 0 by default, which disables the governor.
+*/
+class DVAPI TMemoryGovernor {
+  struct ConsumerData {
+    TMemoryConsumer *m_consumer;
+    int m_rank;
+  };
+
+  TThread::Mutex m_mutex;
+  std::vector<ConsumerData> m_consumers;  // Sorted by rank
+  std::atomic<TINT64> m_budget;           // In bytes
+
+  TMemoryGovernor();
+
+public:
+  static TMemoryGovernor *instance();
+
+  void setBudget(TINT64 sizeInKb);  //!< 0 disables the governor
+  TINT64 getBudget() const;         //!< In KB
+
+  void addConsumer(TMemoryConsumer *consumer, int rank);
+  void removeConsumer(TMemoryConsumer *consumer);
+
+  //! Bytes of the raster buffers in use or pooled.
+  TINT64 getMemoryUsage() const;
+  //! Bytes of the raster buffers in use, which only the consumers can
+  //! release.
+  TINT64 getUsedMemory() const;
+  bool isOverBudget() const;
+
+  /*!
+    Releases memory until the usage fits 90% of the budget. It must not be
+    called with locks of the consumers held, e.g. from inside the image
+    cache. Consumers only check the budget when asked to release memory.
+  */
+  void enforce();
+
+  /*!
+    Returns how many of \b threadsCount concurrent render threads should
+    run: all of them up to 75% of the budget, down to a single one when the
+    budget is full.
+  */
+  int getAdmittedThreads(int threadsCount) const;
+
+private:
+  // Not copyable
+  TMemoryGovernor(const TMemoryGovernor &);
+  TMemoryGovernor &operator=(const TMemoryGovernor &);
+};
+
+#endif  // TMEMORYGOVERNOR_INCLUDED
@@ -520,7 +520,7 @@ class FillToolOptionsBox final : public ToolOptionsBox {
   ToolOptionCombo *m_colorMode, *m_toolType;
   ToolOptionCheckbox *m_emptyOnly, *m_segmentMode, *m_onionMode,
       *m_multiFrameMode, *m_autopaintMode,*m_referFill, * m_closeGap,
-      *m_extendFill;
+      *m_extendFill, *m_regionMap;
   ToolOptionPairSlider *m_fillDepthField;
   ToolOptionIntSlider* m_gapCloseDistance;
 
@@ -14,6 +14,9 @@
 #endif
 
 #include <set>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "ttilesaver.h"
 #include "timage.h"
 #include "tpalette.h"
@@ -45,6 +48,7 @@ public:
   bool m_defRegionWithPaint;
   bool m_usePrevailingReferFill;
   bool m_extendFill;
+  bool m_useRegionMap;  // Fill through the cached FillRegionMap if possible
 
   FillParameters()
       : m_styleId(0)
@@ -58,6 +62,7 @@ public:
       , m_palette(0)
       , m_prevailing(true)
       , m_extendFill(false)
+      , m_useRegionMap(false)
       , m_defRegionWithPaint(true)
       , m_usePrevailingReferFill(false) {
     m_defRegionWithPaint     = DEF_REGION_WITH_PAINT;
@@ -75,6 +80,7 @@ public:
       , m_palette(params.m_palette)
       , m_prevailing(params.m_prevailing)
       , m_extendFill(params.m_extendFill)
+      , m_useRegionMap(params.m_useRegionMap)
       , m_defRegionWithPaint(params.m_defRegionWithPaint)
       , m_usePrevailingReferFill(params.m_usePrevailingReferFill) {}
 };
@@ -114,6 +120,81 @@ void DVAPI fullColorFill(const TRaster32P &ras, const FillParameters &params,
 void DVAPI fillHoles(const TRasterCM32P &ras, const int size,
                      TTileSaverCM32 *saver = nullptr);
 
+//=============================================================================
+//! The class FillRegionMap stores the connected paint regions of a Toonz
+//! raster, so that repeated fills on the same frame become a relabel.
+/*!A region is a 4-connected set of pure paint pixels sharing the same paint.
+   The map is built in a single pass over the raster and stored as
+   run-length spans. fill() repaints the clicked region span by span and then
+   runs the usual flood fill only along its border, where lines and
+   antialiased pixels need the fillRow() rules.
+\n Only the plain case is handled: no reference image, no shift fill, no
+   extend fill and regions defined by paint. fill() returns false in any
+   other case, or if the clicked pixel is not pure paint, and the caller
+   must fall back to ::fill().
+\n The map is updated in place after a fill. If the flood reaches pixels
+   outside the known region the map becomes invalid (isValid() returns
+   false) and must be rebuilt.
+*/
+//=============================================================================
+
+class DVAPI FillRegionMap {
+  struct Span {
+    int m_x0, m_x1;
+    int m_region;
+  };
+
+  struct Region {
+    int m_paint;
+    int m_parent;
+    TRect m_bbox;
+    std::vector<int> m_neighbours;  //!< Regions touching this one directly
+  };
+
+  TDimension m_size;
+  std::vector<std::vector<Span>> m_rows;
+  std::vector<Region> m_regions;
+  bool m_valid;
+  std::mutex m_mutex;
+
+public:
+  FillRegionMap(const TRasterCM32P &ras);
+
+  const TDimension &getSize() const { return m_size; }
+  bool isValid() const { return m_valid; }
+  int getRegionCount() const { return (int)m_regions.size(); }
+
+  //! Returns the region containing \b p, or -1 if \b p is not pure paint.
+  int getRegion(const TPoint &p);
+
+  //! Returns true if the fill was handled (even if nothing was painted).
+  bool fill(const TRasterCM32P &ras, const FillParameters &params,
+            TTileSaverCM32 *saver = 0);
+
+  // Cache management functions
+  static std::shared_ptr<FillRegionMap> getMap(const std::string &id,
+                                               const TRasterCM32P &ras);
+  static void setMap(const std::string &id,
+                     const std::shared_ptr<FillRegionMap> &map);
+  static void invalidate(const std::string &id);
+  static void clear();
+
+private:
+  int regionAt(const TPoint &p);
+  int findRoot(int region);
+  void mergeRegions(int root, int paint);
+  void getBorderRanges(int root, int xa, int xb, int y,
+                       std::vector<std::pair<int, int>> &ranges);
+
+  static std::unordered_map<std::string, std::shared_ptr<FillRegionMap>>
+      m_cache;
+  static std::mutex m_cacheMutex;
+
+  // not implemented
+  FillRegionMap(const FillRegionMap &);
+  FillRegionMap &operator=(const FillRegionMap &);
+};
+
 //=============================================================================
 //! The class AreaFiller allows to fill a raster area, delimited by rect or
 //! spline.
@@ -67,13 +67,17 @@ enum BSFX_Transforms_Enum {
             All the other parameters are turned to default or taken by current
   settings if not
             specified by the user.
+
+            Fxs passing their input through unchanged (see
+  TRasterFx::isIdentity()) are left out of the render-tree, unless
+  skipIdentityFxs is false - eg to debug a render against the schematic.
 */
 
 DVAPI TFxP buildSceneFx(ToonzScene *scene, double frame, TXsheet *xsh = 0,
                         const TFxP &root                = TFxP(),
                         BSFX_Transforms_Enum transforms = BSFX_DEFAULT_TR,
                         bool isPreview = false, int whichLevels = -1,
-                        int shrink = 1);
+                        int shrink = 1, bool skipIdentityFxs = true);
 
 // temo non debba andare qui
 // in ogni caso gestisce anche lo zdepth
@@ -7,6 +7,7 @@
 #include "tvectorimage.h"
 #include <deque>
 #include <list>
+#include <atomic>
 
 #include <QObject>
 
@@ -37,13 +38,14 @@ user cancels.
 class DVAPI VectorizerCore final : public QObject {
   Q_OBJECT
 
-  int m_currPartial;
+  std::atomic<int> m_currPartial;
   int m_totalPartials;
+  int m_maxThreadsCount;
 
   bool m_isCanceled;
 
 public:
-  VectorizerCore() : m_currPartial(0), m_isCanceled(false) {}
+  VectorizerCore();
   ~VectorizerCore() {}
 
   /*!Calls the appropriate technique to convert \b image to vectors depending on
@@ -58,6 +60,14 @@ Returns the \b TVectorImageP converted image.*/
   //! Returns true if vectorization was aborted at user's request
   bool isCanceled() { return m_isCanceled; }
 
+  //! Sets the maximum number of threads used to vectorize a single image.
+  //! Independent parts of the image (eg centerline contour families) are
+  //! processed concurrently - with identical results. Defaults to the ideal
+  //! threads count; callers vectorizing multiple images concurrently should
+  //! lower it.
+  void setMaxThreadsCount(int count) { m_maxThreadsCount = count; }
+  int getMaxThreadsCount() const { return m_maxThreadsCount; }
+
   //!\b (\b Internal \b use \b only) Sets the maximum number of partial
   //! notifications.
   void setOverallPartials(int total) { m_totalPartials = total; }
@@ -20,6 +20,10 @@
 
 // Qt includes
 #include <QStack>
+#include <QMutex>
+
+// STD includes
+#include <map>
 
 #undef DVAPI
 #undef DVVAR
@@ -356,6 +360,13 @@ with the frame.
   bool getKeyframeSpan(int row, int &r0, double &ease0, int &r1,
                        double &ease1) const;
 
+  /*!
+Returns the absolute placement of the object at frame \b t.
+\n Placements of objects whose whole parent chain depends only on their own
+curves are stored in a per-frame table, so that later requests for the same
+frame (from any thread) do not walk the parent chain again. The table is
+cleared by invalidate().
+*/
   TAffine getPlacement(double t);
   TAffine getParentPlacement(double t) const;
 
@@ -442,7 +453,7 @@ Doesn't delete \e this.
   void attachChildrenToParent(const TStageObjectId &parentId);
 
   //! Resets the area position setting internal time of the object and of all
-  //! his children to -1.
+  //! his children to -1, and clears their placement tables.
   void invalidate();
 
   /*!
@@ -520,6 +531,10 @@ private:
   TAffine m_localPlacement;
   TAffine m_absPlacement;
 
+  std::map<double, TAffine> m_placementTable;  //!< Placements by frame
+  QMutex m_placementTableMutex;
+  int m_placementCacheable;  //!< -1 = unknown, see isPlacementCacheable()
+
   TStageObjectSpline *m_spline;
   Status m_status;
 
@@ -559,6 +574,7 @@ private:
 
   TPointD getHandlePos(std::string handle, int row) const;
   TAffine computeLocalPlacement(double frame);
+  TAffine computePlacement(double t);
   TStageObject *findRoot(double frame) const;
   TStageObject *getPinnedDescendant(int frame);
 
@@ -573,6 +589,12 @@ private:
   void invalidate(LazyData &ld) const;
   void updateKeyframes(LazyData &ld) const;
 
+  // Placement table-related functions
+
+  bool isPlacementCacheable();
+  void clearPlacementTable();
+  void invalidateTime();
+
   void onChange(const class TParamChange &c) override;
 };
 
@@ -22,8 +22,8 @@ public:
   // appena costruisce l'oggetto. Poi potremmo dare la scelta,
   // anche per decidere se farlo subito o meno.
   class DVAPI Tile {
-    TDimension m_dim;
-    int m_pixelSize;
+  protected:
+    int m_size;
 
   public:
     TRect m_rasterBounds;
@@ -35,8 +35,13 @@ public:
 
     virtual Tile *clone() const = 0;
 
-    // expressed in byte
-    int getSize() { return m_dim.lx * m_dim.ly * m_pixelSize; }
+    // expressed in byte. Tiles are stored compressed in the image cache:
+    // this is the size of their compressed data, which still counts when
+    // the cache moves them to disk.
+    int getSize() const { return m_size; }
+
+    // Compresses the tile in the image cache and records its size there.
+    void compress();
 
   private:
     Tile(const Tile &tile);
@@ -11,6 +11,8 @@
 #include <QList>
 #include <QTimer>
 
+#include <memory>
+
 #undef DVAPI
 #undef DVVAR
 #ifdef TOONZLIB_EXPORTS
@@ -110,6 +112,9 @@ class DVAPI TXshSoundColumn final : public QObject, public TXshCellColumn {
 
   QTimer m_timer;
 
+  class MixdownCache;
+  std::unique_ptr<MixdownCache> m_mixdownCache;
+
 public:
   TXshSoundColumn();
   ~TXshSoundColumn();
@@ -3,6 +3,10 @@
 #ifndef TPASSIVECACHEMANAGER_INCLUDED
 #define TPASSIVECACHEMANAGER_INCLUDED
 
+// TnzCore includes
+#include "tmemorygovernor.h"
+
+// TnzBase includes
 #include "tfxcachemanager.h"
 
 //=========================================================================
@@ -33,7 +37,8 @@ under control of another manager class - namely, the TFxCacheManager - for
 single render instances.
 */
 
-class DVAPI TPassiveCacheManager final : public TFxCacheManagerDelegate {
+class DVAPI TPassiveCacheManager final : public TFxCacheManagerDelegate,
+                                          public TMemoryConsumer {
   T_RENDER_RESOURCE_MANAGER
 
 private:
@@ -63,6 +68,7 @@ private:
   ResourcesContainer *m_resources;
   std::map<std::string, UCHAR> m_contextNames;
   std::map<unsigned long, std::string> m_contextNamesByRenderId;
+  std::map<unsigned long, double> m_branchCacheFrames;
 
   bool m_updatingPassiveCacheIds;
   int m_currentPassiveCacheId;
@@ -78,6 +84,15 @@ public:
   void setContextName(unsigned long renderId, const std::string &name);
   void releaseContextNamesWithPrefix(const std::string &prefix);
 
+  /*!
+Makes the specified render instance keep the results of all its fx nodes at
+the passed frame, in the instance's rendering context. Results are stored by
+alias, which describes the node's parameters at the frame and its input
+subtree: the next render of the context recomputes only the nodes whose alias
+changed - that is, changed nodes and their downstream consumers.
+*/
+  void enableBranchCache(unsigned long renderId, double frame);
+
   TFx *getNotAllowingAncestor(TFx *fx);
 
   void setEnabled(bool enabled);
@@ -112,6 +127,8 @@ public:
 
   void onRenderStatusEnd(int renderStatus) override;
 
+  void releaseMemory(TINT64 size) override;
+
   bool renderHasOwnership() override { return false; }
 
 public:
@@ -131,6 +148,7 @@ private:
   int updatePassiveCacheId(int id);
 
   std::string getContextName();
+  bool isBranchCached(double frame);
   void releaseOldResources();
 };
 
@@ -0,0 +1,116 @@
+#pragma once
+
+#ifndef TPROFILER_INCLUDED
+#define TPROFILER_INCLUDED
+
+#include "tcommon.h"
+
+#include <string>
+
+#undef DVAPI
+#undef DVVAR
+#ifdef TNZCORE_EXPORTS
+#define DVAPI DV_EXPORT_API
+#define DVVAR DV_EXPORT_VAR
+#else
+#define DVAPI DV_IMPORT_API
+#define DVVAR DV_IMPORT_VAR
+#endif
+
+class TFilePath;
+
+//===============================================================
+
+/*!
+  The TProfiler class records the activity of render processes between a
+  start() and a stop() call: timed spans (an fx computation, a level read),
+  instant events (a cache hit or miss) and counters (allocated raster
+  memory).
+
+  The recording can be exported in the Chrome trace event format, which is
+  read by chrome://tracing and Perfetto. Spans nest by thread, so the fx
+  tree of a frame shows up as a flame graph.
+
+  When not recording, every call returns after an atomic flag check. The
+  events of a recording take 256MB at most; later ones are dropped, and
+  their count is exported. Events should identify long names, like the
+  aliases of fx subtrees, by their digest().
+*/
+class DVAPI TProfiler {
+  class Imp;
+  Imp *m_imp;
+
+  TProfiler();
+  ~TProfiler();
+
+public:
+  static TProfiler *instance();
+
+  //! Returns whether the profiler is recording.
+  static bool isActive();
+
+  //! Discards any previous recording and starts recording.
+  void start();
+  void stop();
+
+  //! Time elapsed since start(), in microseconds.
+  TINT64 now() const;
+
+  /*!
+    Adds an event to the recording. \b args is the content of the JSON
+    object shown with the event, e.g. "\"lx\":640,\"ly\":480"; it can be
+    empty.
+  */
+  void addSpan(const char *category, const std::string &name,
+               const std::string &args, TINT64 start, TINT64 end);
+  void addInstant(const char *category, const std::string &name,
+                  const std::string &args = "");
+
+  //! Adds \b delta to the named counter, and records its new value.
+  void count(const char *name, TINT64 delta);
+  //! Records the value of the named counter, for quantities that exist
+  //! before start() - e.g. the memory in use.
+  void setCounter(const char *name, TINT64 value);
+
+  bool exportChromeTrace(const TFilePath &fp) const;
+
+  //! Builds an \b args entry, e.g. arg("lx", 640) + "," + arg("id", id).
+  static std::string arg(const char *key, TINT64 value);
+  static std::string arg(const char *key, const std::string &value);
+
+  //! Returns a short identifier of \b str, as 16 hex digits.
+  static std::string digest(const std::string &str);
+};
+
+//===============================================================
+
+/*!
+  TProfileSpan records the span between its begin() and its destruction,
+  if the profiler is recording when begin() is called. Callers should
+  build the event name only when TProfiler::isActive():
+
+  \code
+  TProfileSpan span;
+  if (TProfiler::isActive()) span.begin("fx", fx->getFxType());
+  \endcode
+*/
+class DVAPI TProfileSpan {
+  const char *m_category;
+  std::string m_name, m_args;
+  TINT64 m_start;
+
+public:
+  TProfileSpan() : m_category(0), m_start(0) {}
+  ~TProfileSpan() { end(); }
+
+  void begin(const char *category, const std::string &name,
+             const std::string &args = "");
+  void end();
+
+private:
+  // Not copyable
+  TProfileSpan(const TProfileSpan &);
+  TProfileSpan &operator=(const TProfileSpan &);
+};
+
+#endif  // TPROFILER_INCLUDED
@@ -85,13 +85,17 @@ protected:
   TRaster *m_parent;  // nel caso di sotto-raster
   UCHAR *m_buffer;
   bool m_bufferOwner;
+  // set when the buffer comes from TBigMemoryManager's pools
+  TBigMemoryManager::RasterAccount *m_bufferAccount;
   // i costruttori sono qui per centralizzare la gestione della memoria
   // e' comunque impossibile fare new TRaster perche' e' una classe astratta
   // (clone, extract)
   bool m_isLinear;  // linear color space
 
   // crea il buffer associato (NON fa addRef())
-  TRaster(int lx, int ly, int pixelSize);
+  // The buffer is left uninitialized if clear is false: use it only when
+  // every pixel is going to be overwritten.
+  TRaster(int lx, int ly, int pixelSize, bool clear = true);
 
   // si attacca ad un buffer pre-esistente (NON fa addRef() - neanche a parent)
   TRaster(int lx, int ly, int pixelSize, int wrap, UCHAR *buffer,
@@ -284,7 +288,8 @@ protected:
   // Users must adopt the TRasterPT smart pointer syntax instead.
 
   // Buffer Allocation
-  TRasterT(int lx, int ly) : TRaster(lx, ly, sizeof(T)) {}
+  TRasterT(int lx, int ly, bool clear = true)
+      : TRaster(lx, ly, sizeof(T), clear) {}
 
   // Buffer Attachment
   TRasterT(int lx, int ly, int wrap, T *buffer, TRasterT<T> *parent,
@@ -314,7 +319,7 @@ public:
   // Derived rasters creation
 
   TRasterP clone() const override {
-    TRasterP dst = TRasterPT<T>(m_lx, m_ly);
+    TRasterP dst(new TRasterT<T>(m_lx, m_ly, false));
     TRasterP src(const_cast<TRaster *>((const TRaster *)this));
     dst->copy(src);
     return dst;
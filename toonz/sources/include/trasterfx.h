@@ -293,6 +293,25 @@ public:
   virtual void dryCompute(TRectD &rect, double frame,
                           const TRenderSettings &info);
 
+  //! Declares the temporal footprint of the fx, ie the frames at which the
+  //! specified input port is computed to render the passed frame. Returns
+  //! false if the port is computed at the rendered frame only (default).
+  //! Renders of multiple frames share the input frames declared this way,
+  //! computing each of them once. \sa TRasterFx::doDryCompute().
+  virtual bool getTemporalFootprint(double frame, int port,
+                                    std::vector<double> &inputFrames) {
+    return false;
+  }
+
+  //! Returns whether the fxs tree rooted at this fx has fxs with a temporal
+  //! footprint at the specified frame.
+  bool hasTemporalFootprint(double frame);
+
+  //! Returns whether the fx outputs its preferred input port unchanged at
+  //! any frame and under any render settings. Render-trees built by
+  //! buildSceneFx() skip such fxs, unless explicitly requested otherwise.
+  virtual bool isIdentity() const { return false; }
+
   virtual int getMemoryRequirement(const TRectD &rect, double frame,
                                    const TRenderSettings &info);
 
@@ -13,11 +13,23 @@ public:
 
   TRectD m_bbox;
 
-  TRegionOutline() : m_doAntialiasing(false) {}
+  //! Cached triangulation of the boundaries (3 consecutive vertices per
+  //! triangle). It is built lazily by the tessellator and must be invalidated
+  //! whenever the boundaries are changed.
+  std::vector<TPointD> m_triangles;
+  bool m_trianglesValid;
+
+  TRegionOutline() : m_doAntialiasing(false), m_trianglesValid(false) {}
 
   void clear() {
     m_exterior.clear();
     m_interior.clear();
+    invalidateTriangles();
+  }
+
+  void invalidateTriangles() {
+    m_triangles.clear();
+    m_trianglesValid = false;
   }
 };
 
@@ -4,6 +4,7 @@
 #define TRENDERER_INCLUDED
 
 #include "trasterfx.h"
+#include "tbigmemorymanager.h"
 
 #undef DVAPI
 #undef DVVAR
@@ -98,8 +99,14 @@ struct TRenderPort::RenderData {
   unsigned long m_taskId;  //!< Task identifier in the rendering session. Starts
                            //! at 0, preserves
   //!< the original submission order except for cluster equivalence.
-
-  RenderData() : m_renderId((unsigned long)-1), m_taskId((unsigned long)-1) {}
+  TBigMemoryManager::ThreadStats m_rasterStats;  //!< Rasters allocated to
+                                                 //! render the output, and
+  //!< how many of them were recycled. Filled on completion only.
+
+  RenderData()
+      : m_renderId((unsigned long)-1)
+      , m_taskId((unsigned long)-1)
+      , m_rasterStats() {}
   RenderData(const std::vector<double> &frames, const TRenderSettings &info,
              const TRasterP &rasA, const TRasterP &rasB, unsigned long renderId,
              unsigned long taskId)
@@ -108,7 +115,8 @@ struct TRenderPort::RenderData {
       , m_rasA(rasA)
       , m_rasB(rasB)
       , m_renderId(renderId)
-      , m_taskId(taskId) {}
+      , m_taskId(taskId)
+      , m_rasterStats() {}
 };
 
 //=================================================================================
@@ -186,6 +194,8 @@ public:
     TRenderSettings m_info;
     TFxPair m_fxRoot;  // The second of pair is used for field interlacing or
                        // stereoscopic render.
+    TRectD m_renderArea;  // Overrides the ports' render area, unless empty.
+                          // Only the first RenderData's one is considered.
 
     RenderData(double frame, const TRenderSettings &info, const TFxPair &fxRoot)
         : m_frame(frame), m_info(info), m_fxRoot(fxRoot) {}
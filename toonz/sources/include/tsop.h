@@ -82,6 +82,13 @@ DVAPI TSoundTrackP timeStretch(TSoundTrackP src, double ratio);
 DVAPI TSoundTrackP mix(const TSoundTrackP &st1, const TSoundTrackP &st2,
                        double a1, double a2);
 
+/*!
+    As mix(), but the result is accumulated into st1 when st1 is not shorter
+    than st2 - then st1 is returned, and no soundtrack is allocated.
+  */
+DVAPI TSoundTrackP mixInPlace(const TSoundTrackP &st1, const TSoundTrackP &st2,
+                              double a1, double a2);
+
 /*!
     Inserts l blank samples starting from the sample s0 of the soundtrack.
   */
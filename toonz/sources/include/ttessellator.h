@@ -30,6 +30,12 @@ class DVAPI TTessellator {
 public:
   virtual ~TTessellator() {}
 
+  //! Builds the triangle mesh of the specified outline on the CPU, storing it
+  //! into outline.m_triangles. Does nothing if the mesh is already valid.
+  //! This function does not require a GL context and is reentrant, so it can
+  //! be invoked from worker threads.
+  static void triangulate(TRegionOutline &outline);
+
   virtual void tessellate(const TColorFunction *cf, const bool antiAliasing,
                           TRegionOutline &outline, TPixel32 color) = 0;
   virtual void tessellate(const TColorFunction *cf, const bool antiAliasing,
@@ -42,34 +48,6 @@ public:
 //=============================================================================
 
 class DVAPI TglTessellator final : public TTessellator {
-public:
-  // TThread::Mutex m_mutex;
-
-  class DVAPI GLTess {
-  public:
-#ifdef GLU_VERSION_1_2
-    GLUtesselator *m_tess;
-#else
-#ifdef GLU_VERSION_1_1
-    GLUtriangulatorObj *m_tess;
-#else
-    void *m_tess;
-#endif
-#endif
-
-    GLTess();
-    ~GLTess();
-  };
-
-private:
-  // static GLTess m_glTess;
-
-  void doTessellate(GLTess &glTess, const TColorFunction *cf,
-                    const bool antiAliasing, TRegionOutline &outline);
-  void doTessellate(GLTess &glTess, const TColorFunction *cf,
-                    const bool antiAliasing, TRegionOutline outline,
-                    const TAffine &aff);
-
 public:
   // void tessellate(const TVectorRenderData &rd, TRegionOutline &outline );
   void tessellate(const TColorFunction *cf, const bool antiAliasing,
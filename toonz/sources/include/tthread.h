@@ -7,6 +7,8 @@
 
 #include <QThread>
 
+#include <functional>
+
 #undef DVAPI
 #undef DVVAR
 #ifdef TNZCORE_EXPORTS
@@ -28,6 +30,18 @@ void DVAPI init();
 //! \sa Executor::shutdown() method
 void DVAPI shutdown();
 
+/*!
+  Runs \b function on the calling thread and, concurrently, on up to
+  \b count - 1 threads of a pool shared by the whole process; returns once
+  all the runs are done. The runs should take their work from a common
+  queue, since their number is not known in advance.
+
+  Only the cores left free by the active Executor tasks - e.g. the render
+  threads - are used, and the pool never exceeds the cores count: when they
+  are all busy, \b function just runs on the calling thread.
+*/
+void DVAPI parallelRun(const std::function<void()> &function, int count);
+
 //------------------------------------------------------------------------------
 
 // Forward declarations
@@ -58,6 +58,10 @@ public:
     if (m_value->getValue(frame) == 0) return true;
     return (isAlmostIsotropic(info.m_affine));
   }
+
+  bool isIdentity() const override {
+    return !m_value->hasKeyframes() && m_value->getDefaultValue() == 0;
+  }
 };
 
 FX_PLUGIN_IDENTIFIER(BlurFx, "blurFx")
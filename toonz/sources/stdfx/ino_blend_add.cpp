@@ -14,21 +14,20 @@
 //-------------
 
 /* tnzbase --> Source Files --> tfx --> binaryFx.cppを参照 */
-class ino_blend_add final : public TBlendForeBackRasterFx {
+class ino_blend_add final : public TBlendForeBackKernelFx<ino_blend_add> {
   FX_PLUGIN_DECLARATION(ino_blend_add)
 
 public:
-  ino_blend_add() : TBlendForeBackRasterFx(true) {
+  ino_blend_add() : TBlendForeBackKernelFx(true) {
     // expand the opacity range
     this->m_opacity->setValueRange(0, 10.0 * ino::param_range());
   }
   ~ino_blend_add() {}
 
-  void brendKernel(double& dnr, double& dng, double& dnb, double& dna,
-                   const double upr, double upg, double upb, double upa,
-                   const double up_opacity,
-                   const bool alpha_rendering_sw = true,
-                   const bool do_clamp           = true) override {
+  template <class T>
+  static void kernel(T& dnr, T& dng, T& dnb, T& dna, const T upr, const T upg,
+                     const T upb, const T upa, const T up_opacity,
+                     const bool alpha_rendering_sw, const bool do_clamp) {
     igs::color::add(dnr, dng, dnb, dna, upr, upg, upb, upa, up_opacity,
                     do_clamp);
   }
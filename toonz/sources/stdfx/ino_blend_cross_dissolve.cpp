@@ -5,17 +5,17 @@
 #include "ino_common.h"
 #include "igs_color_blend.h"
 /* tnzbase --> Source Files --> tfx --> binaryFx.cppを参照 */
-class ino_blend_cross_dissolve final : public TBlendForeBackRasterFx {
+class ino_blend_cross_dissolve final
+    : public TBlendForeBackKernelFx<ino_blend_cross_dissolve> {
   FX_PLUGIN_DECLARATION(ino_blend_cross_dissolve)
 
 public:
-  ino_blend_cross_dissolve() : TBlendForeBackRasterFx(false) {}
+  ino_blend_cross_dissolve() : TBlendForeBackKernelFx(false) {}
   ~ino_blend_cross_dissolve() {}
-  void brendKernel(double& dnr, double& dng, double& dnb, double& dna,
-                   const double upr, double upg, double upb, double upa,
-                   const double up_opacity,
-                   const bool alpha_rendering_sw = true,
-                   const bool do_clamp           = true) override {
+  template <class T>
+  static void kernel(T& dnr, T& dng, T& dnb, T& dna, const T upr, const T upg,
+                     const T upb, const T upa, const T up_opacity,
+                     const bool alpha_rendering_sw, const bool do_clamp) {
     igs::color::cross_dissolve(dnr, dng, dnb, dna, upr, upg, upb, upa,
                                up_opacity, do_clamp);
   }
@@ -288,6 +288,48 @@ void ino::ras_to_ref_float_arr(const TRasterP in_ras, float* out_arr,
   }
 }
 
+//--------------------
+ino::ras_view::ras_view(const TRasterP ras, const bool float_sw)
+    : m_ras(ras), m_float_sw(float_sw) {
+  m_row_size = ras->getLx() * ino::channels() *
+               (float_sw ? sizeof(float)
+                         : ras->getPixelSize() / ino::channels());
+
+#if defined(TNZ_MACHINE_CHANNEL_ORDER_BGRM)
+  /* TPixel32,TPixel64,TPixelFのメモリ上の並びはigsと同じBGRA */
+  if (!float_sw || (TRasterFP)ras) return;
+#endif
+
+  m_buf = TRasterGR8P(m_row_size, ras->getLy());
+  m_buf->lock();
+  if (float_sw)
+    ino::ras_to_float_arr(ras, ino::channels(),
+                          reinterpret_cast<float*>(m_buf->getRawData()));
+  else
+    ino::ras_to_arr(ras, ino::channels(), m_buf->getRawData());
+}
+
+ino::ras_view::~ras_view() {
+  if (m_buf) m_buf->unlock();
+}
+
+bool ino::ras_view::contiguous() const {
+  return m_buf || m_ras->getWrap() == m_ras->getLx();
+}
+
+unsigned char* ino::ras_view::row(const int yy) {
+  return (m_buf) ? m_buf->getRawData() + yy * m_row_size
+                 : m_ras->getRawData(0, yy);
+}
+
+void ino::ras_view::commit() {
+  if (!m_buf) return;
+  if (m_float_sw)
+    ino::float_arr_to_ras(m_buf->getRawData(), ino::channels(), m_ras, 0);
+  else
+    ino::arr_to_ras(m_buf->getRawData(), ino::channels(), m_ras, 0);
+}
+
 //--------------------
 #if 0   //---
 void ino::Lx_to_wrap( TRasterP ras ) {
@@ -615,6 +657,11 @@ void TBlendForeBackRasterFx::doComputeFx(
   TRect rr       = intersection - pos;
   TRasterP cRup  = up_ras->extract(rr);
 
+  if (!linear_sw) {
+    nonlinearBlend(cRout, cRup, up_opacity);
+    return;
+  }
+
   TRaster32P rout32 = cRout, rup32 = cRup;
   TRaster64P rout64 = cRout, rup64 = cRup;
   TRasterFP routF = cRout, rupF = cRup;
@@ -622,38 +669,45 @@ void TBlendForeBackRasterFx::doComputeFx(
   bool premultiplied_sw = this->m_premultiplied->getValue();
 
   if (rout32 && rup32) {
-    if (linear_sw) {
-      if (!premultiplied_sw)
-        premultiToUnpremulti<TPixel32, UCHAR>(rout32, rup32, colorSpaceGamma);
+    if (!premultiplied_sw)
+      premultiToUnpremulti<TPixel32, UCHAR>(rout32, rup32, colorSpaceGamma);
 
-      linearTmpl<TPixel32, UCHAR>(rout32, rup32, up_opacity, gammaDif);
-    }
+    linearTmpl<TPixel32, UCHAR>(rout32, rup32, up_opacity, gammaDif);
     // linearAdd<TPixel32, UCHAR>(rout32, rup32, up_opacity, clipping_mask_sw,
     //  gamma, premultiplied_sw);
-    else
-      nonlinearTmpl<TPixel32, UCHAR>(rout32, rup32, up_opacity);
-    // tmpl_<TPixel32, UCHAR>(rout32, rup32, up_opacity, clipping_mask_sw);
   } else if (rout64 && rup64) {
-    if (linear_sw) {
-      if (!premultiplied_sw)
-        premultiToUnpremulti<TPixel64, USHORT>(rout64, rup64, colorSpaceGamma);
+    if (!premultiplied_sw)
+      premultiToUnpremulti<TPixel64, USHORT>(rout64, rup64, colorSpaceGamma);
 
-      linearTmpl<TPixel64, USHORT>(rout64, rup64, up_opacity, gammaDif);
-    } else
-      nonlinearTmpl<TPixel64, USHORT>(rout64, rup64, up_opacity);
+    linearTmpl<TPixel64, USHORT>(rout64, rup64, up_opacity, gammaDif);
   } else if (routF && rupF) {
-    if (linear_sw) {
-      if (!premultiplied_sw)
-        premultiToUnpremulti<TPixelF, float>(routF, rupF, colorSpaceGamma);
+    if (!premultiplied_sw)
+      premultiToUnpremulti<TPixelF, float>(routF, rupF, colorSpaceGamma);
 
-      linearTmpl<TPixelF, float>(routF, rupF, up_opacity, gammaDif);
-    } else
-      nonlinearTmpl<TPixelF, float>(routF, rupF, up_opacity);
+    linearTmpl<TPixelF, float>(routF, rupF, up_opacity, gammaDif);
   } else {
     throw TRopException("unsupported pixel type");
   }
 }
 
+//------------------------------------------------------------
+void TBlendForeBackRasterFx::nonlinearBlend(const TRasterP& dn_ras_out,
+                                            const TRasterP& up_ras,
+                                            const double up_opacity) {
+  TRaster32P rout32 = dn_ras_out, rup32 = up_ras;
+  TRaster64P rout64 = dn_ras_out, rup64 = up_ras;
+  TRasterFP routF = dn_ras_out, rupF = up_ras;
+
+  if (rout32 && rup32)
+    nonlinearTmpl<TPixel32, UCHAR>(rout32, rup32, up_opacity);
+  else if (rout64 && rup64)
+    nonlinearTmpl<TPixel64, USHORT>(rout64, rup64, up_opacity);
+  else if (routF && rupF)
+    nonlinearTmpl<TPixelF, float>(routF, rupF, up_opacity);
+  else
+    throw TRopException("unsupported pixel type");
+}
+
 //------------------------------------------------------------
 template <class T, class Q>
 void TBlendForeBackRasterFx::nonlinearTmpl(TRasterPT<T> dn_ras_out,
@@ -109,30 +109,28 @@ void fx_(TRasterP in_ras, const TRasterP refer_ras, const int refer_mode,
                               refer_mode);
   }
 
-  TRasterGR8P in_gr8(in_ras->getLy(),
-                     in_ras->getLx() * ino::channels() * sizeof(float));
-  in_gr8->lock();
-  ino::ras_to_float_arr(in_ras, ino::channels(),
-                        reinterpret_cast<float *>(in_gr8->getRawData()));
+  /* 各画素独立の処理なので、TRasterFPはtileの画素を直接(行毎に)処理する */
+  ino::ras_view in_view(in_ras, true);
 
-  igs::hls_adjust::change(
-      reinterpret_cast<float *>(in_gr8->getRawData()), in_ras->getLy(),
-      in_ras->getLx()  // Not use in_ras->getWrap()
-      ,
-      ino::channels(),
-      (ref_gr8) ? reinterpret_cast<float *>(ref_gr8->getRawData()) : nullptr,
-      hue_pivot, hue_scale, hue_shift, lig_pivot, lig_scale, lig_shift,
-      sat_pivot, sat_scale,
-      sat_shift
+  float *ref_arr =
+      (ref_gr8) ? reinterpret_cast<float *>(ref_gr8->getRawData()) : nullptr;
+  const int rows = in_view.contiguous() ? in_ras->getLy() : 1;
+  for (int yy = 0; yy < in_ras->getLy(); yy += rows) {
+    igs::hls_adjust::change(
+        reinterpret_cast<float *>(in_view.row(yy)), rows, in_ras->getLx(),
+        ino::channels(),
+        (ref_arr != nullptr) ? ref_arr + yy * in_ras->getLx() : nullptr,
+        hue_pivot, hue_scale, hue_shift, lig_pivot, lig_scale, lig_shift,
+        sat_pivot, sat_scale,
+        sat_shift
 
-      //,true	/* add_blend_sw */
-      ,
-      anti_alias_sw, !((TRasterFP)in_ras));
+        //,true	/* add_blend_sw */
+        ,
+        anti_alias_sw, !((TRasterFP)in_ras));
+  }
 
   /***ino::vec_to_ras( in_vec, ino::channels(), in_ras, 0 );***/
-
-  ino::float_arr_to_ras(in_gr8->getRawData(), ino::channels(), in_ras, 0);
-  in_gr8->unlock();
+  in_view.commit();
 
   if (ref_gr8) ref_gr8->unlock();
 }
@@ -139,53 +139,46 @@ void ino_level_master::doCompute(TTile &tile, double frame,
   /* ------ fx処理 ------------------------------------------ */
   try {
     TRasterP in_ras = tile.getRaster();
-    TRasterGR8P in_gr8(
-        in_ras->getLy(),
-        in_ras->getLx() * ino::channels() *
-            ((TRaster64P)in_ras   ? sizeof(unsigned short)
-             : (TRaster32P)in_ras ? sizeof(unsigned char)
-                                  : sizeof(float)));  // TRasterFP case
 
     in_ras->lock();
     if (refer_tile.getRaster() != nullptr) {
       refer_tile.getRaster()->lock();
     }
-    in_gr8->lock();
-
-    ino::ras_to_arr(in_ras, ino::channels(), in_gr8->getRawData());
-
-    const TRasterP refer_ras = (refer_sw ? refer_tile.getRaster() : nullptr);
-    igs::levels::change(
-        in_gr8->getRawData()
-
-            ,
-        in_ras->getLy(), in_ras->getLx()  // Not use in_ras->getWrap()
-        ,
-        ino::channels(), ino::bits(in_ras)
-
-                             ,
-        (((refer_ras != nullptr) && (0 <= refer_mode)) ? refer_ras->getRawData()
-                                                       : nullptr)  // BGRA
-        ,
-        (((refer_ras != nullptr) && (0 <= refer_mode)) ? ino::bits(refer_ras)
-                                                       : 0),
-        refer_mode
-
-        ,
-        v_in.first, v_in.second, v_in.first, v_in.second, v_in.first,
-        v_in.second, v_in.first, v_in.second, gamma, gamma, gamma, gamma,
-        v_out.first, v_out.second, v_out.first, v_out.second, v_out.first,
-        v_out.second, v_out.first, v_out.second
-
-        ,
-        true  // clamp_sw
-        ,
-        alp_rend_sw, anti_alias_sw  // --> add_blend_sw, default is true
-    );
-
-    ino::arr_to_ras(in_gr8->getRawData(), ino::channels(), in_ras, 0);
-
-    in_gr8->unlock();
+
+    /* 各画素独立の処理なので、tileの画素を直接(行毎に)処理する */
+    ino::ras_view in_view(in_ras, false);
+
+    const TRasterP refer_ras =
+        ((refer_sw && (0 <= refer_mode)) ? refer_tile.getRaster() : nullptr);
+    const int rows =
+        (in_view.contiguous() &&
+         ((refer_ras == nullptr) || (refer_ras->getWrap() == in_ras->getLx())))
+            ? in_ras->getLy()
+            : 1;
+    for (int yy = 0; yy < in_ras->getLy(); yy += rows) {
+      igs::levels::change(
+          in_view.row(yy), rows, in_ras->getLx(), ino::channels(),
+          ino::bits(in_ras),
+          ((refer_ras != nullptr) ? refer_ras->getRawData(0, yy)
+                                  : nullptr)  // BGRA
+          ,
+          ((refer_ras != nullptr) ? ino::bits(refer_ras) : 0), refer_mode
+
+          ,
+          v_in.first, v_in.second, v_in.first, v_in.second, v_in.first,
+          v_in.second, v_in.first, v_in.second, gamma, gamma, gamma, gamma,
+          v_out.first, v_out.second, v_out.first, v_out.second, v_out.first,
+          v_out.second, v_out.first, v_out.second
+
+          ,
+          true  // clamp_sw
+          ,
+          alp_rend_sw, anti_alias_sw  // --> add_blend_sw, default is true
+      );
+    }
+
+    in_view.commit();
+
     if (refer_tile.getRaster() != nullptr) {
       refer_tile.getRaster()->unlock();
     }
@@ -41,33 +41,16 @@ FX_PLUGIN_IDENTIFIER(ino_negate, "inoNegateFx");
 #include "igs_negate.h"
 namespace {
 void fx_(TRasterP in_ras, const bool sw_array[4]) {
-  /***std::vector<unsigned char> in_vec;
-  ino::ras_to_vec( in_ras, ino::channels(), in_vec );***/
+  /* 各画素独立の処理なので、tileの画素を直接(行毎に)処理する */
+  ino::ras_view in_view(in_ras, false);
 
-  TRasterGR8P in_gr8(in_ras->getLy(),
-                     in_ras->getLx() * ino::channels() *
-                         ((TRaster64P)in_ras ? sizeof(unsigned short)
-                                             : sizeof(unsigned char)));
-  in_gr8->lock();
-  ino::ras_to_arr(in_ras, ino::channels(), in_gr8->getRawData());
-
-  igs::negate::change(
-      // in_ras->getRawData() // BGRA
-      //&in_vec.at(0) // RGBA
-      in_gr8->getRawData()
-
-          ,
-      in_ras->getLy(), in_ras->getLx()  // Not use in_ras->getWrap()
-      ,
-      ino::channels(), ino::bits(in_ras)
-
-                           ,
-      sw_array);
-
-  /***ino::vec_to_ras( in_vec, ino::channels(), in_ras, 0 );***/
+  const int rows = in_view.contiguous() ? in_ras->getLy() : 1;
+  for (int yy = 0; yy < in_ras->getLy(); yy += rows) {
+    igs::negate::change(in_view.row(yy), rows, in_ras->getLx(),
+                        ino::channels(), ino::bits(in_ras), sw_array);
+  }
 
-  ino::arr_to_ras(in_gr8->getRawData(), ino::channels(), in_ras, 0);
-  in_gr8->unlock();
+  in_view.commit();
 }
 }  // namespace
 //------------------------------------------------------------
@@ -840,6 +840,50 @@ void Iwa_FlowPaintBrushFx::computeBrushVertices(
   }
 }
 //------------------------------------------------------------
+// The Flow, Area and Color ports are computed at the reference frame too,
+// which is shared by all the rendered frames. The Brush port handles its own
+// caching.
+
+void Iwa_FlowPaintBrushFx::doDryCompute(TRectD &rect, double frame,
+                                        const TRenderSettings &info) {
+  if (!m_brush.isConnected()) return;
+
+  int referenceFrame = (int)std::round(m_reference_frame->getValue(frame)) - 1;
+  double reference_prevalence = m_reference_prevalence->getValue(frame);
+  double ref_frame[2]         = {frame, (double)referenceFrame};
+
+  TTile tile;
+  for (int f = 0; f < 2; f++) {
+    int tmp_f = ref_frame[f];
+    if (f == 1 && (tmp_f < 0 || reference_prevalence == 0.0)) continue;
+
+    FlowPaintBrushFxParam p = getParam(tile, ref_frame[f], info);
+    TRectD inputRect(p.bbox.getP00(), TDimensionD(p.dim.lx, p.dim.ly));
+
+    if (m_flow.isConnected()) m_flow->dryCompute(inputRect, tmp_f, info);
+    if (f == 0 && reference_prevalence == 1.0) continue;
+    if (m_area.isConnected()) m_area->dryCompute(inputRect, tmp_f, info);
+    if (m_color.isConnected()) m_color->dryCompute(inputRect, tmp_f, info);
+  }
+}
+
+//------------------------------------------------------------
+
+bool Iwa_FlowPaintBrushFx::getTemporalFootprint(
+    double frame, int port, std::vector<double> &inputFrames) {
+  if (getInputPort(port) == &m_brush) return false;
+
+  int referenceFrame = (int)std::round(m_reference_frame->getValue(frame)) - 1;
+  if (referenceFrame < 0 || m_reference_prevalence->getValue(frame) == 0.0)
+    return false;
+
+  inputFrames.push_back(frame);
+  inputFrames.push_back(referenceFrame);
+  return true;
+}
+
+//------------------------------------------------------------
+
 void Iwa_FlowPaintBrushFx::doCompute(TTile &tile, double frame,
                                      const TRenderSettings &ri) {
   if (!m_brush.isConnected()) {
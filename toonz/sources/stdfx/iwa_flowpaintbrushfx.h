@@ -170,6 +170,10 @@ public:
   bool doGetBBox(double frame, TRectD &bBox,
                  const TRenderSettings &info) override;
   void doCompute(TTile &tile, double frame, const TRenderSettings &ri) override;
+  void doDryCompute(TRectD &rect, double frame,
+                    const TRenderSettings &info) override;
+  bool getTemporalFootprint(double frame, int port,
+                            std::vector<double> &inputFrames) override;
   void getParamUIs(TParamUIConcept *&concepts, int &length) override;
 
   std::string getAlias(double frame,
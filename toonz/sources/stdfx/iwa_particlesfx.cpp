@@ -400,6 +400,20 @@ bool Iwa_TiledParticlesFx::allowUserCacheOnPort(int portNum) {
 
 //------------------------------------------------------------------
 
+bool Iwa_TiledParticlesFx::getTemporalFootprint(
+    double frame, int port, std::vector<double> &inputFrames) {
+  // Control ports are computed from start to current frame
+  std::string tmpName = getInputPortName(port);
+  if (tmpName.find("Control") == std::string::npos) return false;
+
+  int curr_frame = frame, startframe = startpos_val->getValue();
+  for (int i = startframe - 1; i <= curr_frame; ++i)
+    inputFrames.push_back(std::max(0, i));
+  return true;
+}
+
+//------------------------------------------------------------------
+
 void Iwa_TiledParticlesFx::doDryCompute(TRectD &rect, double frame,
                                         const TRenderSettings &info) {
   Iwa_ParticlesManager *pc = Iwa_ParticlesManager::instance();
@@ -161,6 +161,8 @@ public:
 
   void doDryCompute(TRectD &rect, double frame,
                     const TRenderSettings &info) override;
+  bool getTemporalFootprint(double frame, int port,
+                            std::vector<double> &inputFrames) override;
   void doCompute(TTile &tile, double frame, const TRenderSettings &ri) override;
 
   void getParamUIs(TParamUIConcept *&concepts, int &length) override;
@@ -1,105 +1,66 @@
 #include "stdfx.h"
-#include <queue>
+#include <vector>
 
-#define TERMINAL ((Graph::arc*)1)
-#define ORPHAN ((Graph::arc*)2)
+/*!
+  Max-flow / min-cut solver on the 4-connected grid of a raster's pixels.
 
+  Edges only link horizontally and vertically adjacent nodes, so arcs are
+  implicit: each node stores the residual capacities of the arcs toward its
+  4 neighbors, and its parent in the search trees as a direction.
+
+  Nodes linked only by zero-capacity edges can't exchange any flow: mincut()
+  splits the grid into the regions connected by edges and solves them in
+  parallel, with the same segmentation as solving the whole grid at once.
+*/
 class Graph {
 public:
   typedef enum { SOURCE = 0, SINK = 1 } terminalType;
 
-  Graph(int maxNodeNum);
+  Graph(int width, int height);
   ~Graph();
 
 private:
-  struct node;
-  struct arc;
-
-  struct node {
-    arc* firstArc;
-    arc* parentArc;
-    bool isSink : 1;
-    int tCap;
-  };
+  // Arc directions, in the order they are scanned
+  enum Direction { DOWN = 0, RIGHT, LEFT, UP, DIRECTIONS_COUNT };
+  // Node parents other than a direction
+  enum : unsigned char { NO_PARENT = DIRECTIONS_COUNT, TERMINAL, ORPHAN };
 
-  struct arc {
-    node* headNode;
-    arc* nextArc;
-    arc* revArc;
-    int rCap;
-  };
+  class Solver;
+  friend class Solver;
 
-  node *nodes, *nodeLast;
-  arc *arcs, *arcLast;
-  int nodesNum, arcsNum;
+  int m_width, m_height, m_nodesCount;
+  int m_offsets[DIRECTIONS_COUNT];  // Index offsets of the neighbors
 
-  std::queue<node*> activeQueue;
-  std::queue<node*> orphanQueue;
-
-  int flow;
+  std::vector<int> m_rCaps;  // Residual capacities, DIRECTIONS_COUNT per node
+  std::vector<int> m_tCaps;  // Terminal capacities (> 0 toward the source)
+  std::vector<unsigned char> m_parents, m_isSink;
+  std::vector<unsigned char> m_links;  // Directions bitmask of the edges
 
 public:
+  //! Sets the capacities of the edge between two adjacent nodes.
   void addEdge(int from, int to, int cap, int revCap) {
-    if ((arcLast - arcs) + 2 >= arcsNum) {
-      throw std::runtime_error("Maximum number of edges exceeded");
+    int d = (to == from + 1)   ? RIGHT
+            : (to == from - 1) ? LEFT
+            : (to > from)      ? DOWN
+                               : UP;
+    assert(to == from + m_offsets[d]);
+
+    m_rCaps[DIRECTIONS_COUNT * from + d]      = cap;
+    m_rCaps[DIRECTIONS_COUNT * to + (UP - d)] = revCap;
+    if (cap || revCap) {
+      m_links[from] |= 1 << d;
+      m_links[to] |= 1 << (UP - d);
     }
-    node* fromNode = nodes + from;
-    node* toNode   = nodes + to;
-
-    arc* newArc = arcLast++;
-    arc* revArc = arcLast++;
-
-    newArc->headNode   = toNode;
-    newArc->rCap       = cap;
-    newArc->nextArc    = fromNode->firstArc;
-    newArc->revArc     = revArc;
-    fromNode->firstArc = newArc;
-
-    revArc->headNode = fromNode;
-    revArc->rCap     = revCap;
-    revArc->nextArc  = toNode->firstArc;
-    revArc->revArc   = newArc;
-    toNode->firstArc = revArc;
   }
 
-  void addTerminal(int nodeIndex, int tCap) { nodes[nodeIndex].tCap = tCap; }
+  void addTerminal(int nodeIndex, int tCap) { m_tCaps[nodeIndex] = tCap; }
 
-  terminalType getSegment(int nodeIndex, terminalType defaultType) {
-    if (nodes[nodeIndex].parentArc)
-      return nodes[nodeIndex].isSink ? SINK : SOURCE;
+  terminalType getSegment(int nodeIndex, terminalType defaultType) const {
+    if (m_parents[nodeIndex] != NO_PARENT)
+      return m_isSink[nodeIndex] ? SINK : SOURCE;
     else
       return defaultType;
   }
 
   void mincut();
-
-private:
-  void setActive(node* n) { activeQueue.push(n); }
-
-  node* nextActive() {
-    while (!activeQueue.empty()) {
-      node* n = activeQueue.front();
-      activeQueue.pop();
-      if (n->parentArc == ORPHAN) continue;
-      return n;
-    }
-    return nullptr;
-  }
-
-  void setOrphan(node* n) {
-    n->parentArc = ORPHAN;
-    orphanQueue.push(n);
-  }
-
-  node* nextOrphan() {
-    if (!orphanQueue.empty()) {
-      node* n = orphanQueue.front();
-      orphanQueue.pop();
-      return n;
-    } else
-      return nullptr;
-  }
-
-  void augment(arc* midArc);
-  void adopt();
-};
\ No newline at end of file
+};
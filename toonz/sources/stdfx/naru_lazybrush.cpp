@@ -285,8 +285,6 @@ void naru_lazybrush::doGraph(TRasterPT<PIXEL> ras, double frame,
   }
 
   // set capasity
-  std::vector<float> weights(rasSize, 0.0f);
-  std::vector<float> capacity(rasSize, 0.0f);
   float alpha        = m_alpha->getValue(frame);
   float sigma        = m_sigma->getValue(frame);
   float inv_sigmaSq2 = 1.0 / (2 * sigma * sigma);
@@ -305,15 +303,10 @@ void naru_lazybrush::doGraph(TRasterPT<PIXEL> ras, double frame,
             alpha * exp(-(intensity[p] + intensity[q]) * inv_sigmaSq2);
         g.addEdge(p, q, weight, weight);
       }
-      weights[p]  = intensity[p] / (K * LoG_s);
-      capacity[p] = exp(-intensity[p] * inv_sigmaSq2);
     }
   }
 
   // Scribble
-  std::vector<float> refR(rasSize, 0.0f);
-  std::vector<float> refG(rasSize, 0.0f);
-  std::vector<float> refB(rasSize, 0.0f);
   std::vector<float> scribbleR(rasSize, 0.0f);
   std::vector<float> scribbleB(rasSize, 0.0f);
   float lambda       = m_lambda->getValue(frame);
@@ -327,26 +320,21 @@ void naru_lazybrush::doGraph(TRasterPT<PIXEL> ras, double frame,
     for (int y = 0; y < height; ++y) {
       PIXEL* pix = refRas->pixels(y);
       for (int x = 0; x < width; ++x) {
-        int p   = idx(x, y, width);
-        refR[p] = (float)pix->r / (float)PIXEL::maxChannelValue;
-        refG[p] = (float)pix->g / (float)PIXEL::maxChannelValue;
-        refB[p] = (float)pix->b / (float)PIXEL::maxChannelValue;
-        pix++;
-      }
-    }
-    refRas->unlock();
-    for (int y = 0; y < height; ++y) {
-      for (int x = 0; x < width; ++x) {
-        int p = idx(x, y, width);
-        if (refR[p] > 0.5f && refG[p] < 0.5f && refB[p] < 0.5f) {
+        int p      = idx(x, y, width);
+        float refR = (float)pix->r / (float)PIXEL::maxChannelValue;
+        float refG = (float)pix->g / (float)PIXEL::maxChannelValue;
+        float refB = (float)pix->b / (float)PIXEL::maxChannelValue;
+        if (refR > 0.5f && refG < 0.5f && refB < 0.5f) {
           g.addTerminal(p, tLinkCap - sLinkCap);
           scribbleR[p] = 1.f;
-        } else if (refR[p] < 0.5f && refG[p] < 0.5f && refB[p] > 0.5f) {
+        } else if (refR < 0.5f && refG < 0.5f && refB > 0.5f) {
           g.addTerminal(p, sLinkCap - tLinkCap);
           scribbleB[p] = 1.f;
         }
+        pix++;
       }
     }
+    refRas->unlock();
   }
 
   float autoScribbleLength    = m_autoscrlen->getValue(frame);
@@ -385,7 +373,7 @@ void naru_lazybrush::doGraph(TRasterPT<PIXEL> ras, double frame,
         int cy = fcy0;
         if (cx < 0 || cx >= width - 1 || cy < 0 || cy >= height - 1) break;
         int cp = idx(cx, cy, width);
-        if (weights[cp] > autoScribbleThreshold) {
+        if (intensity[cp] / (K * LoG_s) > autoScribbleThreshold) {
           fcx0 += dx * lineWeight;
           fcy0 += dy * lineWeight;
           onLine = true;
@@ -410,7 +398,7 @@ void naru_lazybrush::doGraph(TRasterPT<PIXEL> ras, double frame,
         int cy = fcy1;
         if (cx < 0 || cx >= width - 1 || cy < 0 || cy >= height - 1) break;
         int cp = idx(cx, cy, width);
-        if (weights[cp] > autoScribbleThreshold) {
+        if (intensity[cp] / (K * LoG_s) > autoScribbleThreshold) {
           fcx1 -= dx * lineWeight;
           fcy1 -= dy * lineWeight;
           onLine = true;
@@ -486,13 +474,18 @@ void naru_lazybrush::doGraph(TRasterPT<PIXEL> ras, double frame,
     }
   }
 
-  std::vector<float> drawZero(rasSize, 0.0f);
+  if (mode < 2) return;
+
   std::vector<float> drawOne(rasSize, 1.0f);
   if (mode == 2) {  // Draw LoG Filter
     doDraw(ras, lap, lap, lap, drawOne);
   } else if (mode == 3) {  // Draw Capacity Map
+    std::vector<float> capacity(rasSize);
+    for (int p = 0; p < rasSize; ++p)
+      capacity[p] = exp(-intensity[p] * inv_sigmaSq2);
     doDraw(ras, capacity, capacity, capacity, drawOne);
   } else if (mode == 4) {  // Draw Scribble Map
+    std::vector<float> drawZero(rasSize, 0.0f);
     doDraw(ras, scribbleR, drawZero, scribbleB, drawOne);
   }
 }
@@ -505,72 +498,49 @@ void naru_lazybrush::doColorize(TRasterPT<PIXEL> ras, double frame, Graph& g,
 
   bool fillHole = m_fillHole->getValue();
   g.mincut();
-  std::vector<float> maskR(width * height, 0.0f);
-  std::vector<float> maskG(width * height, 0.0f);
-  std::vector<float> maskB(width * height, 0.0f);
-  std::vector<float> maskM(width * height, 0.0f);
-  // Mask
+
+  // result => line + mask
+  ras->lock();
   for (int y = 0; y < height; ++y) {
+    PIXEL* pix = ras->pixels(y);
     for (int x = 0; x < width; ++x) {
       int p = idx(x, y, width);
+
+      // Mask
+      float maskR = 0.f, maskG = 0.f, maskB = 0.f, maskM = 0.f;
       if (!g.getSegment(p, fillHole ? g.SOURCE : g.SINK)) {  // SOURCE
-        maskR[p] = maskColor.m * maskColor.r;
-        maskG[p] = maskColor.m * maskColor.g;
-        maskB[p] = maskColor.m * maskColor.b;
-        maskM[p] = maskColor.m;
+        maskR = maskColor.m * maskColor.r;
+        maskG = maskColor.m * maskColor.g;
+        maskB = maskColor.m * maskColor.b;
+        maskM = maskColor.m;
       }
-    }
-  }
 
-  std::vector<float> lineR(width * height, 0.0f);
-  std::vector<float> lineG(width * height, 0.0f);
-  std::vector<float> lineB(width * height, 0.0f);
-  std::vector<float> lineM(width * height, 0.0f);
-  // Line
-  if (mode == 0) {
-    // line => (r, g, b, 1.), noLine => (r, g, b, 0.)
-    ras->lock();
-    for (int y = 0; y < height; ++y) {
-      PIXEL* pix = ras->pixels(y);
-      for (int x = 0; x < width; ++x) {
-        int p   = idx(x, y, width);
-        float m = (float)pix->m / (float)PIXEL::maxChannelValue;
-        if (m != 0) {
-          float r  = (float)pix->r / (float)PIXEL::maxChannelValue;
-          float g  = (float)pix->g / (float)PIXEL::maxChannelValue;
-          float b  = (float)pix->b / (float)PIXEL::maxChannelValue;
-          lineM[p] = (1.f - fmin(fmin(r, g), b)) * m;
-          lineR[p] = r;
-          lineG[p] = g;
-          lineB[p] = b;
-        }
-        pix++;
+      // Line
+      // line => (r, g, b, 1.), noLine => (r, g, b, 0.)
+      float lineR = 0.f, lineG = 0.f, lineB = 0.f, lineM = 0.f;
+      float m     = (float)pix->m / (float)PIXEL::maxChannelValue;
+      if (mode == 0 && m != 0) {
+        lineR = (float)pix->r / (float)PIXEL::maxChannelValue;
+        lineG = (float)pix->g / (float)PIXEL::maxChannelValue;
+        lineB = (float)pix->b / (float)PIXEL::maxChannelValue;
+        lineM = (1.f - fmin(fmin(lineR, lineG), lineB)) * m;
       }
-    }
-    ras->unlock();
-  }
-  ras->lock();
 
-  // result => line + mask
-  for (int y = 0; y < height; ++y) {
-    PIXEL* pix = ras->pixels(y);
-    for (int x = 0; x < width; ++x) {
-      int p  = idx(x, y, width);
       pix->r = (typename PIXEL::Channel)(
-          (maskR[p] * (1.f - lineM[p]) + lineM[p] * lineR[p]) *
+          (maskR * (1.f - lineM) + lineM * lineR) *
           (float)PIXEL::maxChannelValue);
       pix->g = (typename PIXEL::Channel)(
-          (maskG[p] * (1.f - lineM[p]) + lineM[p] * lineG[p]) *
+          (maskG * (1.f - lineM) + lineM * lineG) *
           (float)PIXEL::maxChannelValue);
       pix->b = (typename PIXEL::Channel)(
-          (maskB[p] * (1.f - lineM[p]) + lineM[p] * lineB[p]) *
+          (maskB * (1.f - lineM) + lineM * lineB) *
           (float)PIXEL::maxChannelValue);
-      pix->m = (typename PIXEL::Channel)(fmax(maskM[p], lineM[p]) *
+      pix->m = (typename PIXEL::Channel)(fmax(maskM, lineM) *
                                          (float)PIXEL::maxChannelValue);
       pix++;
     }
-    ras->unlock();
   }
+  ras->unlock();
 }
 
 //------------------------------------------------------------------------------
@@ -590,11 +560,13 @@ void naru_lazybrush::process(TRasterPT<PIXEL> ras, double frame,
   LoG_s     = m_logs->getValue(frame);
 
   // create graph
-  Graph g = Graph(rasSize);
+  Graph g(width, height);
 
   doGrayScale<PIXEL>(ras, frame, gray);
   doLoG<PIXEL>(ras, frame, gray, lap);
+  std::vector<float>().swap(gray);
   doGraph<PIXEL>(ras, frame, refRas, refer_sw, lap, g);
+  std::vector<float>().swap(lap);
   if (mode == 0 || mode == 1) {
     doColorize<PIXEL>(ras, frame, g, gray);
   }
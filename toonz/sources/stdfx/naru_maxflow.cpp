@@ -1,188 +1,330 @@
 #include "naru_graph.h"
 
-Graph::Graph(int maxNodeNum) {
-  nodesNum = maxNodeNum;
-  arcsNum  = maxNodeNum * 4;
-  nodes    = new node[nodesNum];
-  arcs     = new arc[arcsNum];
-  nodeLast = nodes + nodesNum;
-  arcLast  = arcs;
-  flow     = 0;
-
-  for (int i = 0; i < maxNodeNum; ++i) {
-    nodes[i].firstArc  = nullptr;
-    nodes[i].parentArc = nullptr;
-    nodes[i].isSink    = false;
-    nodes[i].tCap      = 0;
+#include "tthread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <queue>
+
+namespace {
+
+// Below this nodes count, regions are solved on the calling thread only
+const int ParallelNodesCount = 1 << 16;
+
+// Nodes connected by edges. Its nodes indices are stored contiguously, in
+// ascending order.
+struct Region {
+  int m_begin, m_count;
+};
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+
+// Solves the graph regions picked from a shared counter. Each region is
+// solved on its own nodes and queues, so that solvers can run concurrently.
+class Graph::Solver {
+  int *m_rCaps, *m_tCaps;
+  unsigned char *m_parents, *m_isSink, *m_links;
+  const int *m_offsets;
+
+  const std::vector<int> &m_nodes;
+  const std::vector<Region> &m_regions;
+  std::atomic<int> &m_nextRegion;
+
+  std::queue<int> m_activeQueue;
+  std::queue<int> m_orphanQueue;
+
+public:
+  Solver(Graph &g, const std::vector<int> &nodes,
+         const std::vector<Region> &regions, std::atomic<int> &nextRegion)
+      : m_rCaps(g.m_rCaps.data())
+      , m_tCaps(g.m_tCaps.data())
+      , m_parents(g.m_parents.data())
+      , m_isSink(g.m_isSink.data())
+      , m_links(g.m_links.data())
+      , m_offsets(g.m_offsets)
+      , m_nodes(nodes)
+      , m_regions(regions)
+      , m_nextRegion(nextRegion) {}
+
+  void run();
+
+private:
+  bool hasArc(int n, int d) const { return m_links[n] & (1 << d); }
+  int head(int n, int d) const { return n + m_offsets[d]; }
+  int &rCap(int n, int d) { return m_rCaps[DIRECTIONS_COUNT * n + d]; }
+  int &revCap(int n, int d) {
+    return m_rCaps[DIRECTIONS_COUNT * head(n, d) + (UP - d)];
   }
-}
 
-Graph::~Graph() {
-  delete[] nodes;
-  delete[] arcs;
+  void setActive(int n) { m_activeQueue.push(n); }
+
+  int nextActive() {
+    while (!m_activeQueue.empty()) {
+      int n = m_activeQueue.front();
+      m_activeQueue.pop();
+      if (m_parents[n] == ORPHAN) continue;
+      return n;
+    }
+    return -1;
+  }
+
+  void setOrphan(int n) {
+    m_parents[n] = ORPHAN;
+    m_orphanQueue.push(n);
+  }
+
+  int nextOrphan() {
+    if (!m_orphanQueue.empty()) {
+      int n = m_orphanQueue.front();
+      m_orphanQueue.pop();
+      return n;
+    } else
+      return -1;
+  }
+
+  // Returns whether the tree path starting from n reaches a terminal
+  bool isRooted(int n) const {
+    for (;; n = head(n, m_parents[n])) {
+      if (m_parents[n] == TERMINAL) return true;
+      if (m_parents[n] == ORPHAN || m_parents[n] == NO_PARENT) return false;
+    }
+  }
+
+  void solve(const int *nodes, int count);
+  void augment(int midNode, int midDir);
+  void adopt();
+};
+
+//------------------------------------------------------------------------------
+
+void Graph::Solver::run() {
+  for (int r = m_nextRegion++; r < (int)m_regions.size();
+       r     = m_nextRegion++) {
+    const Region &region = m_regions[r];
+    solve(m_nodes.data() + region.m_begin, region.m_count);
+  }
 }
 
-void Graph::augment(arc* midArc) {
-  node* n;
-  arc* arc;
+//------------------------------------------------------------------------------
+
+void Graph::Solver::augment(int midNode, int midDir) {
+  int n, d;
 
-  int bottleneck = midArc->rCap;
+  int bottleneck = rCap(midNode, midDir);
   // source tree
-  for (n = midArc->revArc->headNode;; n = arc->headNode) {
-    arc = n->parentArc;
-    if (arc == TERMINAL) break;
-    if (bottleneck > arc->revArc->rCap) bottleneck = arc->revArc->rCap;
+  for (n = midNode;; n = head(n, d)) {
+    d = m_parents[n];
+    if (d == TERMINAL) break;
+    if (bottleneck > revCap(n, d)) bottleneck = revCap(n, d);
   }
-  if (bottleneck > n->tCap) bottleneck = n->tCap;
+  if (bottleneck > m_tCaps[n]) bottleneck = m_tCaps[n];
   // sink tree
-  for (n = midArc->headNode;; n = arc->headNode) {
-    arc = n->parentArc;
-    if (arc == TERMINAL) break;
-    if (bottleneck > arc->rCap) bottleneck = arc->rCap;
+  for (n = head(midNode, midDir);; n = head(n, d)) {
+    d = m_parents[n];
+    if (d == TERMINAL) break;
+    if (bottleneck > rCap(n, d)) bottleneck = rCap(n, d);
   }
-  if (bottleneck > -n->tCap) bottleneck = -n->tCap;
+  if (bottleneck > -m_tCaps[n]) bottleneck = -m_tCaps[n];
 
   // augment flow
   // source tree
-  for (n = midArc->revArc->headNode;; n = arc->headNode) {
-    arc = n->parentArc;
-    if (arc == TERMINAL) break;
-    arc->rCap += bottleneck;
-    arc->revArc->rCap -= bottleneck;
-    if (!arc->revArc->rCap) setOrphan(n);
+  for (n = midNode;; n = head(n, d)) {
+    d = m_parents[n];
+    if (d == TERMINAL) break;
+    rCap(n, d) += bottleneck;
+    revCap(n, d) -= bottleneck;
+    if (!revCap(n, d)) setOrphan(n);
   }
-  n->tCap -= bottleneck;
-  if (!n->tCap) setOrphan(n);
+  m_tCaps[n] -= bottleneck;
+  if (!m_tCaps[n]) setOrphan(n);
   // sink tree
-  for (n = midArc->headNode;; n = arc->headNode) {
-    arc = n->parentArc;
-    if (arc == TERMINAL) break;
-    arc->rCap -= bottleneck;
-    arc->revArc->rCap += bottleneck;
-    if (!arc->rCap) setOrphan(n);
+  for (n = head(midNode, midDir);; n = head(n, d)) {
+    d = m_parents[n];
+    if (d == TERMINAL) break;
+    rCap(n, d) -= bottleneck;
+    revCap(n, d) += bottleneck;
+    if (!rCap(n, d)) setOrphan(n);
   }
-  n->tCap += bottleneck;
-  if (!n->tCap) setOrphan(n);
+  m_tCaps[n] += bottleneck;
+  if (!m_tCaps[n]) setOrphan(n);
   // mid arc
-  midArc->revArc->rCap += bottleneck;
-  midArc->rCap -= bottleneck;
-
-  flow += bottleneck;
+  revCap(midNode, midDir) += bottleneck;
+  rCap(midNode, midDir) -= bottleneck;
 }
 
-void Graph::adopt() {
-  arc *arc, *arc2;
-  node *n, *nn;
-  for (n = nextOrphan(); n; n = nextOrphan()) {
-    // find a parent for the orphan node n
+//------------------------------------------------------------------------------
+
+void Graph::Solver::adopt() {
+  for (int n = nextOrphan(); n >= 0; n = nextOrphan()) {
+    // find a parent for the orphan node n. Once found, it is still replaced
+    // by any later neighbor directly linked to a terminal.
     bool found = false;
-    if (!n->isSink) {
-      // source tree
-      for (arc = n->firstArc; arc; arc = arc->nextArc) {
-        if (!arc->revArc->rCap || arc->headNode->isSink ||
-            !arc->headNode->parentArc)
-          continue;
-        for (nn = arc->headNode;; nn = nn->parentArc->headNode) {
-          if (nn->parentArc == TERMINAL) {
-            // found a parent
-            n->parentArc = arc;
-            setActive(n);
-            found = true;
-            break;
-          } else if (nn->parentArc == ORPHAN)
-            break;
-          if (found) break;
-        }
-      }
-    } else {
-      // sink tree
-      for (arc = n->firstArc; arc; arc = arc->nextArc) {
-        if (!arc->rCap || !arc->headNode->isSink || !arc->headNode->parentArc)
-          continue;
-        for (nn = arc->headNode;; nn = nn->parentArc->headNode) {
-          if (nn->parentArc == TERMINAL) {
-            // found a parent
-            n->parentArc = arc;
-            setActive(n);
-            found = true;
-            break;
-          } else if (nn->parentArc == ORPHAN)
-            break;
-          if (found) break;
-        }
+    for (int d = 0; d < DIRECTIONS_COUNT; ++d) {
+      if (!hasArc(n, d)) continue;
+      int nn = head(n, d);
+      if (!(m_isSink[n] ? rCap(n, d) : revCap(n, d)) ||
+          m_isSink[nn] != m_isSink[n] || m_parents[nn] == NO_PARENT)
+        continue;
+      if (found ? m_parents[nn] == TERMINAL : isRooted(nn)) {
+        m_parents[n] = d;
+        setActive(n);
+        found = true;
       }
     }
 
     // no origin found
     if (!found) {
-      for (arc = n->firstArc; arc; arc = arc->nextArc) {
-        nn   = arc->headNode;
-        arc2 = nn->parentArc;
-        if ((nn->isSink == n->isSink) && arc2) {
-          if (arc2 != TERMINAL && arc2 != ORPHAN && (arc2->headNode == n))
-            setOrphan(nn);
-        }
+      for (int d = 0; d < DIRECTIONS_COUNT; ++d) {
+        if (!hasArc(n, d)) continue;
+        int nn = head(n, d), d2 = m_parents[nn];
+        if (m_isSink[nn] == m_isSink[n] && d2 < DIRECTIONS_COUNT &&
+            head(nn, d2) == n)
+          setOrphan(nn);
       }
     }
   }
 }
 
-void Graph::mincut() {
+//------------------------------------------------------------------------------
+
+void Graph::Solver::solve(const int *nodes, int count) {
   // initialize active nodes
-  for (node* n = nodes; n < nodeLast; ++n) {
-    if (n->tCap > 0) {
-      n->isSink    = false;
-      n->parentArc = TERMINAL;
+  for (int i = 0; i < count; ++i) {
+    int n = nodes[i];
+    if (m_tCaps[n] > 0) {
+      m_isSink[n]  = false;
+      m_parents[n] = TERMINAL;
       setActive(n);
-    } else if (n->tCap < 0) {
-      n->isSink    = true;
-      n->parentArc = TERMINAL;
+    } else if (m_tCaps[n] < 0) {
+      m_isSink[n]  = true;
+      m_parents[n] = TERMINAL;
       setActive(n);
     }
   }
 
-  for (node* currentNode = nextActive(); currentNode;
-       currentNode       = nextActive()) {
+  for (int n = nextActive(); n >= 0; n = nextActive()) {
     // grow phase
-    node *n, *nn;
-    n = currentNode;
-    arc* arc;
+    int midNode = -1, midDir = 0;
 
-    if (!n->isSink) {
+    if (!m_isSink[n]) {
       // grow source node
-      for (arc = n->firstArc; arc; arc = arc->nextArc) {
-        if (arc->rCap <= 0) continue;
-        nn = arc->headNode;
-        if (!nn->parentArc || nn->parentArc == ORPHAN) {
-          nn->isSink    = false;
-          nn->parentArc = arc->revArc;
+      for (int d = 0; d < DIRECTIONS_COUNT; ++d) {
+        if (!hasArc(n, d) || rCap(n, d) <= 0) continue;
+        int nn = head(n, d);
+        if (m_parents[nn] == NO_PARENT || m_parents[nn] == ORPHAN) {
+          m_isSink[nn]  = false;
+          m_parents[nn] = UP - d;
           setActive(nn);
-        } else if (nn->isSink) {
+        } else if (m_isSink[nn]) {
+          midNode = n, midDir = d;
           break;
         }
       }
     } else {
       // grow sink node
-      for (arc = n->firstArc; arc; arc = arc->nextArc) {
-        if (arc->revArc->rCap <= 0) continue;
-        nn = arc->headNode;
-        if (!nn->parentArc || nn->parentArc == ORPHAN) {
-          nn->isSink    = true;
-          nn->parentArc = arc->revArc;
+      for (int d = 0; d < DIRECTIONS_COUNT; ++d) {
+        if (!hasArc(n, d) || revCap(n, d) <= 0) continue;
+        int nn = head(n, d);
+        if (m_parents[nn] == NO_PARENT || m_parents[nn] == ORPHAN) {
+          m_isSink[nn]  = true;
+          m_parents[nn] = UP - d;
           setActive(nn);
-        } else if (!nn->isSink) {
-          arc = arc->revArc;
+        } else if (!m_isSink[nn]) {
+          midNode = nn, midDir = UP - d;
           break;
         }
       }
     }
 
     // found path
-    if (arc) {
+    if (midNode >= 0) {
       // augment phase
-      augment(arc);
+      augment(midNode, midDir);
       // adopt phase
       adopt();
     }
   }
 }
+
+//******************************************************************************
+
+Graph::Graph(int width, int height)
+    : m_width(width)
+    , m_height(height)
+    , m_nodesCount(width * height)
+    , m_rCaps(DIRECTIONS_COUNT * m_nodesCount, 0)
+    , m_tCaps(m_nodesCount, 0)
+    , m_parents(m_nodesCount, NO_PARENT)
+    , m_isSink(m_nodesCount, false)
+    , m_links(m_nodesCount, 0) {
+  m_offsets[DOWN]  = width;
+  m_offsets[RIGHT] = 1;
+  m_offsets[LEFT]  = -1;
+  m_offsets[UP]    = -width;
+}
+
+Graph::~Graph() {}
+
+//------------------------------------------------------------------------------
+
+void Graph::mincut() {
+  std::vector<int> nodes;
+  std::vector<Region> regions;
+  {
+    // label the regions connected by edges
+    std::vector<int> labels(m_nodesCount);
+    for (int n = 0; n < m_nodesCount; ++n) labels[n] = n;
+
+    auto root = [&labels](int n) {
+      while (labels[n] != n) n = labels[n] = labels[labels[n]];
+      return n;
+    };
+    for (int n = 0; n < m_nodesCount; ++n)
+      for (int d : {DOWN, RIGHT}) {
+        if (!(m_links[n] & (1 << d))) continue;
+        int r0 = root(n), r1 = root(n + m_offsets[d]);
+        if (r0 != r1) labels[std::max(r0, r1)] = std::min(r0, r1);
+      }
+
+    // regions without terminals carry no flow
+    std::vector<int> sizes(m_nodesCount, 0);
+    std::vector<bool> hasTerminals(m_nodesCount, false);
+    for (int n = 0; n < m_nodesCount; ++n) {
+      labels[n] = root(n);
+      ++sizes[labels[n]];
+      if (m_tCaps[n]) hasTerminals[labels[n]] = true;
+    }
+
+    int nodesCount = 0;
+    for (int r = 0; r < m_nodesCount; ++r) {
+      if (!hasTerminals[r]) continue;
+      regions.push_back({nodesCount, sizes[r]});
+      std::swap(sizes[r], nodesCount);
+      nodesCount += sizes[r];
+    }
+
+    nodes.resize(nodesCount);
+    for (int n = 0; n < m_nodesCount; ++n)
+      if (hasTerminals[labels[n]]) nodes[sizes[labels[n]]++] = n;
+  }
+  if (regions.empty()) return;
+
+  // largest regions first, to balance the solvers' load
+  std::sort(regions.begin(), regions.end(),
+            [](const Region &a, const Region &b) {
+              return a.m_count > b.m_count;
+            });
+
+  std::atomic<int> nextRegion(0);
+
+  auto solveRegions = [&]() {
+    Solver(*this, nodes, regions, nextRegion).run();
+  };
+
+  if ((int)nodes.size() >= ParallelNodesCount)
+    TThread::parallelRun(solveRegions, (int)regions.size());
+  else
+    solveRegions();
+}
@@ -342,6 +342,20 @@ bool ParticlesFx::allowUserCacheOnPort(int portNum) {
 
 //------------------------------------------------------------------
 
+bool ParticlesFx::getTemporalFootprint(double frame, int port,
+                                       std::vector<double> &inputFrames) {
+  // Control ports are computed from start to current frame
+  std::string tmpName = getInputPortName(port);
+  if (tmpName.find("Control") == std::string::npos) return false;
+
+  int curr_frame = frame, startframe = startpos_val->getValue();
+  for (int i = startframe - 1; i <= curr_frame; ++i)
+    inputFrames.push_back(std::max(0, i));
+  return true;
+}
+
+//------------------------------------------------------------------
+
 void ParticlesFx::doDryCompute(TRectD &rect, double frame,
                                const TRenderSettings &info) {
   ParticlesManager *pc = ParticlesManager::instance();
@@ -58,12 +58,18 @@ public:
     m_input->compute(tile, frame, ri);
 
     double v = 1 - m_value->getValue(frame) / 100;
+    if (v == 1) return;  // Scaling would just round-trip premultiplication
+
     TRop::rgbmScale(tile.getRaster(), tile.getRaster(), 1, 1, 1, v);
   }
 
   bool canHandle(const TRenderSettings &info, double frame) override {
     return true;
   }
+
+  bool isIdentity() const override {
+    return !m_value->hasKeyframes() && m_value->getDefaultValue() == 0;
+  }
 };
 
 //==================================================================
@@ -57,6 +57,8 @@
 #include "tthreadmessage.h"
 #include "tmsgcore.h"
 #include "tstopwatch.h"
+#include "tprofiler.h"
+#include "tmemorygovernor.h"
 #include "timagecache.h"
 #include "tstream.h"
 #include "tfilepath_io.h"
@@ -74,6 +76,12 @@
 #include <QApplication>
 #include <QWaitCondition>
 #include <QMessageBox>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <map>
 
 #ifdef _WIN32
 #ifndef x64
@@ -214,6 +222,15 @@ TFarmController *FarmController = 0;
 TUserLogAppend *m_userLog;
 QString TaskId;
 
+// Completion times of the frames rendered in worker mode, in ms since the
+// start of their range
+QMutex FrameTimesMutex;
+QElapsedTimer RangeTimer;
+std::vector<std::pair<int, qint64>> FrameTimes;
+
+// Time a worker waits for its client to connect
+const int WorkerConnectTimeout = 60000;
+
 //-------------------------------------------------------------------------------
 
 void tcomposerRunOutOfContMemHandler(unsigned long size) {
@@ -285,6 +302,22 @@ public:
 
 //==================================================================================
 
+//! Logs the raster buffers allocated to render each frame.
+class RasterStatsLogger final : public TRenderPort {
+public:
+  void onRenderRasterCompleted(const RenderData &renderData) override {
+    const TBigMemoryManager::ThreadStats &stats = renderData.m_rasterStats;
+
+    int frame = (int)renderData.m_frames[0] + 1;
+    m_userLog->info("Frame " + std::to_string(frame) + " rasters: " +
+                    std::to_string(stats.m_allocSize >> 10) + " KB allocated, " +
+                    std::to_string(stats.m_reuseSize >> 10) + " KB reused, " +
+                    std::to_string(stats.m_peakSize >> 10) + " KB peak");
+  }
+};
+
+//==================================================================================
+
 bool MyMovieRenderListener::onFrameCompleted(int frame) {
   TFilePath fp = m_fp.withFrame(frame + 1);
   string msg;
@@ -296,6 +329,10 @@ bool MyMovieRenderListener::onFrameCompleted(int frame) {
   cout << msg << endl;
   m_userLog->info(msg);
   DVGui::info(QString::fromStdString(msg));
+  if (RangeTimer.isValid()) {
+    QMutexLocker sl(&FrameTimesMutex);
+    FrameTimes.push_back(std::make_pair(frame + 1, RangeTimer.elapsed()));
+  }
   if (FarmController) {
     try {
       FarmController->taskProgress(TaskId,
@@ -543,6 +580,9 @@ static std::pair<int, int> generateMovie(ToonzScene *scene, const TFilePath &fp,
 
     movieRenderer.addListener(listener);
 
+    RasterStatsLogger rasterStatsLogger;
+    movieRenderer.getTRenderer()->addPort(&rasterStatsLogger);
+
     for (int i = 0; i < numFrames; i += step, r += stepd) {
       TFxPair fx;
       if (rs.m_stereoscopic) scene->shiftCameraX(-rs.m_stereoscopicShift / 2);
@@ -572,6 +612,8 @@ static std::pair<int, int> generateMovie(ToonzScene *scene, const TFilePath &fp,
 
     //----------------- tcomposer's main thread loops here ----------------
 
+    movieRenderer.getTRenderer()->removePort(&rasterStatsLogger);
+
     // int frameCompleted = listener->m_frameCompletedCount;
     std::pair<int, int> framePair =
         std::make_pair(listener->m_frameCompletedCount, listener->m_frameCount);
@@ -581,6 +623,149 @@ static std::pair<int, int> generateMovie(ToonzScene *scene, const TFilePath &fp,
   }
 }
 
+//==================================================================================
+
+/*!
+  Stores the modification time of the scene file and of the files of its
+  levels - each frame file for sequences, and the palette for tlv levels.
+*/
+static void listSceneFiles(ToonzScene *scene, const TFilePath &scenePath,
+                           std::map<TFilePath, QDateTime> &fileTimes) {
+  std::vector<TFilePath> paths(1, scenePath);
+
+  std::vector<TXshLevel *> levels;
+  scene->getLevelSet()->listLevels(levels);
+  for (TXshLevel *level : levels) {
+    if (!level || level->getPath().isEmpty()) continue;
+
+    TFilePath path      = scene->decodeFilePath(level->getPath());
+    TXshSimpleLevel *sl = level->getSimpleLevel();
+    if (sl && path.getDots() == "..") {
+      for (const TFrameId &fid : sl->getFids())
+        paths.push_back(path.withFrame(fid));
+    } else
+      paths.push_back(path);
+
+    if (path.getType() == "tlv") paths.push_back(path.withType("tpl"));
+  }
+
+  for (const TFilePath &path : paths)
+    fileTimes[path] = TFileStatus(path).getLastModificationTime();
+}
+
+//-------------------------------------------------------------------------------
+
+static bool isModified(const std::map<TFilePath, QDateTime> &fileTimes) {
+  for (const auto &fileTime : fileTimes)
+    if (TFileStatus(fileTime.first).getLastModificationTime() !=
+        fileTime.second)
+      return true;
+
+  return false;
+}
+
+//==================================================================================
+
+/*!
+  Renders the frame ranges requested on the local socket \b serverName, until
+  the client quits or disconnects. The scene, its levels and the image cache
+  stay loaded across ranges. Each range is answered with the completion time
+  of its frames, then with its completed and total frames count:
+
+    render <r0> <r1> <taskId>   ->   frame <frame> <ms>  ...
+                                     done <completed> <total>
+    quit
+
+  Once the scene file or one of its level files is modified, ranges are
+  refused with "reload" and the worker quits, so that the client can start a
+  new one.
+*/
+static int runWorker(const QString &serverName, ToonzScene *scene,
+                     const TFilePath &scenePath, const TFilePath &fp,
+                     int step, int shrink, int threadCount, int maxTileSize) {
+  std::map<TFilePath, QDateTime> fileTimes;
+  listSceneFiles(scene, scenePath, fileTimes);
+
+  QLocalServer server;
+  QLocalServer::removeServer(serverName);
+  if (!server.listen(serverName) ||
+      !server.waitForNewConnection(WorkerConnectTimeout)) {
+    string msg = "Unable to serve " + serverName.toStdString();
+    cout << msg << endl;
+    m_userLog->error(msg);
+    return -3;
+  }
+
+  QLocalSocket *socket = server.nextPendingConnection();
+  m_userLog->info("Worker serving " + serverName.toStdString());
+
+  for (;;) {
+    while (!socket->canReadLine())
+      if (!socket->waitForReadyRead(-1)) return 0;  // Client disconnected
+
+    QStringList request =
+        QString::fromUtf8(socket->readLine()).simplified().split(' ');
+
+    QByteArray reply;
+    if (request[0] == "quit")
+      return 0;
+    else if (request[0] == "render" && request.size() == 4) {
+      if (isModified(fileTimes)) {
+        m_userLog->info("Scene modified: worker quits");
+        socket->write("reload\n");
+        while (socket->bytesToWrite() && socket->waitForBytesWritten(-1)) {
+        }
+        return 0;
+      }
+
+      TaskId = request[3];
+      {
+        QMutexLocker sl(&FrameTimesMutex);
+        FrameTimes.clear();
+      }
+
+      Sw1.start(true);
+      RangeTimer.start();
+      std::pair<int, int> framePair =
+          generateMovie(scene, fp, request[1].toInt(), request[2].toInt(), step,
+                        shrink, threadCount, maxTileSize);
+      Sw1.stop();
+
+      string msg = "Range " + request[1].toStdString() + "-" +
+                   request[2].toStdString() + " completed in " +
+                   ::to_string(Sw1.getTotalTime() / 1000.0, 2) + " seconds";
+      cout << msg << endl;
+      m_userLog->info(msg);
+
+      QMutexLocker sl(&FrameTimesMutex);
+      for (const auto &frameTime : FrameTimes)
+        reply += "frame " + QByteArray::number(frameTime.first) + " " +
+                 QByteArray::number(frameTime.second) + "\n";
+      reply += "done " + QByteArray::number(framePair.first) + " " +
+               QByteArray::number(framePair.second) + "\n";
+    } else
+      reply = "error\n";
+
+    socket->write(reply);
+    while (socket->bytesToWrite() && socket->waitForBytesWritten(-1)) {
+    }
+  }
+}
+
+//==================================================================================
+
+//! Writes the render activity recorded since TProfiler::start() to \b fp.
+static void exportProfile(const TFilePath &fp) {
+  TProfiler::instance()->stop();
+
+  string path = fp.getQString().toStdString();
+  string msg  = TProfiler::instance()->exportChromeTrace(fp)
+                    ? "Render profile written to " + path
+                    : "Unable to write the render profile to " + path;
+  cout << msg << endl;
+  m_userLog->info(msg);
+}
+
 //==================================================================================
 //
 // main()
@@ -611,8 +796,19 @@ int main(int argc, char *argv[]) {
   StringQualifier tileSize("-maxtilesize n",
                            "Enable tile rendering of max n MB per tile");
   StringQualifier tmsg("-tmsg val", "only internal use");
+  StringQualifier worker("-worker name",
+                         "Render the ranges requested on a local socket");
+  FilePathQualifier profile("-profile traceFile",
+                            "Write a Chrome trace of the render activity");
+  IntQualifier memoryBudget("-memorybudget MB",
+                            "Raster memory budget of the render, in MB");
+  IntQualifier rasterPool("-rasterpool MB",
+                          "Released raster buffers kept for reuse, in MB");
+  SimpleQualifier hugePages("-hugepages",
+                            "Back large raster buffers with huge pages");
   usageLine = srcName + dstName + range + stepOpt + shrinkOpt + multimedia +
-              farmData + idq + nthreads + tileSize + tmsg;
+              farmData + idq + nthreads + tileSize + tmsg + worker + profile +
+              memoryBudget + rasterPool + hugePages;
 
   // system path qualifiers
   std::map<QString, std::unique_ptr<TCli::QualifierT<TFilePath>>>
@@ -972,6 +1168,32 @@ int main(int argc, char *argv[]) {
     if (maxTileSize != (std::numeric_limits<int>::max)())
       m_userLog->info("Render tile: " + std::to_string(maxTileSize));
 
+    if (memoryBudget.isSelected()) {
+      if (memoryBudget.getValue() <= 0) {
+        cout << "Qualifier 'memorybudget': bad input" << endl;
+        exit(1);
+      }
+
+      TMemoryGovernor::instance()->setBudget((TINT64)memoryBudget.getValue()
+                                             << 10);
+      m_userLog->info("Memory budget: " +
+                      std::to_string(memoryBudget.getValue()) + " MB");
+    }
+
+    if (rasterPool.isSelected()) {
+      if (rasterPool.getValue() < 0) {
+        cout << "Qualifier 'rasterpool': bad input" << endl;
+        exit(1);
+      }
+
+      TBigMemoryManager::instance()->setRasterPoolCapacity(
+          (TUINT32)rasterPool.getValue() << 10);
+      m_userLog->info("Raster pool: " + std::to_string(rasterPool.getValue()) +
+                      " MB");
+    }
+    if (hugePages.isSelected())
+      TBigMemoryManager::instance()->enableHugePages(true);
+
     // Disable the Passive cache manager. It has no sense if it cannot write on
     // disk...
     // TCacheResourcePool::instance();   //Needs to be instanced before
@@ -996,9 +1218,22 @@ int main(int argc, char *argv[]) {
 #endif
 #endif
 
+    if (profile.isSelected()) TProfiler::instance()->start();
+
+    if (worker.isSelected()) {
+      int ret = runWorker(QString::fromStdString(worker.getValue()), scene,
+                          srcFilePath, theDstFilePath, step, shrink,
+                          threadCount, maxTileSize);
+      if (profile.isSelected()) exportProfile(profile.getValue());
+      TImageCache::instance()->clear(true);
+      return ret;
+    }
+
     framePair = generateMovie(scene, theDstFilePath, r0, r1, step, shrink,
                               threadCount, maxTileSize);
 
+    if (profile.isSelected()) exportProfile(profile.getValue());
+
     Sw1.stop();
 
     m_userLog->info(
@@ -1010,6 +1245,16 @@ int main(int argc, char *argv[]) {
         std::to_string(TBigMemoryManager::instance()->getAllocationMean()) +
         " KB");
 
+    std::vector<TBigMemoryManager::PoolStats> poolStats;
+    TBigMemoryManager::instance()->getRasterPoolStats(poolStats);
+    int poolAllocCount = 0, poolReuseCount = 0;
+    for (const TBigMemoryManager::PoolStats &stats : poolStats) {
+      poolAllocCount += stats.m_allocCount;
+      poolReuseCount += stats.m_reuseCount;
+    }
+    m_userLog->info("Raster Pool Reuses: " + std::to_string(poolReuseCount) +
+                    " of " + std::to_string(poolAllocCount) + " buffers");
+
     msg = "Compositing completed in " +
           ::to_string(Sw1.getTotalTime() / 1000.0, 2) + " seconds";
     string msg2 =
@@ -1017,6 +1262,8 @@ int main(int argc, char *argv[]) {
         " seconds spent on loading" + "\n" +
         ::to_string(TStopWatch::global(0).getTotalTime() / 1000.0, 2) +
         " seconds spent on saving" + "\n" +
+        ::to_string(TStopWatch::global(1).getTotalTime() / 1000.0, 2) +
+        " seconds spent waiting on output" + "\n" +
         ::to_string(TStopWatch::global(8).getTotalTime() / 1000.0, 2) +
         " seconds spent on rendering" + "\n";
     cout << msg + msg2;
@@ -2,6 +2,9 @@
 
 #include "trasterfx.h"
 
+// STD includes
+#include <set>
+
 // Core-system includes
 #include "tsystem.h"
 #include "tthreadmessage.h"
@@ -10,6 +13,7 @@
 #include "tparamcontainer.h"
 #include "tbasefx.h"
 #include "tfxattributes.h"
+#include "tmacrofx.h"
 
 // Images components
 #include "timagecache.h"
@@ -20,6 +24,7 @@
 #include "trenderresourcemanager.h"
 #include "tfxcachemanager.h"
 #include "trenderer.h"
+#include "tprofiler.h"
 
 // Diagnostics
 // #define DIAGNOSTICS
@@ -67,6 +72,22 @@ inline TRect myConvert(const TRectD &rect) {
 
 //--------------------------------------------------
 
+//! Returns the name of the fx in profiler recordings
+std::string profileName(TRasterFx *fx) {
+  std::wstring fxId = fx->getFxId();
+  return fxId.empty() ? fx->getFxType() : ::to_string(fxId);
+}
+
+//--------------------------------------------------
+
+std::string profileArgs(const TRectD &rect, double frame) {
+  return TProfiler::arg("lx", (int)rect.getLx()) + "," +
+         TProfiler::arg("ly", (int)rect.getLy()) + "," +
+         TProfiler::arg("frame", (int)frame + 1);
+}
+
+//--------------------------------------------------
+
 inline TRectD myConvert(const TRect &rect) {
   return TRectD(rect.x0, rect.y0, rect.x1 + 1, rect.y1 + 1);
 }
@@ -455,6 +476,11 @@ void FxResourceBuilder::compute(const TRectD &tileRect) {
   sw.start();
 #endif
 
+  TProfileSpan span;
+  if (TProfiler::isActive())
+    span.begin("compute", profileName(m_rfx.getPointer()),
+               profileArgs(tileRect, m_frame));
+
   buildTileToCalculate(tileRect);
   m_rfx->doCompute(*m_currTile, m_frame, *m_rs);
 
@@ -707,6 +733,10 @@ void TRasterFx::dryCompute(TRectD &rect, double frame,
       TRenderer::instance().getRenderStatus(TRenderer::renderId());
   TFxCacheManager *cacheManager = TFxCacheManager::instance();
 
+  TProfileSpan span;
+  if (TProfiler::isActive())
+    span.begin("dryCompute", profileName(this), profileArgs(rect, frame));
+
   if (renderStatus == TRenderer::FIRSTRUN) {
     TRectD bbox;
     // ret = getBBox... puo' darsi che l'enlarge del trFx (o naturale del bbox)
@@ -757,9 +787,12 @@ void TRasterFx::dryCompute(TRectD &rect, double frame,
 //! increasing
 //! order, using the TRasterFx::transform method to identify the tiles to be
 //! passed
-//! on input precomputation.
+//! on input precomputation. Ports are precomputed at each frame of their
+//! temporal footprint.
 void TRasterFx::doDryCompute(TRectD &rect, double frame,
                              const TRenderSettings &info) {
+  std::vector<double> inputFrames;
+
   int inputPortCount = getInputPortCount();
   for (int i = 0; i < inputPortCount; ++i) {
     TFxPort *port = getInputPort(i);
@@ -770,14 +803,55 @@ void TRasterFx::doDryCompute(TRectD &rect, double frame,
       TRasterFxP fx = port->getFx();
       transform(frame, i, rect, info, rectOnInput, infoOnInput);
 
-      if (!myIsEmpty(rectOnInput))
-        fx->dryCompute(rectOnInput, frame, infoOnInput);
+      if (myIsEmpty(rectOnInput)) continue;
+
+      inputFrames.clear();
+      if (!getTemporalFootprint(frame, i, inputFrames))
+        inputFrames.push_back(frame);
+
+      for (double inputFrame : inputFrames) {
+        TRectD inputRect(rectOnInput);
+        fx->dryCompute(inputRect, inputFrame, infoOnInput);
+      }
     }
   }
 }
 
 //--------------------------------------------------
 
+namespace {
+
+bool hasTemporalFootprint(TFx *fx, double frame, std::set<TFx *> &visited) {
+  if (!fx || !visited.insert(fx).second) return false;
+
+  if (TMacroFx *macroFx = dynamic_cast<TMacroFx *>(fx))
+    return hasTemporalFootprint(macroFx->getRoot(), frame, visited);
+
+  TRasterFx *rasFx = dynamic_cast<TRasterFx *>(fx);
+  std::vector<double> inputFrames;
+
+  int inputPortCount = fx->getInputPortCount();
+  for (int i = 0; i < inputPortCount; ++i) {
+    TFxPort *port = fx->getInputPort(i);
+    if (!port->isConnected()) continue;
+
+    if ((rasFx && rasFx->getTemporalFootprint(frame, i, inputFrames)) ||
+        hasTemporalFootprint(port->getFx(), frame, visited))
+      return true;
+  }
+
+  return false;
+}
+
+}  // namespace
+
+bool TRasterFx::hasTemporalFootprint(double frame) {
+  std::set<TFx *> visited;
+  return ::hasTemporalFootprint(this, frame, visited);
+}
+
+//--------------------------------------------------
+
 //! This is an overloaded member function that deals with
 //! the allocation of an input tile before invoking the TRasterFx::compute
 //! method on it.
@@ -951,9 +1025,15 @@ void TRasterFx::compute(TTile &tile, double frame,
 
 #endif
 
-  // Invoke the fx-specific computation process
+  // Invoke the fx-specific computation process. Its span includes the cache
+  // accesses, while the nested "compute" span only covers doCompute().
+  TProfileSpan span;
+  if (TProfiler::isActive())
+    span.begin("fx", profileName(this), profileArgs(interestingRect, frame));
+
   FxResourceBuilder rBuilder(alias, this, info, frame);
   rBuilder.build(interestingTile);
+  span.end();
 
   // convert to linear
   if (isLinear != computeInLinear) {
@@ -267,28 +267,35 @@ public:
       m_constraints3;  //!< Compiled constraints (depends on the above)
   bool m_compiled;     //!< Whether the deformer is ready to deform()
 
+public:
+  //! Data passed along the deformation steps. It is allocated by each
+  //! deform() call, so that compiled data is only read while deforming -
+  //! and a compiled deformer can be shared among threads.
+  struct Buffers {
+    DoublePtr m_out;       //!< Step 1's result
+    DoublePtr m_fx, m_fy;  //!< Step 3's known terms, built in step 2
+  };
+
 public:
   Imp();
 
   void initialize(const TTextureMeshP &mesh);
   void compile(const std::vector<PlasticHandle> &handles, int *faceHints);
-  void deform(const TPointD *dstHandles, double *dstVerticesCoords);
+  void deform(const TPointD *dstHandles, double *dstVerticesCoords) const;
 
-  void copyOriginals(double *dstVerticesCoords);
+  void copyOriginals(double *dstVerticesCoords) const;
 
 public:
   tlin::spmat m_G;         //!< Pre-initialized entries for the 1st
                            //!< linear system
   SuperFactorsPtr m_invC;  //!< C's factors (C is G plus linear constraints)
-  DoublePtr m_q;           //!< Step 1's known term
-  DoublePtr m_out;         //!< Step 1's result
 
   // Step 1 members:
   //   The first step of a MeshDeformer instance is about building the desired
   //   vertices configuration.
   void initializeStep1();
   void compileStep1(const std::vector<PlasticHandle> &handles);
-  void deformStep1(const TPointD *dstHandles, double *dstVerticesCoords);
+  void deformStep1(const TPointD *dstHandles, Buffers &buffers) const;
 
   void releaseInitializedData();
 
@@ -298,9 +305,6 @@ public:
 
   TPointDPtr m_relativeCoords;  //!< Faces' p2 coordinates in (p0, p1)'s
                                 //! orthogonal reference
-  double m_v[4], m_c[4];        //!< Known term and output coordinates
-
-  TPointDPtr m_fitTriangles;  //!< Output face coordinates
 
   // Step 2 members:
   //   The second step of MeshDeformer rigidly maps neighbourhoods of the
@@ -308,7 +312,7 @@ public:
   //   to fit as much as possible the neighbourhoods in the step 1 result.
   void initializeStep2();
   void compileStep2(const std::vector<PlasticHandle> &handles);
-  void deformStep2(const TPointD *dstHandles, double *dstVerticesCoords);
+  void deformStep2(const TPointD *dstHandles, Buffers &buffers) const;
 
 public:
   // NOTE: This step accepts separation in the X and Y components
@@ -316,15 +320,13 @@ public:
   tlin::spmat m_H;         //!< Step 3's system entries
   SuperFactorsPtr m_invK;  //!< System inverse
 
-  DoublePtr m_fx, m_fy;  //!< Known terms
-  DoublePtr m_x, m_y;    //!< Output values
-
   // Step 3 members:
   //   The third step of MeshDeformer glues together the mapped neighbourhoods
   //   from step2.
   void initializeStep3();
   void compileStep3(const std::vector<PlasticHandle> &handles);
-  void deformStep3(const TPointD *dstHandles, double *dstVerticesCoords);
+  void deformStep3(const TPointD *dstHandles, Buffers &buffers,
+                   double *dstVerticesCoords) const;
 };
 
 //=================================================================================
@@ -397,7 +399,7 @@ void PlasticDeformer::Imp::compile(const std::vector<PlasticHandle> &handles,
 //-------------------------------------------------------------------------------------------
 
 void PlasticDeformer::Imp::deform(const TPointD *dstHandles,
-                                  double *dstVerticesCoords) {
+                                  double *dstVerticesCoords) const {
   assert(m_mesh);
   assert(dstVerticesCoords);
 
@@ -427,14 +429,16 @@ void PlasticDeformer::Imp::deform(const TPointD *dstHandles,
     return;
   }
 
-  deformStep1(dstHandles, dstVerticesCoords);
-  deformStep2(dstHandles, dstVerticesCoords);
-  deformStep3(dstHandles, dstVerticesCoords);
+  Buffers buffers;
+
+  deformStep1(dstHandles, buffers);
+  deformStep2(dstHandles, buffers);
+  deformStep3(dstHandles, buffers, dstVerticesCoords);
 }
 
 //-------------------------------------------------------------------------------------------
 
-void PlasticDeformer::Imp::copyOriginals(double *dstVerticesCoords) {
+void PlasticDeformer::Imp::copyOriginals(double *dstVerticesCoords) const {
   int v, vCount = m_mesh->verticesCount();
   for (v = 0; v != vCount; ++v, dstVerticesCoords += 2) {
     dstVerticesCoords[0] = m_mesh->vertex(v).P().x;
@@ -500,8 +504,6 @@ void PlasticDeformer::Imp::compileStep1(
     const std::vector<PlasticHandle> &handles) {
   // First, release resources
   m_invC.reset();
-  m_q.reset();
-  m_out.reset();
 
   // Now, start compiling
   const TTextureMesh &mesh = *m_mesh;
@@ -534,40 +536,37 @@ void PlasticDeformer::Imp::compileStep1(
 
   tlin::freeS(trC);
 
-  if (invC) {
+  if (invC)
     m_invC.reset(invC);
-
-    // Reallocate arrays
-    m_q.reset(new double[cSize]);
-    m_out.reset(new double[cSize]);
-
-    memset(m_q.get(), 0,
-           2 * vCount *
-               sizeof(double));  // Initialize the system's known term with 0
-  } else
+  else
     m_compiled = false;
 }
 
 //-------------------------------------------------------------------------------------------
 
 void PlasticDeformer::Imp::deformStep1(const TPointD *dstHandles,
-                                       double *dstVerticesCoords) {
+                                       Buffers &buffers) const {
   int vCount2 = 2 * m_mesh->verticesCount();
   int cSize   = vCount2 + 2 * m_handles.size();
 
+  DoublePtr q(new double[cSize]);
+  buffers.m_out.reset(new double[cSize]);
+
+  // Initialize the system's known term with 0
+  memset(q.get(), 0, vCount2 * sizeof(double));
+
   // Copy destination handles into the system's known term
   int i, h;
   for (i = vCount2, h = 0; i < cSize; i += 2, ++h) {
     const TPointD &dstHandlePos = dstHandles[m_constraints1[h].m_h];
 
-    m_q[i] = dstHandlePos.x;  // NOTE: We could use calloc on-the-fly, sparing
-    m_q[i + 1] =
-        dstHandlePos.y;  // some memory. Have to benchmark the cost, though...
+    q[i]     = dstHandlePos.x;
+    q[i + 1] = dstHandlePos.y;
   }
 
   // Solve the linear system
-  double *out = m_out.get();
-  tlin::solve(m_invC.get(), m_q.get(), out);
+  double *out = buffers.m_out.get();
+  tlin::solve(m_invC.get(), q.get(), out);
 
 #ifdef GL_DEBUG
 
@@ -605,7 +604,6 @@ void PlasticDeformer::Imp::initializeStep2() {
   std::vector<SuperFactorsPtr>(fCount).swap(m_invF);
 
   m_relativeCoords.reset(new TPointD[fCount]);
-  m_fitTriangles.reset(new TPointD[3 * fCount]);
 
   // Build step 2's system factorizations (yep, can be done at this point)
   const TPointD *p0, *p1, *p2;
@@ -641,20 +639,30 @@ void PlasticDeformer::Imp::compileStep2(
 //-------------------------------------------------------------------------------------------
 
 void PlasticDeformer::Imp::deformStep2(const TPointD *dstHandles,
-                                       double *dstVerticesCoords) {
+                                       Buffers &buffers) const {
   const TTextureMesh &mesh = *m_mesh;
   int vCount               = mesh.verticesCount();
+  int kSize                = vCount + m_constraints3.size();
 
-  memset(m_fx.get(), 0,
-         vCount * sizeof(double));  // These should be part of step 3...
-  memset(m_fy.get(), 0,
-         vCount * sizeof(double));  // They are filled here just for convenience
+  double *fx = new double[kSize], *fy = new double[kSize];
+  buffers.m_fx.reset(fx), buffers.m_fy.reset(fy);
 
-  // Build fit triangles
-  TPointD *fitTri = m_fitTriangles.get(), *relCoord = m_relativeCoords.get();
-  double *out1 = m_out.get();
+  // These should be part of step 3... they are filled here just for
+  // convenience
+  memset(fx, 0, vCount * sizeof(double));
+  memset(fy, 0, vCount * sizeof(double));
 
   int f, fCount = mesh.facesCount();
+
+  // Build fit triangles
+  TPointDPtr fitTriangles(new TPointD[3 * fCount]);
+
+  TPointD *fitTri         = fitTriangles.get();
+  const TPointD *relCoord = m_relativeCoords.get();
+  double *out1            = buffers.m_out.get();
+
+  double v[4], c[4];  // Known term and output coordinates
+
   for (f = 0; f < fCount; ++f, fitTri += 3, ++relCoord) {
     int v0, v1, v2;
     m_mesh->faceVertices(f, v0, v1, v2);
@@ -665,13 +673,13 @@ void PlasticDeformer::Imp::deformStep2(const TPointD *dstHandles,
     double *v0x = out1 + (v0 << 1), *v0y = v0x + 1, *v1x = out1 + (v1 << 1),
            *v1y = v1x + 1, *v2x = out1 + (v2 << 1), *v2y = v2x + 1;
 
-    build_c(*v0x, *v0y, *v1x, *v1y, *v2x, *v2y, relCoord->x, relCoord->y, m_c);
+    build_c(*v0x, *v0y, *v1x, *v1y, *v2x, *v2y, relCoord->x, relCoord->y, c);
 
-    double *vPtr = (double *)m_v;
-    tlin::solve(m_invF[f].get(), (double *)m_c, vPtr);
+    double *vPtr = v;
+    tlin::solve(m_invF[f].get(), c, vPtr);
 
-    fitTri[0].x = m_v[0], fitTri[0].y = m_v[1];
-    fitTri[1].x = m_v[2], fitTri[1].y = m_v[3];
+    fitTri[0].x = v[0], fitTri[0].y = v[1];
+    fitTri[1].x = v[2], fitTri[1].y = v[3];
 
     fitTri[2].x = fitTri[0].x + relCoord->x * (fitTri[1].x - fitTri[0].x) +
                   relCoord->y * (fitTri[1].y - fitTri[0].y);
@@ -696,19 +704,19 @@ void PlasticDeformer::Imp::deformStep2(const TPointD *dstHandles,
     // Build f -- note: this should be part of step 3, we're just avoiding the
     // same cycle twice :)
     add_f_values(v0, v1, fitTri[0].x, fitTri[1].x,
-                 std::min(p0.rigidity, p1.rigidity), m_fx.get());
+                 std::min(p0.rigidity, p1.rigidity), fx);
     add_f_values(v0, v1, fitTri[0].y, fitTri[1].y,
-                 std::min(p0.rigidity, p1.rigidity), m_fy.get());
+                 std::min(p0.rigidity, p1.rigidity), fy);
 
     add_f_values(v1, v2, fitTri[1].x, fitTri[2].x,
-                 std::min(p1.rigidity, p2.rigidity), m_fx.get());
+                 std::min(p1.rigidity, p2.rigidity), fx);
     add_f_values(v1, v2, fitTri[1].y, fitTri[2].y,
-                 std::min(p1.rigidity, p2.rigidity), m_fy.get());
+                 std::min(p1.rigidity, p2.rigidity), fy);
 
     add_f_values(v2, v0, fitTri[2].x, fitTri[0].x,
-                 std::min(p2.rigidity, p0.rigidity), m_fx.get());
+                 std::min(p2.rigidity, p0.rigidity), fx);
     add_f_values(v2, v0, fitTri[2].y, fitTri[0].y,
-                 std::min(p2.rigidity, p0.rigidity), m_fy.get());
+                 std::min(p2.rigidity, p0.rigidity), fy);
   }
 
 #ifdef GL_DEBUG
@@ -716,7 +724,7 @@ void PlasticDeformer::Imp::deformStep2(const TPointD *dstHandles,
   glColor3d(0.0, 0.0, 1.0);  // Blue
 
   // Draw fit triangles
-  fitTri = m_fitTriangles.get();
+  fitTri = fitTriangles.get();
 
   for (f = 0; f < fCount; ++f, fitTri += 3) {
     glBegin(GL_LINE_LOOP);
@@ -761,10 +769,6 @@ void PlasticDeformer::Imp::compileStep3(
     const std::vector<PlasticHandle> &handles) {
   // First, release resources
   m_invK.reset();
-  m_x.reset();
-  m_y.reset();
-  m_fx.reset();
-  m_fy.reset();
 
   // If compilation already failed, skip
   if (!m_compiled) return;
@@ -800,44 +804,45 @@ void PlasticDeformer::Imp::compileStep3(
 
   tlin::freeS(trK);
 
-  if (invK) {
+  if (invK)
     m_invK.reset(invK);
-
-    m_x.reset(new double[kSize]);
-    m_y.reset(new double[kSize]);
-    m_fx.reset(new double[kSize]);
-    m_fy.reset(new double[kSize]);
-  } else
+  else
     m_compiled = false;
 }
 
 //-------------------------------------------------------------------------------------------
 
 void PlasticDeformer::Imp::deformStep3(const TPointD *dstHandles,
-                                       double *dstVerticesCoords) {
+                                       Buffers &buffers,
+                                       double *dstVerticesCoords) const {
   int v, vCount = m_mesh->verticesCount();
+  int kSize     = vCount + m_constraints3.size();
   int c;
   int h, hCount = m_handles.size();
 
+  double *fx = buffers.m_fx.get(), *fy = buffers.m_fy.get();
+
   for (c = 0, h = 0; h < hCount; ++h) {
     if (!m_handles[h].m_interpolate) continue;
 
     const TPointD &dstHandlePos = dstHandles[m_constraints1[h].m_h];
 
-    m_fx[vCount + c] = dstHandlePos.x;
-    m_fy[vCount + c] = dstHandlePos.y;
+    fx[vCount + c] = dstHandlePos.x;
+    fy[vCount + c] = dstHandlePos.y;
 
     ++c;
   }
 
-  double *x = m_x.get(), *y = m_y.get();
-  tlin::solve(m_invK.get(), m_fx.get(), x);
-  tlin::solve(m_invK.get(), m_fy.get(), y);
+  DoublePtr xPtr(new double[kSize]), yPtr(new double[kSize]);
+
+  double *x = xPtr.get(), *y = yPtr.get();
+  tlin::solve(m_invK.get(), fx, x);
+  tlin::solve(m_invK.get(), fy, y);
 
   int i;
   for (i = v = 0; v < vCount; ++v, i += 2) {
-    dstVerticesCoords[i]     = m_x[v];
-    dstVerticesCoords[i + 1] = m_y[v];
+    dstVerticesCoords[i]     = x[v];
+    dstVerticesCoords[i + 1] = y[v];
   }
 }
 
@@ -1,5 +1,8 @@
 #include <memory>
 
+// TnzCore includes
+#include "tthread.h"
+
 // TnzExt includes
 #include "ext/plasticskeleton.h"
 #include "ext/plasticskeletondeformation.h"
@@ -8,6 +11,7 @@
 #include <limits>
 #include <map>
 #include <algorithm>
+#include <atomic>
 
 // Boost includes
 #include <boost/multi_index_container.hpp>
@@ -72,6 +76,115 @@ typedef DeformersSet::index<DeformedSkeleton>::type DeformersByDeformedSkeleton;
 
 }  // namespace
 
+//***********************************************************************************************
+//    Compiled deformers cache  definition
+//***********************************************************************************************
+
+namespace {
+
+//! Compiled deformers are identified by the mesh they deform, and the
+//! (source) handles they were compiled against.
+typedef std::pair<const TTextureMesh *, std::vector<double>> CompiledKey;
+
+CompiledKey compiledKey(const TTextureMesh *mesh,
+                        const std::vector<PlasticHandle> &handles) {
+  CompiledKey key(mesh, std::vector<double>());
+  key.second.reserve(3 * handles.size());
+
+  std::vector<PlasticHandle>::size_type h, hCount = handles.size();
+  for (h = 0; h != hCount; ++h) {
+    key.second.push_back(handles[h].m_pos.x);
+    key.second.push_back(handles[h].m_pos.y);
+    key.second.push_back(handles[h].m_interpolate ? 1.0 : 0.0);
+  }
+
+  return key;
+}
+
+//----------------------------------------------------------------------------------
+
+//! The factorizations built by PlasticDeformer::compile() only depend on the
+//! mesh and the source handles - which, in a typical animation, stay the same
+//! for every frame. They are kept here, so that groups sharing them (eg the
+//! temporary groups built by processOnce() while rendering, possibly from
+//! multiple threads) compile them just once.
+class CompiledDeformers {
+  struct Entry {
+    std::shared_ptr<PlasticDeformer> m_deformer;
+    std::vector<int> m_faceHints;  //!< Handles' face hints, once compiled
+    unsigned long m_lastAccess;
+  };
+
+  QMutex m_mutex;
+  std::map<CompiledKey, Entry> m_entries;
+  unsigned long m_accessCount;
+
+public:
+  enum { MaxEntriesCount = 64 };
+
+public:
+  CompiledDeformers() : m_accessCount(0) {}
+
+  //! Returns the deformer compiled against the specified key, if any,
+  //! copying its face hints too.
+  std::shared_ptr<PlasticDeformer> deformer(const CompiledKey &key,
+                                            std::vector<int> &faceHints) {
+    QMutexLocker locker(&m_mutex);
+
+    std::map<CompiledKey, Entry>::iterator et = m_entries.find(key);
+    if (et == m_entries.end()) return std::shared_ptr<PlasticDeformer>();
+
+    et->second.m_lastAccess = ++m_accessCount;
+    faceHints               = et->second.m_faceHints;
+
+    return et->second.m_deformer;
+  }
+
+  void store(const CompiledKey &key,
+             const std::shared_ptr<PlasticDeformer> &deformer,
+             const std::vector<int> &faceHints) {
+    QMutexLocker locker(&m_mutex);
+
+    Entry &entry       = m_entries[key];
+    entry.m_deformer   = deformer;
+    entry.m_faceHints  = faceHints;
+    entry.m_lastAccess = ++m_accessCount;
+
+    // Release the least recently used deformers in excess
+    while (m_entries.size() > MaxEntriesCount) {
+      std::map<CompiledKey, Entry>::iterator et, lru = m_entries.begin();
+      for (et = m_entries.begin(); et != m_entries.end(); ++et)
+        if (et->second.m_lastAccess < lru->second.m_lastAccess) lru = et;
+
+      m_entries.erase(lru);
+    }
+  }
+
+  //! Releases the deformers compiled on the meshes of the specified image.
+  void release(const TMeshImage *meshImage) {
+    QMutexLocker locker(&m_mutex);
+
+    const std::vector<TTextureMeshP> &meshes = meshImage->meshes();
+
+    std::vector<TTextureMeshP>::const_iterator mt, mEnd(meshes.end());
+    for (mt = meshes.begin(); mt != mEnd; ++mt) {
+      const TTextureMesh *mesh = mt->getPointer();
+
+      std::map<CompiledKey, Entry>::iterator et =
+          m_entries.lower_bound(CompiledKey(mesh, std::vector<double>()));
+      while (et != m_entries.end() && et->first.first == mesh)
+        m_entries.erase(et++);
+    }
+  }
+
+  void clear() {
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+  }
+};
+
+}  // namespace
+
 //***********************************************************************************************
 //    Initialization stage  functions
 //***********************************************************************************************
@@ -344,33 +457,93 @@ void processSO(DataGroup *group, double frame, const TMeshImage *meshImage,
 
 namespace {
 
+//! Meshes of a mesh image are compiled and deformed independently. When
+//! their overall size makes it worth it, they are processed concurrently.
+const int ParallelVerticesCount = 2000;
+
+//----------------------------------------------------------------------------------
+
+void processMeshes(DataGroup *group, const TMeshImage *meshImage,
+                   const std::vector<int> &meshIdxs, bool compile) {
+  int i, iCount = meshIdxs.size(), vTotal = 0;
+  for (i = 0; i != iCount; ++i)
+    vTotal += meshImage->meshes()[meshIdxs[i]]->verticesCount();
+
+  const TPointD *dstHandlePos =
+      group->m_dstHandles.empty() ? 0 : &group->m_dstHandles.front();
+
+  std::atomic<int> nextIdx(0);
+  auto processNext = [&]() {
+    int idx;
+    while ((idx = nextIdx++) < iCount) {
+      int m                     = meshIdxs[idx];
+      PlasticDeformerData &data = group->m_datas[m];
+
+      if (compile) {
+        PlasticDeformer &deformer = *data.m_deformer;
+
+        deformer.initialize(meshImage->meshes()[m]);
+        deformer.compile(
+            group->m_handles,
+            data.m_faceHints.empty() ? 0 : &data.m_faceHints.front());
+        deformer.releaseInitializedData();
+      } else
+        data.m_deformer->deform(dstHandlePos, data.m_output.get());
+    }
+  };
+
+  if (vTotal >= ParallelVerticesCount)
+    TThread::parallelRun(processNext, iCount);
+  else
+    processNext();
+}
+
+//----------------------------------------------------------------------------------
+
 void processMesh(DataGroup *group, double frame, const TMeshImage *meshImage,
-                 const SkD *sd, int skelId, const TAffine &deformationAffine) {
+                 const SkD *sd, int skelId, const TAffine &deformationAffine,
+                 CompiledDeformers &compiledDeformers) {
   if (!(group->m_upToDate & PlasticDeformerStorage::MESH)) {
     int m, mCount = meshImage->meshes().size();
 
+    std::vector<int> meshIdxs;
+    meshIdxs.reserve(mCount);
+
     if (!(group->m_compiled & PlasticDeformerStorage::MESH)) {
+      // Reuse the deformers already compiled against the group's handles
+      std::vector<CompiledKey> keys(mCount);
+
       for (m = 0; m != mCount; ++m) {
-        const TTextureMeshP &mesh = meshImage->meshes()[m];
         PlasticDeformerData &data = group->m_datas[m];
 
-        data.m_deformer.initialize(mesh);
-        data.m_deformer.compile(
-            group->m_handles,
-            data.m_faceHints.empty() ? 0 : &data.m_faceHints.front());
-        data.m_deformer.releaseInitializedData();
+        keys[m]         = ::compiledKey(meshImage->meshes()[m].getPointer(),
+                                        group->m_handles);
+        data.m_deformer = compiledDeformers.deformer(keys[m], data.m_faceHints);
+
+        if (!data.m_deformer) {
+          data.m_deformer = std::make_shared<PlasticDeformer>();
+          meshIdxs.push_back(m);
+        }
+      }
+
+      // Compile the others, and make them available to other groups
+      if (!meshIdxs.empty()) {
+        processMeshes(group, meshImage, meshIdxs, true);
+
+        for (int i = 0; i != (int)meshIdxs.size(); ++i) {
+          PlasticDeformerData &data = group->m_datas[meshIdxs[i]];
+          compiledDeformers.store(keys[meshIdxs[i]], data.m_deformer,
+                                  data.m_faceHints);
+        }
       }
 
       group->m_compiled |= PlasticDeformerStorage::MESH;
     }
 
-    const TPointD *dstHandlePos =
-        group->m_dstHandles.empty() ? 0 : &group->m_dstHandles.front();
+    meshIdxs.clear();
+    for (m = 0; m != mCount; ++m) meshIdxs.push_back(m);
 
-    for (m = 0; m != mCount; ++m) {
-      PlasticDeformerData &data = group->m_datas[m];
-      data.m_deformer.deform(dstHandlePos, data.m_output.get());
-    }
+    processMeshes(group, meshImage, meshIdxs, false);
 
     group->m_upToDate |= PlasticDeformerStorage::MESH;
   }
@@ -413,6 +586,8 @@ public:
   QMutex m_mutex;            //!< Access mutex - needed for thread-safety
   DeformersSet m_deformers;  //!< Set of deformers, ordered by mesh image,
                              //! deformation, and affine.
+  CompiledDeformers
+      m_compiledDeformers;  //!< Compiled deformers, shared among groups
 
 public:
   Imp() : m_mutex(QMutex::Recursive) {}
@@ -493,7 +668,8 @@ const PlasticDeformerDataGroup *PlasticDeformerStorage::process(
     processSO(group, frame, meshImage, deformation, skelId, skeletonAffine);
 
   if (doMesh)
-    processMesh(group, frame, meshImage, deformation, skelId, skeletonAffine);
+    processMesh(group, frame, meshImage, deformation, skelId, skeletonAffine,
+                m_imp->m_compiledDeformers);
 
   return group;
 }
@@ -520,7 +696,8 @@ const PlasticDeformerDataGroup *PlasticDeformerStorage::processOnce(
     processSO(group, frame, meshImage, deformation, skelId, skeletonAffine);
 
   if (doMesh)
-    processMesh(group, frame, meshImage, deformation, skelId, skeletonAffine);
+    processMesh(group, frame, meshImage, deformation, skelId, skeletonAffine,
+                instance()->m_imp->m_compiledDeformers);
 
   return group;
 }
@@ -531,6 +708,9 @@ void PlasticDeformerStorage::invalidateMeshImage(const TMeshImage *meshImage,
                                                  int recompiledData) {
   QMutexLocker locker(&m_imp->m_mutex);
 
+  // Mesh changes (eg rigidities) invalidate compiled deformers
+  if (recompiledData & MESH) m_imp->m_compiledDeformers.release(meshImage);
+
   DeformersByMeshImage &deformers = m_imp->m_deformers.get<TMeshImage>();
 
   DeformersByMeshImage::iterator dBegin(deformers.lower_bound(meshImage));
@@ -602,6 +782,8 @@ void PlasticDeformerStorage::invalidateDeformation(
 void PlasticDeformerStorage::releaseMeshData(const TMeshImage *meshImage) {
   QMutexLocker locker(&m_imp->m_mutex);
 
+  m_imp->m_compiledDeformers.release(meshImage);
+
   DeformersByMeshImage &deformers = m_imp->m_deformers.get<TMeshImage>();
 
   DeformersByMeshImage::iterator dBegin(deformers.lower_bound(meshImage));
@@ -652,4 +834,5 @@ void PlasticDeformerStorage::clear() {
   QMutexLocker locker(&m_imp->m_mutex);
 
   m_imp->m_deformers.clear();
+  m_imp->m_compiledDeformers.clear();
 }
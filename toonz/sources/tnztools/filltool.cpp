@@ -82,6 +82,7 @@ TEnv::IntVar FillSegment("InknpaintFillSegment", 0);
 TEnv::IntVar FillCloseGap("InknpaintFillCloseGap", 0);
 TEnv::IntVar FillReferFill("InknpaintFillReferFill", 0);
 TEnv::IntVar FillRange("InknpaintFillRange", 0);
+TEnv::IntVar FillUseRegionMap("InknpaintFillUseRegionMap", 0);
 TEnv::IntVar FillExtend("InknpaintFillExtend", 0);
 
 //-----------------------------------------------------------------------------
@@ -1059,6 +1060,9 @@ void doRefFill(const TImageP &img, const TRaster32P &refImg, const TPointD &pos,
                const TFrameId &fid, bool autopaintLines) {
   TTool::Application *app = TTool::getApplication();
   if (!app) return;
+  // Kept alive across the image change notification when it is still valid
+  std::shared_ptr<FillRegionMap> regionMap;
+  std::string regionMapId;
   if (TToonzImageP ti = TToonzImageP(img)) {
     TPoint offs(0, 0);
     TRasterCM32P ras = ti->getRaster();
@@ -1101,7 +1105,16 @@ void doRefFill(const TImageP &img, const TRaster32P &refImg, const TPointD &pos,
     // !autoPaintLines temporarily disables autopaint line feature
     if (plt && hasAutoInks(plt) && autopaintLines) params.m_palette = plt;
     if (params.m_fillType == ALL || params.m_fillType == AREAS) {
-      fill(ras, params, &tileSaver, refImg);
+      if (params.m_useRegionMap && sl && !refImg.getPointer()) {
+        regionMapId = sl->getImageId(fid, 0);
+        if (Preferences::instance()->getFillOnlySavebox()) regionMapId += "s";
+        regionMap = FillRegionMap::getMap(regionMapId, ras);
+        if (!regionMap->fill(ras, params, &tileSaver)) {
+          regionMap.reset();
+          fill(ras, params, &tileSaver, refImg);
+        }
+      } else
+        fill(ras, params, &tileSaver, refImg);
       TRect tileBBox   = tileSaver.getTileSet()->getBBox();
       TRect tiBBox     = ti->getSavebox() - offs;
       recomputeSavebox = !tiBBox.contains(tileBBox);
@@ -1133,7 +1146,10 @@ void doRefFill(const TImageP &img, const TRaster32P &refImg, const TPointD &pos,
 
     TXshSimpleLevel *sl = xl->getSimpleLevel();
     sl->getProperties()->setDirtyFlag(true);
-    if (recomputeSavebox) ToolUtils::updateSaveBox(sl, fid);
+    if (recomputeSavebox) {
+      ToolUtils::updateSaveBox(sl, fid);
+      regionMap.reset();
+    }
 
     ras->unlock();
   } else if (TVectorImageP vi = TImageP(img)) {
@@ -1148,6 +1164,9 @@ void doRefFill(const TImageP &img, const TRaster32P &refImg, const TPointD &pos,
 
   TTool *t = app->getCurrentTool()->getTool();
   if (t) t->notifyImageChanged();
+
+  if (regionMap && regionMap->isValid())
+    FillRegionMap::setMap(regionMapId, regionMap);
 }
 
 void doFill(const TImageP &img, const TPointD &pos, FillParameters &params,
@@ -1985,7 +2004,8 @@ FillTool::FillTool(int targetType)
     , m_firstTime(true)
     , m_autopaintLines("Autopaint Lines", true)
     , m_referFill("Refer Fill", false)
-    , m_extendFill("Extend Fill", true) {
+    , m_extendFill("Extend Fill", true)
+    , m_regionMap("Region Map", false) {
   m_areaFillTool       = new AreaFillTool(this);
   m_normalLineFillTool = new NormalLineFillTool(this);
 
@@ -2018,6 +2038,7 @@ FillTool::FillTool(int targetType)
   if (targetType == TTool::ToonzImage) {
     m_prop.bind(m_autopaintLines);
     m_prop.bind(m_extendFill);
+    m_prop.bind(m_regionMap);
     m_prop.bind(m_gapCloseDistance);
   }
   m_emptyOnly.setId("EmptyOnly");
@@ -2031,6 +2052,7 @@ FillTool::FillTool(int targetType)
   m_autopaintLines.setId("AutopaintLines");
   m_gapCloseDistance.setId("GapCloseDistance");
   m_extendFill.setId("ExtendFill");
+  m_regionMap.setId("RegionMap");
 }
 //-----------------------------------------------------------------------------
 
@@ -2202,6 +2224,7 @@ void FillTool::updateTranslation() {
   m_autopaintLines.setQStringName(tr("Autopaint Lines"));
   m_gapCloseDistance.setQStringName(tr("Gap Close Distance:"));
   m_extendFill.setQStringName(tr("Extend Fill"));
+  m_regionMap.setQStringName(tr("Region Map"));
 }
 
 //-----------------------------------------------------------------------------
@@ -2218,6 +2241,7 @@ FillParameters FillTool::getFillParameters() const {
   params.m_minFillDepth = (int)m_fillDepth.getValue().first;
   params.m_maxFillDepth = (int)m_fillDepth.getValue().second;
   params.m_extendFill   = m_extendFill.getValue();
+  params.m_useRegionMap = m_regionMap.getValue();
   return params;
 }
 
@@ -2497,6 +2521,10 @@ bool FillTool::onPropertyChanged(std::string propertyName, bool addToUndo) {
   else if (propertyName == m_extendFill.getName()) {
     FillExtend = (int)(m_extendFill.getValue());
   }
+  // Region Map
+  else if (propertyName == m_regionMap.getName()) {
+    FillUseRegionMap = (int)(m_regionMap.getValue());
+  }
 
   else if (!m_frameSwitched && (propertyName == m_maxGapDistance.getName())) {
     TXshLevel *xl = TTool::getApplication()->getCurrentLevel()->getLevel();
@@ -2747,6 +2775,7 @@ void FillTool::onActivate() {
         AutocloseDistance, AutocloseAngle, AutocloseOpacity,
         AutocloseIgnoreAutoPaint);
     m_extendFill.setValue(FillExtend ? 1 : 0);
+    m_regionMap.setValue(FillUseRegionMap ? 1 : 0);
     m_firstTime = false;
 
     if (m_fillType.getValue() != NORMALFILL) {
@@ -121,6 +121,7 @@ class FillTool final : public QObject, public TTool {
   // disabled
   TBoolProperty m_autopaintLines;
   TBoolProperty m_extendFill;
+  TBoolProperty m_regionMap;
 
   SlFidsPairs m_slFidsPairs;
   RefImgTable m_refImgTable;  // imageId
@@ -35,6 +35,7 @@
 #include "toonz/palettecontroller.h"
 #include "toonz/tonionskinmaskhandle.h"
 #include "toonz/autoclose.h"
+#include "toonz/fill.h"
 #include "toutputproperties.h"
 
 // TnzCore includes
@@ -700,8 +701,10 @@ void TTool::notifyImageChanged() {
     if (!sl) return;
     TFrameId fid = m_application->getCurrentFrame()->getFid();
     sl->touchFrame(fid);
-    if (sl->getType() & TXshLevelType::RASTER_TYPE)
+    if (sl->getType() & TXshLevelType::RASTER_TYPE) {
       TAutocloser::invalidateSegmentCache(sl->getImageId(fid));
+      FillRegionMap::invalidate(sl->getImageId(fid, 0));
+    }
     // sl->setDirtyFlag(true);
     IconGenerator::instance()->invalidate(sl, fid);
     IconGenerator::instance()->invalidateSceneIcon();
@@ -724,9 +727,11 @@ void TTool::notifyImageChanged() {
       if (sl) {
         IconGenerator::instance()->invalidate(sl, cell.m_frameId);
         sl->touchFrame(cell.m_frameId);
-        if (sl->getType() & TXshLevelType::RASTER_TYPE)
+        if (sl->getType() & TXshLevelType::RASTER_TYPE) {
           TAutocloser::invalidateSegmentCache(
               sl->getImageId(cell.m_frameId, 0));
+          FillRegionMap::invalidate(sl->getImageId(cell.m_frameId, 0));
+        }
         IconGenerator::instance()->invalidateSceneIcon();
       }
     }
@@ -755,8 +760,10 @@ void TTool::notifyImageChanged(const TFrameId &fid,
     sl->setDirtyFlag(true);
     IconGenerator::instance()->invalidate(sl, fid);
     IconGenerator::instance()->invalidateSceneIcon();
-    if (sl->getType() & TXshLevelType::RASTER_TYPE)
+    if (sl->getType() & TXshLevelType::RASTER_TYPE) {
       TAutocloser::invalidateSegmentCache(sl->getImageId(fid, 0));
+      FillRegionMap::invalidate(sl->getImageId(fid, 0));
+    }
   } else {
     int row = m_application->getCurrentFrame()->getFrame();
     int col = m_application->getCurrentColumn()->getColumnIndex();
@@ -772,8 +779,10 @@ void TTool::notifyImageChanged(const TFrameId &fid,
       if (sl->m_rasterizePli)
         sl->touchFrame(fid);
       sl->setDirtyFlag(true);
-      if (sl->getType() & TXshLevelType::RASTER_TYPE)
+      if (sl->getType() & TXshLevelType::RASTER_TYPE) {
         TAutocloser::invalidateSegmentCache(sl->getImageId(fid, 0));
+        FillRegionMap::invalidate(sl->getImageId(fid, 0));
+      }
     }
   }
   m_application->getCurrentLevel()->notifyLevelChange();
@@ -1785,6 +1785,8 @@ FillToolOptionsBox::FillToolOptionsBox(QWidget *parent, TTool *tool,
       m_controls.value("Gap Close Distance:"));
   m_extendFill =
       dynamic_cast<ToolOptionCheckbox *>(m_controls.value("Extend Fill"));
+  m_regionMap =
+      dynamic_cast<ToolOptionCheckbox *>(m_controls.value("Region Map"));
 
   bool ret = connect(m_colorMode, SIGNAL(currentIndexChanged(int)), this,
                      SLOT(onColorModeChanged(int)));
@@ -1796,6 +1798,11 @@ FillToolOptionsBox::FillToolOptionsBox(QWidget *parent, TTool *tool,
                             SLOT(onMultiFrameModeToggled(bool)));
   ret      = ret && connect(m_closeGap, &ToolOptionCheckbox::toggled,
                             m_gapCloseDistance, &QWidget::setEnabled);
+  // The region map handles plain fills only
+  if (m_extendFill && m_regionMap)
+    ret = ret && connect(m_extendFill, &ToolOptionCheckbox::toggled, [this]() {
+            onColorModeChanged(m_colorMode->getProperty()->getIndex());
+          });
 
   assert(ret);
   onColorModeChanged(m_colorMode->getProperty()->getIndex());
@@ -1818,6 +1825,8 @@ void FillToolOptionsBox::onColorModeChanged(int index) {
   bool enabled                      = range[index] != L"Lines";
   m_emptyOnly->setEnabled(enabled);
   if (m_autopaintMode) m_autopaintMode->setEnabled(enabled);
+  if (m_regionMap)
+    m_regionMap->setEnabled(enabled && !m_extendFill->isChecked());
   if (m_fillDepthLabel && m_fillDepthField) {
     m_fillDepthLabel->setEnabled(enabled);
     m_fillDepthField->setEnabled(enabled);
@@ -35,6 +35,7 @@
 #include "toonz/txshchildlevel.h"
 #include "toonz/stage2.h"
 #include "toonz/autoclose.h"
+#include "toonz/fill.h"
 
 #include "toonzqt/tselectionhandle.h"
 #include "toonzqt/icongenerator.h"
@@ -651,6 +652,8 @@ void ToolUtils::TToolUndo::notifyImageChanged() const {
   }
   if(ToonzCheck::instance()->getChecks() & ToonzCheck::eAutoclose)
     TAutocloser::invalidateSegmentCache(m_level->getImageId(m_frameId));
+  if (m_level && m_level->getType() == TZP_XSHLEVEL)
+    FillRegionMap::invalidate(m_level->getImageId(m_frameId, 0));
 }
 
 //------------------------------------------------------------------------------------------
@@ -45,6 +45,7 @@
 // TnzCore includes
 #include "tsystem.h"
 #include "timagecache.h"
+#include "tprofiler.h"
 #include "tthread.h"
 
 // Qt includes
@@ -58,6 +59,7 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QMessageBox>
+#include <QFileDialog>
 #ifdef _WIN32
 #include <QtPlatformHeaders/QWindowsWindowFunctions>
 #endif
@@ -2387,6 +2389,11 @@ void MainWindow::defineActions() {
   createToggle(MI_ToggleViewerSubCameraPreview,
                QT_TR_NOOP("Toggle Viewer Sub-camera Preview"), "", false,
                MenuRenderCommandType, "subpreview");
+  menuAct = createToggle(MI_RecordRenderProfile,
+                         QT_TR_NOOP("&Record Render Profile"), "", false,
+                         MenuRenderCommandType);
+  connect(menuAct, SIGNAL(triggered(bool)), this,
+          SLOT(onRecordRenderProfileTriggered(bool)));
 
   createRightClickMenuAction(MI_OpenPltGizmo, QT_TR_NOOP("&Palette Gizmo"), "",
                              "palettegizmo");
@@ -3328,6 +3335,27 @@ void MainWindow::onInk1CheckTriggered(bool on) {
 
 //-----------------------------------------------------------------------------
 
+void MainWindow::onRecordRenderProfileTriggered(bool on) {
+  TProfiler *profiler = TProfiler::instance();
+  if (on) {
+    profiler->start();
+    return;
+  }
+
+  profiler->stop();
+
+  QString path = QFileDialog::getSaveFileName(
+      this, tr("Save Render Profile"),
+      ToonzFolder::getCacheRootFolder().getQString() + "/render_profile.json",
+      tr("Chrome Trace (*.json)"));
+  if (path.isEmpty()) return;
+
+  if (!profiler->exportChromeTrace(TFilePath(path)))
+    DVGui::warning(tr("Unable to write the render profile to %1").arg(path));
+}
+
+//-----------------------------------------------------------------------------
+
 void MainWindow::onNewVectorLevelButtonPressed() {
   int defaultLevelType = Preferences::instance()->getDefLevelType();
   Preferences::instance()->setValue(DefLevelType, PLI_XSHLEVEL);
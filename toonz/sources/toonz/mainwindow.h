@@ -237,6 +237,8 @@ protected slots:
   void onInkCheckTriggered(bool on);
   void onInk1CheckTriggered(bool on);
 
+  void onRecordRenderProfileTriggered(bool on);
+
   void onUpdateCheckerDone(bool);
   void onActiveViewerChanged();
 
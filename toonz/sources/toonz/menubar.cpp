@@ -1407,6 +1407,8 @@ QMenuBar *StackedMenuBar::createFullMenuBar() {
   addMenuItem(renderMenu, MI_Render);
   renderMenu->addSeparator();
   addMenuItem(renderMenu, MI_FastRender);
+  renderMenu->addSeparator();
+  addMenuItem(renderMenu, MI_RecordRenderProfile);
 
   // Menu' VIEW
   QMenu *viewMenu = addMenu(tr("View"), fullMenuBar);
@@ -56,6 +56,7 @@
 #define MI_ClonePreview "MI_ClonePreview"
 #define MI_FreezePreview "MI_FrezzePreview"
 #define MI_SavePreviewedFrames "MI_SavePreviewedFrames"
+#define MI_RecordRenderProfile "MI_RecordRenderProfile"
 // #define MI_SavePreview         "MI_SavePreview"
 #define MI_ToggleViewerPreview "MI_ToggleViewerPreview"
 #define MI_ToggleViewerSubCameraPreview "MI_ToggleViewerSubCameraPreview"
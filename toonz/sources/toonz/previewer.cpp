@@ -108,6 +108,11 @@ QTimer levelChangedTimer, fxChangedTimer, xsheetChangedTimer,
     objectChangedTimer;
 const int notificationDelay = 300;
 
+// Frames whose preview rect spans at least this many pixels are first
+// rendered as a draft, at DraftShrink times the preview shrink
+const int DraftMinArea = 512 * 512;
+const int DraftShrink  = 4;
+
 //-------------------------------------------------------------------------
 
 void buildNodeTreeDescription(std::string &desc, const TFxP &root);
@@ -124,6 +129,14 @@ inline bool contains(const QRegion &region, const TRect &rect) {
   // Only do expensive operation if needed
   return QRegion(qrect).subtracted(region).isEmpty();
 }
+
+//-------------------------------------------------------------------------
+
+// Returns the draft raster pixels covering the passed preview raster pixels
+inline TRect toDraftRect(const TRect &rect) {
+  return TRect(rect.x0 / DraftShrink, rect.y0 / DraftShrink,
+               rect.x1 / DraftShrink, rect.y1 / DraftShrink);
+}
 }  // namespace
 
 //======================================================================================
@@ -143,8 +156,10 @@ public:
     unsigned long m_renderId;  // The render process Id - passed by TRenderer
     QRegion m_renderedRegion;  // The plane region already rendered for m_fx
     TRect m_rectUnderRender;   // Plane region currently under render
+    TRect m_targetRect;        // Plane region the render passes complete
+    bool m_draft;              // Whether the pass under render is a draft
 
-    FrameInfo() : m_renderId((unsigned long)-1) {}
+    FrameInfo() : m_renderId((unsigned long)-1), m_draft(false) {}
   };
 
 public:
@@ -166,6 +181,7 @@ public:
   bool m_subcamera;
 
   TRect m_previewRect;
+  TRect m_visibleRect;  // The part of m_previewRect shown by the listeners
 
   TRenderer m_renderer;
 
@@ -182,7 +198,10 @@ public:
   void notifyFailed(int frame);
   void notifyUpdate();
 
-  TFxPair buildSceneFx(int frame);
+  TFxPair buildSceneFx(int frame, int shrink);
+
+  TRect toPreviewPixels(TRectD rect) const;
+  TRectD toRenderArea(const TRect &rect, int shrink) const;
 
   // Updater methods. These refresh the manager's status, but do not launch new
   // renders
@@ -201,6 +220,10 @@ public:
   // Use this method to re-render the passed frame. Infos specified with the
   // update* methods are assumed correct.
   void refreshFrame(int frame);
+  // Launches the passed frame's next render pass toward its target rect: a
+  // draft of the whole rect if allowed, then the visible part, then the rest.
+  // Returns whether a pass was started.
+  bool renderNextPass(int frame, bool allowDraft);
 
   void addRenderData(std::vector<TRenderer::RenderData> &datas, int frame);
   void addFramesToRenderQueue(const std::vector<int> &frames);
@@ -278,7 +301,7 @@ Previewer::Imp::~Imp() {
 
 //-----------------------------------------------------------------------------
 
-TFxPair Previewer::Imp::buildSceneFx(int frame) {
+TFxPair Previewer::Imp::buildSceneFx(int frame, int shrink) {
   TFxPair fxPair;
 
   TApp *app         = TApp::instance();
@@ -287,22 +310,16 @@ TFxPair Previewer::Imp::buildSceneFx(int frame) {
   if (m_renderSettings.m_stereoscopic) {
     scene->shiftCameraX(-m_renderSettings.m_stereoscopicShift / 2.0);
     fxPair.m_frameA = ::buildSceneFx(
-        scene, xsh, frame, TOutputProperties::AllLevels,
-        m_renderSettings.m_applyShrinkToViewer ? m_renderSettings.m_shrinkX : 1,
-        false);
+        scene, xsh, frame, TOutputProperties::AllLevels, shrink, false);
 
     scene->shiftCameraX(m_renderSettings.m_stereoscopicShift);
     fxPair.m_frameB = ::buildSceneFx(
-        scene, xsh, frame, TOutputProperties::AllLevels,
-        m_renderSettings.m_applyShrinkToViewer ? m_renderSettings.m_shrinkX : 1,
-        false);
+        scene, xsh, frame, TOutputProperties::AllLevels, shrink, false);
 
     scene->shiftCameraX(-m_renderSettings.m_stereoscopicShift / 2.0);
   } else
     fxPair.m_frameA = ::buildSceneFx(
-        scene, xsh, frame, TOutputProperties::AllLevels,
-        m_renderSettings.m_applyShrinkToViewer ? m_renderSettings.m_shrinkX : 1,
-        false);
+        scene, xsh, frame, TOutputProperties::AllLevels, shrink, false);
 
   return fxPair;
 }
@@ -401,7 +418,8 @@ void Previewer::Imp::updateProgressBarStatus() {
     m_pbStatus[i] = (it == m_frames.end()) ? FlipSlider::PBFrameNotStarted
                     : ::contains(it->second.m_renderedRegion, m_previewRect)
                         ? FlipSlider::PBFrameFinished
-                    : it->second.m_rectUnderRender.contains(m_previewRect)
+                    : !it->second.m_rectUnderRender.isEmpty() &&
+                            it->second.m_targetRect.contains(m_previewRect)
                         ? FlipSlider::PBFrameStarted
                         : FlipSlider::PBFrameNotStarted;
   }
@@ -409,69 +427,80 @@ void Previewer::Imp::updateProgressBarStatus() {
 
 //-----------------------------------------------------------------------------
 
-void Previewer::Imp::updatePreviewRect() {
-  TRectD previewRectD;
-
-  /*--
-   * If it is not a SubCameraPreview, calculations are performed
-   * in full screen regardless of the Viewer display area.
-   * --*/
-  if (!m_subcamera) {
-    previewRectD = m_renderArea;
-  } else {
-    // Use range‑based for loop for clarity
-    for (auto *listener : m_listeners) {
-      previewRectD += listener->getPreviewRect();
-    }
-  }
-
-  // Intersection with render area
-  previewRectD *= m_renderArea;
-
-  // Cache local variables to avoid multiple pointer accesses
+//! Returns the preview raster pixels covering the passed rect, in camera
+//! reference.
+TRect Previewer::Imp::toPreviewPixels(TRectD rect) const {
   const int shrinkX    = m_renderSettings.m_shrinkX;
   const int shrinkY    = m_renderSettings.m_shrinkY;
   const TPointD camPos = m_cameraPos;
 
+  // Intersection with render area
+  rect *= m_renderArea;
+
   // Compute offset once
-  previewRectD -= camPos;
+  rect -= camPos;
 
   // Scale transformation (Shrink)
   if (shrinkX > 1) {
-    previewRectD.x0 /= shrinkX;
-    previewRectD.x1 /= shrinkX;
+    rect.x0 /= shrinkX;
+    rect.x1 /= shrinkX;
   }
   if (shrinkY > 1) {
-    previewRectD.y0 /= shrinkY;
-    previewRectD.y1 /= shrinkY;
+    rect.y0 /= shrinkY;
+    rect.y1 /= shrinkY;
   }
 
   // Coordinates relative to camera resolution
   TPointD shrinkedRelPos((m_renderArea.x0 - camPos.x) / shrinkX,
                          (m_renderArea.y0 - camPos.y) / shrinkY);
 
-  previewRectD -= shrinkedRelPos;
+  rect -= shrinkedRelPos;
+
+  return TRect(tfloor(rect.x0), tfloor(rect.y0), tceil(rect.x1) - 1,
+               tceil(rect.y1) - 1);
+}
+
+//-----------------------------------------------------------------------------
+
+//! Returns the render area producing the passed raster pixels, for a render
+//! at the specified shrink. Pixels are in preview raster coordinates divided
+//! by shrink / m_renderSettings.m_shrinkX.
+TRectD Previewer::Imp::toRenderArea(const TRect &rect, int shrink) const {
+  TPointD shrinkedRelPos((m_renderArea.x0 - m_cameraPos.x) / shrink,
+                         (m_renderArea.y0 - m_cameraPos.y) / shrink);
+
+  return TRectD(rect.x0, rect.y0, rect.x1 + 1, rect.y1 + 1) +
+         (m_cameraPos + shrinkedRelPos);
+}
+
+//-----------------------------------------------------------------------------
+
+void Previewer::Imp::updatePreviewRect() {
+  TRectD previewRectD, visibleRectD;
+
+  for (auto *listener : m_listeners) {
+    visibleRectD += listener->getPreviewRect();
+  }
 
-  // Direct rounding to int to avoid extra function calls
-  int x0 = tfloor(previewRectD.x0);
-  int y0 = tfloor(previewRectD.y0);
-  int x1 = tceil(previewRectD.x1);
-  int y1 = tceil(previewRectD.y1);
+  /*--
+   * If it is not a SubCameraPreview, calculations are performed
+   * in full screen regardless of the Viewer display area.
+   * --*/
+  previewRectD = m_subcamera ? visibleRectD : m_renderArea;
 
   // m_previewRect is the final pixel rectangle
-  m_previewRect = TRect(x0, y0, x1 - 1, y1 - 1);
+  m_previewRect = toPreviewPixels(previewRectD);
+  m_visibleRect = toPreviewPixels(visibleRectD) * m_previewRect;
 
   // Restore global coordinates for the renderer
-  previewRectD = TRectD(x0, y0, x1, y1) + (camPos + shrinkedRelPos);
-
-  setRenderArea(previewRectD);
+  setRenderArea(toRenderArea(m_previewRect, m_renderSettings.m_shrinkX));
 }
 
 //-----------------------------------------------------------------------------
 
 void Previewer::Imp::updateAliases() {
   for (auto &[frame, info] : m_frames) {
-    TFxPair fxPair = buildSceneFx(frame);
+    TFxPair fxPair = buildSceneFx(frame, m_renderSettings.m_shrinkX);
 
     std::string newAlias =
         fxPair.m_frameA ? fxPair.m_frameA->getAlias(frame, m_renderSettings)
@@ -481,8 +510,16 @@ void Previewer::Imp::updateAliases() {
                          : "");
 
     if (newAlias != info.m_alias) {
+      // Cancel the stale render passes. The cached image is still shown until
+      // the new passes replace it.
+      if (!info.m_rectUnderRender.isEmpty())
+        m_renderer.abortRendering(info.m_renderId);
+
       // Clear the remaining frame infos
-      info.m_renderedRegion = QRegion();
+      info.m_renderedRegion  = QRegion();
+      info.m_rectUnderRender = TRect();
+      info.m_targetRect      = TRect();
+      info.m_draft           = false;
     }
   }
 }
@@ -492,7 +529,7 @@ void Previewer::Imp::updateAliases() {
 void Previewer::Imp::updateAliasKeyword(const std::string &keyword) {
   for (auto &[frame, info] : m_frames) {
     if (info.m_alias.find(keyword) != std::string::npos) {
-      TFxPair fxPair = buildSceneFx(frame);
+      TFxPair fxPair = buildSceneFx(frame, m_renderSettings.m_shrinkX);
       info.m_alias   = fxPair.m_frameA
                            ? fxPair.m_frameA->getAlias(frame, m_renderSettings)
                            : "";
@@ -500,8 +537,15 @@ void Previewer::Imp::updateAliasKeyword(const std::string &keyword) {
           (fxPair.m_frameB ? fxPair.m_frameB->getAlias(frame, m_renderSettings)
                            : "");
 
+      // Cancel the stale render passes
+      if (!info.m_rectUnderRender.isEmpty())
+        m_renderer.abortRendering(info.m_renderId);
+
       // Clear the remaining frame infos
-      info.m_renderedRegion = QRegion();
+      info.m_renderedRegion  = QRegion();
+      info.m_rectUnderRender = TRect();
+      info.m_targetRect      = TRect();
+      info.m_draft           = false;
 
       // Release the cached image; eventually clear it
       TRasterImageP ri = TImageCache::instance()->get(
@@ -529,9 +573,11 @@ void Previewer::Imp::refreshFrame(int frame) {
     // region, quit
     if (::contains(it->second.m_renderedRegion, m_previewRect)) return;
 
-    // Then, check the m_previewRect against the frame's m_rectUnderRendering.
+    // Then, check the m_previewRect against the frame's render passes target.
     // Ensure that we're not re-launching the very same render.
-    if (it->second.m_rectUnderRender == m_previewRect) return;
+    if (!it->second.m_rectUnderRender.isEmpty() &&
+        it->second.m_targetRect == m_previewRect)
+      return;
 
     // Stop any frame's previously running render process
     m_renderer.abortRendering(it->second.m_renderId);
@@ -543,25 +589,76 @@ void Previewer::Imp::refreshFrame(int frame) {
     if (frame >= int(m_pbStatus.size())) m_pbStatus.resize(frame + 1);
   }
 
+  // Start the render passes. A draft is first rendered only when nothing is
+  // available yet - otherwise, the rendered region is already shown.
+  it->second.m_targetRect = m_previewRect;
+  renderNextPass(frame, true);
+}
+
+//-----------------------------------------------------------------------------
+
+bool Previewer::Imp::renderNextPass(int frame, bool allowDraft) {
+  if (suspendedRendering) return false;
+
+  FrameInfo &info = m_frames[frame];
+
+  QRegion remainingRegion =
+      QRegion(toQRect(info.m_targetRect)).subtracted(info.m_renderedRegion);
+  if (remainingRegion.isEmpty()) return false;
+
+  // Choose the pass rect
+  TRect passRect;
+
+  bool draft =
+      allowDraft && info.m_renderedRegion.isEmpty() &&
+      info.m_targetRect.getLx() * info.m_targetRect.getLy() >= DraftMinArea;
+  if (draft)
+    passRect = info.m_targetRect;
+  else {
+    QRegion visibleRegion = remainingRegion.intersected(toQRect(m_visibleRect));
+    passRect              = toTRect(visibleRegion.isEmpty()
+                                        ? *remainingRegion.begin()
+                                        : visibleRegion.boundingRect());
+  }
+
   // Build the TFxPair to be passed to TRenderer
-  TFxPair fxPair = buildSceneFx(frame);
+  TRenderSettings renderSettings(m_renderSettings);
+
+  TFxPair fxPair = buildSceneFx(frame, renderSettings.m_shrinkX);
 
   // Update the RenderInfos associated with frame
-  it->second.m_rectUnderRender = m_previewRect;
-  it->second.m_alias = fxPair.m_frameA->getAlias(frame, m_renderSettings);
+  info.m_rectUnderRender = passRect;
+  info.m_draft           = draft;
+  info.m_alias           = fxPair.m_frameA->getAlias(frame, m_renderSettings);
   if (fxPair.m_frameB)
-    it->second.m_alias += fxPair.m_frameB->getAlias(frame, m_renderSettings);
+    info.m_alias += fxPair.m_frameB->getAlias(frame, m_renderSettings);
+
+  TRect renderRect(passRect);
+  if (draft) {
+    renderSettings.m_shrinkX = renderSettings.m_shrinkY =
+        m_renderSettings.m_shrinkX * DraftShrink;
+
+    fxPair     = buildSceneFx(frame, renderSettings.m_shrinkX);
+    renderRect = ::toDraftRect(passRect);
+  }
 
   // Retrieve the renderId of the rendering instance
-  it->second.m_renderId = m_renderer.nextRenderId();
+  info.m_renderId = m_renderer.nextRenderId();
   std::string contextName("P");
   contextName += m_subcamera ? "SC" : "FU";
   contextName += std::to_string(frame);
-  TPassiveCacheManager::instance()->setContextName(it->second.m_renderId,
+  TPassiveCacheManager::instance()->setContextName(info.m_renderId,
                                                    contextName);
 
-  // Start the render
-  m_renderer.startRendering(frame, m_renderSettings, fxPair);
+  // Start the render. Passes of different frames may be queued together, so
+  // each one specifies its render area.
+  auto renderDatas = std::make_unique<std::vector<TRenderer::RenderData>>();
+  renderDatas->emplace_back(frame, renderSettings, fxPair);
+  renderDatas->back().m_renderArea =
+      toRenderArea(renderRect, renderSettings.m_shrinkX);
+
+  m_renderer.startRendering(renderDatas.release());
+  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -712,7 +809,15 @@ void Previewer::Imp::doOnRenderRasterCompleted(const RenderData &renderData) {
   cachedRas = cachedRas->extract(rectUnderRender);
 
   if (cachedRas) {
-    cachedRas->copy(ras);
+    if (it->second.m_draft) {
+      // Drafts are upscaled over the whole pass rect
+      TRect draftRect(::toDraftRect(it->second.m_rectUnderRender));
+      TPointD draftPos(DraftShrink * draftRect.x0 - rectUnderRender.x0,
+                       DraftShrink * draftRect.y0 - rectUnderRender.y0);
+      TRop::resample(cachedRas, ras,
+                     TTranslation(draftPos) * TScale(DraftShrink));
+    } else
+      cachedRas->copy(ras);
   }
 
   // Submit the image to the cache, for all cluster's frames
@@ -725,12 +830,21 @@ void Previewer::Imp::doOnRenderRasterCompleted(const RenderData &renderData) {
       TImageCache::instance()->add(f_str, ri);
     }
 
-    // Update the FrameInfo
-    f_it->second.m_renderedRegion += toQRect(f_it->second.m_rectUnderRender);
-    f_it->second.m_rectUnderRender = TRect();
+    // Update the FrameInfo. Drafts are replaced by the following passes.
+    FrameInfo &info = f_it->second;
+    if (!info.m_draft) info.m_renderedRegion += toQRect(info.m_rectUnderRender);
+    info.m_rectUnderRender = TRect();
+    info.m_draft           = false;
+
+    // Launch the frame's next render pass, if any
+    bool finished = ::contains(info.m_renderedRegion, info.m_targetRect);
+    bool started  = !finished && renderNextPass(f, false);
 
     // Update the progress bar status
-    if (f < int(m_pbStatus.size())) m_pbStatus[f] = FlipSlider::PBFrameFinished;
+    if (f < int(m_pbStatus.size()))
+      m_pbStatus[f] = finished  ? FlipSlider::PBFrameFinished
+                      : started ? FlipSlider::PBFrameStarted
+                                : FlipSlider::PBFrameNotStarted;
 
     // Notify listeners
     notifyCompleted(f);
@@ -761,6 +875,8 @@ void Previewer::Imp::doOnRenderRasterFailed(const RenderData &renderData) {
 
   it->second.m_renderedRegion  = QRegion();
   it->second.m_rectUnderRender = TRect();
+  it->second.m_targetRect      = TRect();
+  it->second.m_draft           = false;
 
   // Update the progress bar status
   if (frame < int(m_pbStatus.size()))
@@ -1001,10 +1117,13 @@ void Previewer::Imp::saveFrame() {
 void Previewer::Imp::addRenderData(std::vector<TRenderer::RenderData> &datas,
                                    int frame) {
   // Build the TFxPair to be passed to TRenderer
-  TFxPair fxPair = buildSceneFx(frame);
+  TFxPair fxPair = buildSceneFx(frame, m_renderSettings.m_shrinkX);
 
-  // Update the RenderInfos associated with frame
+  // Update the RenderInfos associated with frame. Queued frames are rendered
+  // in a single pass.
   m_frames[frame].m_rectUnderRender = m_previewRect;
+  m_frames[frame].m_targetRect      = m_previewRect;
+  m_frames[frame].m_draft           = false;
   m_frames[frame].m_alias = fxPair.m_frameA->getAlias(frame, m_renderSettings);
   if (fxPair.m_frameB)
     m_frames[frame].m_alias +=
@@ -1019,6 +1138,8 @@ void Previewer::Imp::addRenderData(std::vector<TRenderer::RenderData> &datas,
                                                    contextName);
 
   datas.emplace_back(frame, m_renderSettings, fxPair);
+  datas.back().m_renderArea =
+      toRenderArea(m_previewRect, m_renderSettings.m_shrinkX);
 }
 
 //-----------------------------------------------------------------------------
@@ -1045,9 +1166,11 @@ void Previewer::Imp::addFramesToRenderQueue(const std::vector<int> &frames) {
       // In case the rect we would render is contained in the frame's rendered
       // region, skip this frame
       if (::contains(it->second.m_renderedRegion, m_previewRect)) continue;
-      // Then, check the m_previewRect against the frame's m_rectUnderRendering.
-      // Ensure that we're not re-launching the very same render.
-      if (it->second.m_rectUnderRender == m_previewRect) continue;
+      // Then, check the m_previewRect against the frame's render passes
+      // target. Ensure that we're not re-launching the very same render.
+      if (!it->second.m_rectUnderRender.isEmpty() &&
+          it->second.m_targetRect == m_previewRect)
+        continue;
       // Stop any frame's previously running render process
       m_renderer.abortRendering(it->second.m_renderId);
       addRenderData(*renderDatas, f);
@@ -979,6 +979,10 @@ void PreviewFxInstance::startRender(bool rebuild) {
   contextName += std::to_string(m_fx->getIdentifier());
   TPassiveCacheManager::instance()->setContextName(renderId, contextName);
 
+  // Keep the node results of the frame shown in the flipbooks, so that a
+  // following param change recomputes only the changed branch
+  TPassiveCacheManager::instance()->enableBranchCache(renderId, m_initFrame);
+
   // Finally, start rendering all frames which were not found in cache
   m_renderer.startRendering(renderDatas);
 }
@@ -1469,6 +1473,9 @@ void PreviewFxManager::onLevelChanged() {
     TFilePath fp = xl->getPath();
     aliasKeyword = ::to_string(fp.withType(""));
 
+    // Release the node results built on the level
+    TPassiveCacheManager::instance()->invalidateLevel(aliasKeyword);
+
     QMap<unsigned long, PreviewFxInstance *>::iterator it;
     for (it = m_previewInstances.begin(); it != m_previewInstances.end();
          ++it) {
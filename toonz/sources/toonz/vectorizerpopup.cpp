@@ -66,6 +66,10 @@
 #include <QMainWindow>
 #include <QToolButton>
 
+// STD includes
+#include <deque>
+#include <memory>
+
 using namespace DVGui;
 using namespace SelectionUtils;
 
@@ -170,6 +174,48 @@ void replaceMyPaintBrushStyles(TPalette *palette) {
 
 }  // namespace
 
+//*****************************************************************************
+//    Vectorizer::FrameJob definition
+//*****************************************************************************
+
+class Vectorizer::FrameJob final : public QThread {
+public:
+  Vectorizer *m_vectorizer;
+  TFrameId m_fid;
+  TImageP m_img;
+
+  CenterlineConfiguration m_cConf;
+  NewOutlineConfiguration m_oConf;
+  bool m_concurrent;
+
+  TVectorImageP m_vi;  //!< The vectorized frame, once done
+
+public:
+  FrameJob(Vectorizer *vectorizer, const TFrameId &fid, const TImageP &img,
+           const CenterlineConfiguration &cConf,
+           const NewOutlineConfiguration &oConf, bool concurrent)
+      : m_vectorizer(vectorizer)
+      , m_fid(fid)
+      , m_img(img)
+      , m_cConf(cConf)
+      , m_oConf(oConf)
+      , m_concurrent(concurrent) {}
+
+  const VectorizerConfiguration &configuration() const {
+    return m_vectorizer->m_params.m_isOutline
+               ? static_cast<const VectorizerConfiguration &>(m_oConf)
+               : static_cast<const VectorizerConfiguration &>(m_cConf);
+  }
+
+  void run() override {
+    TPalette *palette = m_vectorizer->m_vLevel->getPalette();
+
+    m_vi = m_vectorizer->doVectorize(m_img, palette, configuration(),
+                                     m_concurrent);
+    m_img = TImageP();  // Release the input image as soon as possible
+  }
+};
+
 //*****************************************************************************
 //    Vectorizer implementation
 //*****************************************************************************
@@ -188,15 +234,19 @@ Vectorizer::~Vectorizer() {
 //-----------------------------------------------------------------------------
 
 TVectorImageP Vectorizer::doVectorize(TImageP img, TPalette *palette,
-                                      const VectorizerConfiguration &conf) {
+                                      const VectorizerConfiguration &conf,
+                                      bool concurrent) {
   TToonzImageP ti  = img;
   TRasterImageP ri = img;
 
   if (!ti && !ri) return TVectorImageP();
 
   VectorizerCore vCore;
-  connect(&vCore, SIGNAL(partialDone(int, int)), this,
-          SIGNAL(partialDone(int, int)));
+  if (concurrent)
+    vCore.setMaxThreadsCount(1);  // Other threads deal with other frames
+  else
+    connect(&vCore, SIGNAL(partialDone(int, int)), this,
+            SIGNAL(partialDone(int, int)));
   connect(this, SIGNAL(transmitCancel()), &vCore, SLOT(onCancel()),
           Qt::DirectConnection);  // Direct connection *must* be
                                   // established for child cancels
@@ -316,60 +366,94 @@ int Vectorizer::doVectorize() {
   double frameRange[2] = {static_cast<double>(m_fids.front().getNumber()) - 1,
                           static_cast<double>(m_fids.back().getNumber()) - 1};
 
-  int count = 0;
-
-  std::vector<TFrameId>::const_iterator ft, fEnd = m_fids.end();
-  for (ft = m_fids.begin(); ft != fEnd; ++ft) {
-    // Retrieve the image to be vectorized
-    TImageP img;
-    if (sl->getType() == OVL_XSHLEVEL || sl->getType() == TZP_XSHLEVEL ||
-        sl->getType() == TZI_XSHLEVEL)
-      img = sl->getFullsampledFrame(*ft, ImageManager::dontPutInCache);
+  // Toonz raster levels only read their palette while being vectorized, so
+  // their frames are vectorized concurrently. Vectorizing other levels adds
+  // styles to the palette frame by frame instead - they are processed one at
+  // a time, in order, for the results to stay the same.
+  int threadsCount = 1;
+  if (sl->getType() == TZP_XSHLEVEL)
+    threadsCount =
+        std::max(1, std::min<int>(QThread::idealThreadCount(), m_fids.size()));
 
-    if (!img) continue;
+  bool concurrent = (threadsCount > 1);
 
-    // Build image-toonz coordinate transformation
-    TAffine dpiAff = getDpiAffine(sl, *ft, true);
-    double factor  = norm(dpiAff * TPointD(1, 0));
+  // Frames being vectorized, in frame order. They are at most as many as the
+  // threads, which bounds the memory taken by input images.
+  std::deque<std::unique_ptr<FrameJob>> jobs;
 
-    TPointD center;
-    if (TToonzImageP ti = img)
-      center = ti->getRaster()->getCenterD();
-    else if (TRasterImageP ri = img)
-      center = ri->getRaster()->getCenterD();
+  int count = 0;
 
-    // Build vectorizer configuration
-    double weight = (ft->getNumber() - 1 - frameRange[0]) /
-                    std::max(frameRange[1] - frameRange[0], 1.0);
-    weight = tcrop(weight, 0.0, 1.0);
+  std::vector<TFrameId>::const_iterator ft = m_fids.begin(),
+                                        fEnd = m_fids.end();
+  for (;;) {
+    // Start vectorizing frames until all threads are busy. Stop if canceled.
+    for (; ft != fEnd && int(jobs.size()) < threadsCount && !m_isCanceled;
+         ++ft) {
+      // Retrieve the image to be vectorized
+      TImageP img;
+      if (sl->getType() == OVL_XSHLEVEL || sl->getType() == TZP_XSHLEVEL ||
+          sl->getType() == TZI_XSHLEVEL)
+        img = sl->getFullsampledFrame(*ft, ImageManager::dontPutInCache);
+
+      if (!img) continue;
+
+      // Build image-toonz coordinate transformation
+      TAffine dpiAff = getDpiAffine(sl, *ft, true);
+      double factor  = norm(dpiAff * TPointD(1, 0));
+
+      TPointD center;
+      if (TToonzImageP ti = img)
+        center = ti->getRaster()->getCenterD();
+      else if (TRasterImageP ri = img)
+        center = ri->getRaster()->getCenterD();
+
+      // Build vectorizer configuration
+      double weight = (ft->getNumber() - 1 - frameRange[0]) /
+                      std::max(frameRange[1] - frameRange[0], 1.0);
+      weight = tcrop(weight, 0.0, 1.0);
+
+      locals.updateConfig(weight);  // TEMPORARY
+
+      configuration.m_affine     = dpiAff * TTranslation(-center);
+      configuration.m_thickScale = factor;
+
+      // Build vectorization label to be displayed
+      QString labelName = QString::fromStdWString(sl->getShortName());
+      labelName.push_back(' ');
+      labelName.append(QString::fromStdString(ft->expand(TFrameId::NO_PAD)));
+
+      emit frameName(labelName);
+
+      // Perform vectorization
+      std::unique_ptr<FrameJob> job(new FrameJob(
+          this, *ft, img, locals.m_cConf, locals.m_oConf, concurrent));
+
+      if (concurrent)
+        job->start();
+      else
+        job->run();
 
-    locals.updateConfig(weight);  // TEMPORARY
+      jobs.push_back(std::move(job));
+    }
 
-    configuration.m_affine     = dpiAff * TTranslation(-center);
-    configuration.m_thickScale = factor;
+    if (jobs.empty()) break;
 
-    // Build vectorization label to be displayed
-    QString labelName = QString::fromStdWString(sl->getShortName());
-    labelName.push_back(' ');
-    labelName.append(QString::fromStdString(ft->expand(TFrameId::NO_PAD)));
+    // Store the first frame in order, once done
+    std::unique_ptr<FrameJob> job(std::move(jobs.front()));
+    jobs.pop_front();
 
-    emit frameName(labelName);
+    job->wait();
 
-    // Perform vectorization
-    if (TVectorImageP vi =
-            doVectorize(img, m_vLevel->getPalette(), configuration)) {
-      TFrameId fid = *ft;
+    if (TVectorImageP vi = job->m_vi) {
+      TFrameId fid = job->m_fid;
 
-      if (fid.getNumber() < 0) fid = TFrameId(1, ft->getLetter());
+      if (fid.getNumber() < 0) fid = TFrameId(1, job->m_fid.getLetter());
 
       m_vLevel->setFrame(fid, vi);
       vi->setPalette(m_vLevel->getPalette());
 
       emit frameDone(++count);
     }
-
-    // Stop if canceled
-    if (m_isCanceled) break;
   }
 
   m_dialogShown = false;
@@ -332,12 +332,16 @@ private:
                       //! vectorization.
 
 private:
+  class FrameJob;  //!< Vectorization of a single frame on a separate thread.
+
   int doVectorize();  //!< Start vectorization of input frames.
 
   //! Makes connections to low-level partial progress signals and cancel slots,
-  //! and invokes the low-level vectorization of \b img.
+  //! and invokes the low-level vectorization of \b img. Partial progress is
+  //! not forwarded when frames are vectorized concurrently.
   TVectorImageP doVectorize(TImageP img, TPalette *palette,
-                            const VectorizerConfiguration &conf);
+                            const VectorizerConfiguration &conf,
+                            bool concurrent = false);
 };
 
 #endif  // VECTORIZERPOPUP_H
@@ -24,6 +24,7 @@ using namespace TVER;
 
 #include <sstream>
 #include <string>
+#include <algorithm>
 using namespace std;
 
 #ifndef _WIN32
@@ -217,6 +218,8 @@ public:
     m_serverId    = rhs.m_serverId;
     m_subTasks    = rhs.m_subTasks;
     m_toBeDeleted = rhs.m_toBeDeleted;
+    m_frameTimes  = rhs.m_frameTimes;
+    m_serverTimes = rhs.m_serverTimes;
   }
 
   // TPersist implementation
@@ -231,6 +234,11 @@ public:
   int m_failureCount;
 
   vector<QString> m_failedOnServers;
+
+  // Render times measured on the job, see FarmController::splitChunk()
+  QDateTime m_progressDate;  // Last frame completed by the running subtask
+  map<int, int> m_frameTimes;                  // Frame -> ms
+  map<QString, pair<int, int>> m_serverTimes;  // Server -> ms, frames count
 };
 
 namespace {
@@ -659,6 +667,11 @@ public:
 
   void startTask(CtrlFarmTask *task, FarmServerProxy *server);
 
+  // cuts the waiting subtask of job to be started on server, moving its
+  // trailing frames to a new waiting subtask
+  void splitChunk(CtrlFarmTask *task, CtrlFarmTask *job,
+                  FarmServerProxy *server);
+
   CtrlFarmTask *getTaskToStart(FarmServerProxy *server = 0);
   CtrlFarmTask *getNextTaskToStart(CtrlFarmTask *task, FarmServerProxy *server);
 
@@ -1119,6 +1132,9 @@ void FarmController::startTask(CtrlFarmTask *task, FarmServerProxy *server) {
     }
   }
 
+  if (taskToBeSubmittedParent)
+    splitChunk(taskToBeSubmitted, taskToBeSubmittedParent, server);
+
   int rc = 0;
   try {
     server->addTask(taskToBeSubmitted);
@@ -1149,6 +1165,143 @@ void FarmController::startTask(CtrlFarmTask *task, FarmServerProxy *server) {
 
 //------------------------------------------------------------------------------
 
+namespace {
+
+// Estimates the render time of a frame, interpolating the nearest measured
+// frames: heavy frames are usually clustered.
+double estimateFrameTime(const CtrlFarmTask *job, int frame) {
+  const map<int, int> &times = job->m_frameTimes;
+  assert(!times.empty());
+
+  map<int, int>::const_iterator next = times.lower_bound(frame);
+  if (next == times.end()) return (--next)->second;
+  if (next->first == frame || next == times.begin()) return next->second;
+
+  map<int, int>::const_iterator prev = std::prev(next);
+  return prev->second + (next->second - prev->second) *
+                            (frame - prev->first) /
+                            double(next->first - prev->first);
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the speed of a server relative to the mean of the servers that
+// rendered the job
+double getServerSpeed(const CtrlFarmTask *job, const QString &serverId) {
+  map<QString, pair<int, int>>::const_iterator it =
+      job->m_serverTimes.find(serverId);
+  if (it == job->m_serverTimes.end() || it->second.first <= 0) return 1.0;
+
+  double serverTime = it->second.first / double(it->second.second);
+
+  double time = 0, count = 0;
+  for (it = job->m_serverTimes.begin(); it != job->m_serverTimes.end(); ++it)
+    time += it->second.first, count += it->second.second;
+
+  return tcrop((time / count) / serverTime, 0.25, 4.0);
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the name of a job chunk, as given on submission
+QString getChunkName(const CtrlFarmTask *job, int from, int to) {
+  return job->m_name + " " +
+         QString("%1-%2")
+             .arg(from, 2, 10, QChar('0'))
+             .arg(to, 2, 10, QChar('0'));
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+
+/*
+  Job chunks are sized on submission, regardless of the cost of their frames.
+  Once some frames of the job have been rendered, each chunk about to start
+  is cut so that its estimated render time is at most the remaining work of
+  the job, per server, halved (guided self-scheduling), and scaled by the
+  server's speed. Chunks shrink as the job nears its end: its heaviest frames
+  are spread among the servers, and no server is left with a long chunk
+  while the others go idle.
+*/
+
+void FarmController::splitChunk(CtrlFarmTask *task, CtrlFarmTask *job,
+                                FarmServerProxy *server) {
+  if (!task->m_isComposerTask || job->m_frameTimes.empty() ||
+      task->m_from >= task->m_to)
+    return;
+
+  int step = std::max(task->m_step, 1);
+
+  // Estimate the remaining work
+  double remainingTime = 0;
+  int lastSubId        = 0;
+
+  vector<QString>::iterator itSubTaskId = job->m_subTasks.begin();
+  for (; itSubTaskId != job->m_subTasks.end(); ++itSubTaskId) {
+    lastSubId = std::max(
+        lastSubId, itSubTaskId->mid(itSubTaskId->indexOf(".") + 1).toInt());
+
+    map<TaskId, CtrlFarmTask *>::iterator itSubTask =
+        m_tasks.find(TaskId(*itSubTaskId));
+    if (itSubTask == m_tasks.end()) continue;
+
+    CtrlFarmTask *subTask = itSubTask->second;
+    if (subTask == task || subTask->m_status == Waiting)
+      for (int f = subTask->m_from; f <= subTask->m_to; f += step)
+        remainingTime += estimateFrameTime(job, f);
+  }
+
+  int serversCount = 0;
+  map<QString, FarmServerProxy *>::iterator itServer = m_servers.begin();
+  for (; itServer != m_servers.end(); ++itServer)
+    if (itServer->second->m_attached && !itServer->second->m_offline)
+      ++serversCount;
+
+  double chunkTime = getServerSpeed(job, server->getId()) * remainingTime /
+                     (2 * std::max(serversCount, 1));
+
+  // Cut the chunk after its last frame fitting chunkTime - the first frame
+  // is always kept
+  int to      = task->m_from;
+  double time = estimateFrameTime(job, to);
+  while (to + step <= task->m_to) {
+    time += estimateFrameTime(job, to + step);
+    if (time > chunkTime) break;
+    to += step;
+  }
+
+  int tailFrom = to + step;
+  if (tailFrom > task->m_to) return;
+
+  QString tailId     = job->m_id + "." + QString::number(lastSubId + 1);
+  CtrlFarmTask *tail = new CtrlFarmTask(
+      tailId, getChunkName(job, tailFrom, task->m_to), task->getCommandLine(),
+      task->m_user, task->m_hostName, task->m_to - tailFrom + 1,
+      task->m_priority);
+  tail->m_submissionDate = task->m_submissionDate;
+  tail->m_parentId       = job->m_id;
+  tail->m_platform       = task->m_platform;
+  tail->m_from           = tailFrom;
+  if (task->m_dependencies) *tail->m_dependencies = *task->m_dependencies;
+
+  task->m_to        = tailFrom - 1;
+  task->m_stepCount = task->m_to - task->m_from + 1;
+  task->m_name      = getChunkName(job, task->m_from, task->m_to);
+
+  m_tasks.insert(std::make_pair(TaskId(tailId), tail));
+  itSubTaskId =
+      std::find(job->m_subTasks.begin(), job->m_subTasks.end(), task->m_id);
+  job->m_subTasks.insert(itSubTaskId + 1, tailId);
+
+  m_userLog->info("Task " + task->m_id + " split: frames " +
+                  QString::number(tailFrom) + "-" +
+                  QString::number(tail->m_to) + " moved to task " + tailId +
+                  "\n");
+}
+
+//------------------------------------------------------------------------------
+
 CtrlFarmTask *FarmController::getTaskToStart(FarmServerProxy *server) {
   QMutexLocker sl(&m_mutex);
 
@@ -1820,9 +1973,12 @@ void FarmController::taskSubmissionError(const QString &taskId, int errCode) {
 void FarmController::taskProgress(const QString &taskId, int step,
                                   int stepCount, int frameNumber,
                                   FrameState state) {
+  QMutexLocker sl(&m_mutex);
+
   map<TaskId, CtrlFarmTask *>::iterator itTask = m_tasks.find(TaskId(taskId));
   if (itTask != m_tasks.end()) {
     CtrlFarmTask *task = itTask->second;
+    CtrlFarmTask *job  = task;
     if (state == FrameDone)
       ++task->m_successfullSteps;
     else
@@ -1836,7 +1992,24 @@ void FarmController::taskProgress(const QString &taskId, int step,
         ++parentTask->m_successfullSteps;
       else
         ++parentTask->m_failedSteps;
+
+      job = parentTask;
+    }
+
+    // Measure the frame as the time elapsed since the previous frame of the
+    // run. The first frame of a run also counts the task startup, and is
+    // skipped.
+    QDateTime now = QDateTime::currentDateTime();
+    if (state == FrameDone && task->m_progressDate.isValid() &&
+        task->m_progressDate >= task->m_startDate) {
+      int time                       = task->m_progressDate.msecsTo(now);
+      job->m_frameTimes[frameNumber] = time;
+
+      pair<int, int> &serverTime = job->m_serverTimes[task->m_serverId];
+      serverTime.first += time;
+      ++serverTime.second;
     }
+    task->m_progressDate = now;
   }
 }
 
@@ -21,6 +21,10 @@ using namespace TVER;
 #include <QProcess>
 #include <QCoreApplication>
 #include <QEventLoop>
+#include <QThread>
+#include <QLocalSocket>
+#include <QElapsedTimer>
+#include <QRegularExpression>
 
 #include "tthread.h"
 
@@ -47,6 +51,7 @@ using namespace TVER;
 
 // forward declaration
 class FarmServer;
+class ComposerWorker;
 
 //-------------------------------------------------------------------
 
@@ -318,6 +323,14 @@ public:
   // class specific methods
   void removeTask(const QString &id);
 
+  /*!
+    Renders a tcomposer task on the resident worker whose scene and options
+    match the task's, starting a new one if needed. Returns false if the task
+    could not be rendered by a worker, and must be run in its own process.
+  */
+  bool renderOnWorker(const QString &id, const QString &prgName,
+                      const QString &args, int &exitCode);
+
 private:
   TThread::Executor *m_executor;
 
@@ -329,6 +342,13 @@ private:
 
   TUserLog *m_userLog;
 
+  // Tasks run one at a time, so a single worker is kept. Its process and
+  // socket are only usable from the thread they were created in: they live
+  // in m_workersThread, and are accessed through m_workersContext.
+  QThread m_workersThread;
+  QObject *m_workersContext;
+  ComposerWorker *m_worker;
+
 public:
   // vector<TFilePath> m_appPaths;
 
@@ -371,6 +391,141 @@ private:
   Task &operator=(const Task &);
 };
 
+//===================================================================
+//===================================================================
+//
+// class ComposerWorker
+//
+//===================================================================
+//===================================================================
+
+// Time a worker may take for each frame of a range, in ms
+const int WorkerFrameTimeout = 30 * 60 * 1000;
+
+/*!
+  A tcomposer process started in worker mode (-worker qualifier). It keeps
+  its scene loaded, and renders the frame ranges requested over a local
+  socket, reporting the completion time of each frame.
+*/
+class ComposerWorker {
+public:
+  ComposerWorker(const QString &key, TUserLog *log) : m_key(key), m_log(log) {}
+  ~ComposerWorker();
+
+  //! Returns the tcomposer command line, without range and task id, and the
+  //! modification time of its scene.
+  const QString &getKey() const { return m_key; }
+
+  bool start(const QString &prgName, const QString &args);
+
+  /*!
+    Renders the specified range of frames (1-based, as tcomposer's -range).
+    Returns false if the worker could not render it - eg, it crashed, hung,
+    or its scene was modified since it was loaded.
+  */
+  bool render(const QString &id, int r0, int r1, int &completedCount,
+              int &totalCount);
+
+private:
+  QString m_key;
+  TUserLog *m_log;
+
+  QProcess m_process;
+  QLocalSocket m_socket;
+
+private:
+  // not implemented
+  ComposerWorker(const ComposerWorker &);
+  ComposerWorker &operator=(const ComposerWorker &);
+};
+
+//------------------------------------------------------------------------------
+
+ComposerWorker::~ComposerWorker() {
+  if (m_socket.state() == QLocalSocket::ConnectedState) {
+    m_socket.write("quit\n");
+    m_socket.flush();
+    m_socket.disconnectFromServer();
+  }
+
+  if (m_process.state() != QProcess::NotRunning &&
+      !m_process.waitForFinished(10000)) {
+    m_process.kill();
+    m_process.waitForFinished(-1);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+bool ComposerWorker::start(const QString &prgName, const QString &args) {
+  static int workersCount = 0;  // Accessed by the workers thread only
+
+  QString serverName = QString("tfarmserver_%1_%2")
+                           .arg(QCoreApplication::applicationPid())
+                           .arg(++workersCount);
+  QString workerArgs = args + " -worker " + serverName;
+
+  // The worker outlives tasks: don't buffer its output
+  m_process.setStandardOutputFile(QProcess::nullDevice());
+  m_process.setStandardErrorFile(QProcess::nullDevice());
+  m_process.setProgram(prgName);
+#if defined(_WIN32)
+  m_process.setNativeArguments(workerArgs);
+#else
+  m_process.setArguments(workerArgs.split(" ", Qt::SkipEmptyParts));
+#endif
+  m_process.start();
+  if (!m_process.waitForStarted(-1)) return false;
+
+  // The worker serves once its scene is loaded
+  while (m_process.state() == QProcess::Running) {
+    m_socket.connectToServer(serverName);
+    if (m_socket.waitForConnected(500)) return true;
+    m_process.waitForFinished(500);
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
+bool ComposerWorker::render(const QString &id, int r0, int r1,
+                            int &completedCount, int &totalCount) {
+  QString request = QString("render %1 %2 %3\n").arg(r0).arg(r1).arg(id);
+  if (m_socket.write(request.toUtf8()) < 0) return false;
+  m_socket.flush();
+
+  // A worker that doesn't answer in time is considered hung, and killed
+  qint64 timeout = (qint64)WorkerFrameTimeout * (r1 - r0 + 1);
+  QElapsedTimer timer;
+  timer.start();
+
+  for (;;) {
+    while (!m_socket.canReadLine()) {
+      if (m_socket.state() != QLocalSocket::ConnectedState) return false;
+      if (timer.hasExpired(timeout)) {
+        m_log->error("tcomposer worker not responding: killed\n");
+        m_process.kill();
+        m_process.waitForFinished(-1);
+        return false;
+      }
+      m_socket.waitForReadyRead(1000);
+    }
+
+    QStringList reply =
+        QString::fromUtf8(m_socket.readLine()).simplified().split(' ');
+    if (reply[0] == "frame" && reply.size() == 3)
+      m_log->info("Frame " + reply[1] + " completed after " + reply[2] +
+                  " ms\n");
+    else if (reply[0] == "done" && reply.size() == 3) {
+      completedCount = reply[1].toInt();
+      totalCount     = reply[2].toInt();
+      return true;
+    } else
+      return false;
+  }
+}
+
 //-------------------------------------------------------------------
 static QString getExeName(bool isComposer) {
   QString name = isComposer ? "tcomposer" : "tcleanup";
@@ -473,6 +628,27 @@ void Task::run() {
     argsStr = cmdline.right(cmdline.size() - sepPos - 1);
   }
 
+  int exitCode;
+  if (prgName.contains("tcomposer") &&
+      m_server->renderOnWorker(m_id, prgName, argsStr, exitCode)) {
+    if (exitCode != 0) {
+      QString logMsg("Task aborted ");
+      logMsg += "\n\n";
+      m_log->warning(logMsg);
+      m_controller->taskSubmissionError(m_id, exitCode);
+    } else {
+      logMsg = "Task completed at ";
+      logMsg += QDateTime::currentDateTime().toString();
+      logMsg += "\n\n";
+
+      m_log->info(logMsg);
+      m_controller->taskCompleted(m_id, exitCode);
+    }
+
+    m_server->removeTask(m_id);
+    return;
+  }
+
   QProcess process;
   process.setProgram(prgName);
 #if defined(_WIN32)
@@ -483,7 +659,7 @@ void Task::run() {
   process.start();
   process.waitForFinished(-1);
 
-  int exitCode  = process.exitCode();
+  exitCode      = process.exitCode();
   int errorCode = process.error();
   bool ret      = (errorCode != QProcess::UnknownError) || exitCode;
 
@@ -518,16 +694,32 @@ void Task::run() {
 //==============================================================================
 
 FarmServer::FarmServer(int port, TUserLog *log)
-    : TFarmExecutor(port), m_controller(), m_userLog(log) {
+    : TFarmExecutor(port)
+    , m_controller()
+    , m_userLog(log)
+    , m_workersContext(new QObject)
+    , m_worker(0) {
   TFarmServer::HwInfo hwInfo;
   queryHwInfo(hwInfo);
   m_executor = new TThread::Executor;
   m_executor->setMaxActiveTasks(1);
+
+  m_workersContext->moveToThread(&m_workersThread);
+  m_workersThread.start();
 }
 
 //------------------------------------------------------------------------------
 
-FarmServer::~FarmServer() { delete m_executor; }
+FarmServer::~FarmServer() {
+  delete m_executor;
+
+  QMetaObject::invokeMethod(
+      m_workersContext, [this]() { delete m_worker; },
+      Qt::BlockingQueuedConnection);
+  m_workersThread.quit();
+  m_workersThread.wait();
+  delete m_workersContext;
+}
 
 //------------------------------------------------------------------------------
 QString FarmServer::execute(const std::vector<QString> &argv) {
@@ -703,6 +895,72 @@ void FarmServer::removeTask(const QString &id) {
   if (it != m_tasks.end()) m_tasks.erase(it);
 }
 
+//------------------------------------------------------------------------------
+
+bool FarmServer::renderOnWorker(const QString &id, const QString &prgName,
+                                const QString &args, int &exitCode) {
+  static const QRegularExpression rangeExp(" -range (\\d+) (\\d+)");
+  static const QRegularExpression idExp(" -id \\S+");
+  static const QRegularExpression sceneExp("^\\s*\"([^\"]+)\"");
+
+  QRegularExpressionMatch range = rangeExp.match(args);
+  if (!range.hasMatch()) return false;
+
+  int r0 = range.captured(1).toInt(), r1 = range.captured(2).toInt();
+
+  // Tasks differing only by range and id share the same worker, as long as
+  // their scene file is not modified
+  QString workerArgs = args;
+  workerArgs.remove(rangeExp).remove(idExp);
+  QString key = prgName + " " + workerArgs;
+
+  QRegularExpressionMatch scene = sceneExp.match(args);
+  if (scene.hasMatch()) {
+    TFilePath scenePath(scene.captured(1).toStdWString());
+    key += " " + TFileStatus(scenePath)
+                     .getLastModificationTime()
+                     .toString(Qt::ISODateWithMs);
+  }
+
+  bool rendered = false;
+  QMetaObject::invokeMethod(
+      m_workersContext,
+      [&]() {
+        // A stale worker is replaced once, then the task runs in its own
+        // process
+        for (int attempt = 0; attempt < 2 && !rendered; ++attempt) {
+          bool isNew = false;
+          if (m_worker && m_worker->getKey() != key) {
+            delete m_worker;
+            m_worker = 0;
+          }
+          if (!m_worker) {
+            m_userLog->info("Starting tcomposer worker\n");
+            m_worker = new ComposerWorker(key, m_userLog);
+            isNew    = true;
+            if (!m_worker->start(prgName, workerArgs)) {
+              delete m_worker;
+              m_worker = 0;
+              return;
+            }
+          }
+
+          int completedCount, totalCount;
+          if (m_worker->render(id, r0, r1, completedCount, totalCount)) {
+            exitCode = (completedCount == totalCount) ? 0 : -1;
+            rendered = true;
+          } else {
+            delete m_worker;
+            m_worker = 0;
+            if (isNew) return;
+          }
+        }
+      },
+      Qt::BlockingQueuedConnection);
+
+  return rendered;
+}
+
 //==============================================================================
 
 namespace {
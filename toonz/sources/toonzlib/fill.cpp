@@ -1,5 +1,6 @@
 
 
+#include <algorithm>
 #include <stack>
 #include "toonz/fill.h"
 #include "toonz/ttilesaver.h"
@@ -1018,22 +1019,104 @@ int getMostFrequentNeighborStyleId(TRasterCM32P ras,
   return maxStyleId;
 }
 //-----------------------------------------------------------------------------
+/*! Runs the scanline flood fill on the rows adjacent to the given seeds.
+    If \b reachedPurePaint is specified, it is set to true whenever a row
+    painted by the flood contains pure paint pixels.
+*/
+void fillSeeds(const TRasterCM32P &r, std::stack<FillSeed> &seeds,
+               const FillParameters &params, int paint, int paintAtClickedPos,
+               int fillDepth, TTileSaverCM32 *saver,
+               bool *reachedPurePaint = nullptr) {
+  TPixelCM32 *pix, *limit, *oldpix;
+  int oldy, x, y, xa, xb, xc, xd, dy;
+  int oldxc, oldxd;
+  int tone, oldtone;
+  bool defRegionWithPaint     = params.m_defRegionWithPaint;
+  bool usePrevailingReferFill = params.m_usePrevailingReferFill;
+  bool doExtendFill           = params.m_extendFill;
+  bool filled;
+  TRect bbbox      = r->getBounds();
+  int lasty        = 0;
+  int wrap         = r->getWrap();
+  TPixelCM32 *line = r->pixels(0);
+  while (!seeds.empty()) {
+    FillSeed fs = seeds.top();
+    seeds.pop();
+    xa   = fs.m_xa;
+    xb   = fs.m_xb;
+    oldy = fs.m_y;
+    dy   = fs.m_dy;
+    y    = oldy + dy;
+    if (y > bbbox.y1 || y < bbbox.y0) continue;
+    line += (y - lasty) * wrap;
+    pix    = line + xa;
+    limit  = line + xb;
+    oldpix = pix - dy * wrap;
+    x      = xa;
+    oldxd  = (std::numeric_limits<int>::min)();
+    oldxc  = (std::numeric_limits<int>::max)();
+    lasty  = y;
+    filled = false;
+    while (pix <= limit) {
+      oldtone = threshTone(*oldpix, fillDepth);
+      tone    = threshTone(*pix, fillDepth);
+      // Additional condition prevents fill from bleeding behind colored lines
+      int pixPaint = pix->getPaint();
+      if (pixPaint != paint && tone <= oldtone && tone != 0 &&
+          (pixPaint == paintAtClickedPos || !defRegionWithPaint) &&
+          (pixPaint != pix->getInk() || pixPaint == paintAtClickedPos)) {
+        fillRow(r, TPoint(x, y), xc, xd, paint, params.m_palette, saver,
+                params.m_prevailing, paintAtClickedPos, defRegionWithPaint,
+                usePrevailingReferFill);
+        if (reachedPurePaint && !*reachedPurePaint) {
+          TPixelCM32 *rowPix = line + xc;
+          for (int i = xc; i <= xd; ++i, ++rowPix)
+            if (rowPix->isPurePaint()) {
+              *reachedPurePaint = true;
+              break;
+            }
+        }
+        filled |= tone == TPixelCM32::getMaxTone() && pix->getPaint() == paint;
+
+        if (xc < xa) seeds.push(FillSeed(xc, xa - 1, y, -dy));
+        if (xd > xb) seeds.push(FillSeed(xb + 1, xd, y, -dy));
+        if (oldxd >= xc - 1) {
+          oldxd = xd;
+        } else {
+          if (oldxd >= 0) {
+            seeds.push(FillSeed(oldxc, oldxd, y, dy));
+          }
+          oldxc = xc;
+          oldxd = xd;
+        }
+        pix += xd - x + 1;
+        oldpix += xd - x + 1;
+        x += xd - x + 1;
+      } else {
+        pix++;
+        oldpix++, x++;
+      }
+    }
+    if (oldxd > 0) seeds.push(FillSeed(oldxc, oldxd, y, dy));
+
+    if (doExtendFill && !filled && xa < xb) {
+      extendFill(paint, paintAtClickedPos, xa, xb, y, dy, r, params, saver);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
 }  // namespace
 //-----------------------------------------------------------------------------
 /*-- Returns true if fill was applied --*/
 bool fill(const TRasterCM32P &r, const FillParameters &params,
           TTileSaverCM32 *saver, const TRaster32P &Ref) {
-  TPixelCM32 *pix, *limit, *pix0, *oldpix;
-  int oldy, xa, xb, xc, xd, dy;
-  int oldxc, oldxd;
-  int tone, oldtone;
+  TPixelCM32 *pix0;
+  int xa, xb;
   TPoint p = params.m_p;
   int x = p.x, y = p.y;
   int paint = params.m_styleId;
   int fillDepth =
       params.m_shiftFill ? params.m_maxFillDepth : params.m_minFillDepth;
-  bool defRegionWithPaint     = params.m_defRegionWithPaint;
-  bool usePrevailingReferFill = params.m_usePrevailingReferFill;
   /*-- getBounds returns full image rect --*/
   TRect bbbox = r->getBounds();
   /*- Abort if click is outside image -*/
@@ -1079,72 +1162,311 @@ bool fill(const TRasterCM32P &r, const FillParameters &params,
   std::stack<FillSeed> seeds;
   // Fill initial row and seed stack
   fillRow(r, p, xa, xb, paint, params.m_palette, saver, params.m_prevailing,
-          paintAtClickedPos, defRegionWithPaint, usePrevailingReferFill);
+          paintAtClickedPos, params.m_defRegionWithPaint,
+          params.m_usePrevailingReferFill);
   seeds.push(FillSeed(xa, xb, y, 1));
   seeds.push(FillSeed(xa, xb, y, -1));
-  int lasty         = y;
-  int wrap          = r->getWrap();
-  TPixelCM32 *line  = r->pixels(y);
-  bool doExtendFill = params.m_extendFill;
-  bool filled;
-  while (!seeds.empty()) {
-    FillSeed fs = seeds.top();
-    seeds.pop();
-    xa   = fs.m_xa;
-    xb   = fs.m_xb;
-    oldy = fs.m_y;
-    dy   = fs.m_dy;
-    y    = oldy + dy;
-    if (y > bbbox.y1 || y < bbbox.y0) continue;
-    line += (y - lasty) * wrap;
-    pix    = line + xa;
-    limit  = line + xb;
-    oldpix = pix - dy * wrap;
-    x      = xa;
-    oldxd  = (std::numeric_limits<int>::min)();
-    oldxc  = (std::numeric_limits<int>::max)();
-    lasty  = y;
-    filled = false;
-    while (pix <= limit) {
-      oldtone = threshTone(*oldpix, fillDepth);
-      tone    = threshTone(*pix, fillDepth);
-      // Additional condition prevents fill from bleeding behind colored lines
-      int pixPaint = pix->getPaint();
-      if (pixPaint != paint && tone <= oldtone && tone != 0 &&
-          (pixPaint == paintAtClickedPos || !defRegionWithPaint) &&
-          (pixPaint != pix->getInk() || pixPaint == paintAtClickedPos)) {
-        fillRow(r, TPoint(x, y), xc, xd, paint, params.m_palette, saver,
-                params.m_prevailing, paintAtClickedPos, defRegionWithPaint,
-                usePrevailingReferFill);
-        filled |= tone == TPixelCM32::getMaxTone() && pix->getPaint() == paint;
+  fillSeeds(r, seeds, params, paint, paintAtClickedPos, fillDepth, saver);
+  return true;
+}
+//=============================================================================
+// FillRegionMap
+//-----------------------------------------------------------------------------
 
-        if (xc < xa) seeds.push(FillSeed(xc, xa - 1, y, -dy));
-        if (xd > xb) seeds.push(FillSeed(xb + 1, xd, y, -dy));
-        if (oldxd >= xc - 1) {
-          oldxd = xd;
-        } else {
-          if (oldxd >= 0) {
-            seeds.push(FillSeed(oldxc, oldxd, y, dy));
-          }
-          oldxc = xc;
-          oldxd = xd;
+std::unordered_map<std::string, std::shared_ptr<FillRegionMap>>
+    FillRegionMap::m_cache;
+std::mutex FillRegionMap::m_cacheMutex;
+
+//-----------------------------------------------------------------------------
+
+FillRegionMap::FillRegionMap(const TRasterCM32P &ras)
+    : m_size(ras->getSize()), m_rows(ras->getLy()), m_valid(true) {
+  // Runs of pure paint pixels are labeled row by row; runs overlapping a run
+  // of the same paint in the previous row are united.
+  std::vector<int> parent, paints;
+  std::vector<std::pair<int, int>> touching;
+  auto find = [&parent](int i) {
+    while (parent[i] != i) i = parent[i] = parent[parent[i]];
+    return i;
+  };
+
+  ras->lock();
+  for (int y = 0; y < m_size.ly; ++y) {
+    std::vector<Span> &row = m_rows[y];
+    TPixelCM32 *line       = ras->pixels(y);
+    for (int x = 0; x < m_size.lx;) {
+      if (!line[x].isPurePaint()) {
+        ++x;
+        continue;
+      }
+      int x0 = x, paint = line[x].getPaint();
+      while (x < m_size.lx && line[x].isPurePaint() &&
+             line[x].getPaint() == paint)
+        ++x;
+      int label = (int)parent.size();
+      parent.push_back(label);
+      paints.push_back(paint);
+      if (!row.empty() && row.back().m_x1 == x0 - 1)
+        touching.push_back(std::make_pair(row.back().m_region, label));
+      row.push_back({x0, x - 1, label});
+    }
+    if (y == 0) continue;
+
+    const std::vector<Span> &prevRow = m_rows[y - 1];
+    auto it                          = prevRow.begin();
+    for (const Span &span : row) {
+      while (it != prevRow.end() && it->m_x1 < span.m_x0) ++it;
+      for (auto jt = it; jt != prevRow.end() && jt->m_x0 <= span.m_x1; ++jt) {
+        if (paints[jt->m_region] != paints[span.m_region]) {
+          touching.push_back(std::make_pair(jt->m_region, span.m_region));
+          continue;
         }
-        pix += xd - x + 1;
-        oldpix += xd - x + 1;
-        x += xd - x + 1;
-      } else {
-        pix++;
-        oldpix++, x++;
+        int a = find(jt->m_region), b = find(span.m_region);
+        if (a != b) parent[std::max(a, b)] = std::min(a, b);
       }
     }
-    if (oldxd > 0) seeds.push(FillSeed(oldxc, oldxd, y, dy));
+  }
+  ras->unlock();
+
+  // Roots are the smallest label of their set, so they are met first
+  std::vector<int> regionOf(parent.size(), -1);
+  for (int i = 0; i < (int)parent.size(); ++i) {
+    int root = find(i);
+    if (root == i) {
+      Region region;
+      region.m_paint  = paints[i];
+      region.m_parent = (int)m_regions.size();
+      regionOf[i]     = region.m_parent;
+      m_regions.push_back(region);
+    } else
+      regionOf[i] = regionOf[root];
+  }
 
-    if (doExtendFill && !filled && xa < xb) {
-      extendFill(paint, paintAtClickedPos, xa, xb, y, dy, r, params, saver);
+  for (int y = 0; y < m_size.ly; ++y)
+    for (Span &span : m_rows[y]) {
+      span.m_region = regionOf[span.m_region];
+      m_regions[span.m_region].m_bbox += TRect(span.m_x0, y, span.m_x1, y);
+    }
+
+  for (const std::pair<int, int> &pair : touching) {
+    int a = regionOf[pair.first], b = regionOf[pair.second];
+    if (a == b) continue;
+    m_regions[a].m_neighbours.push_back(b);
+    m_regions[b].m_neighbours.push_back(a);
+  }
+  for (Region &region : m_regions) {
+    std::vector<int> &neighbours = region.m_neighbours;
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                     neighbours.end());
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int FillRegionMap::findRoot(int region) {
+  while (m_regions[region].m_parent != region) {
+    int &parent = m_regions[region].m_parent;
+    parent      = m_regions[parent].m_parent;
+    region      = parent;
+  }
+  return region;
+}
+
+//-----------------------------------------------------------------------------
+
+int FillRegionMap::regionAt(const TPoint &p) {
+  if (p.x < 0 || p.y < 0 || p.x >= m_size.lx || p.y >= m_size.ly) return -1;
+  const std::vector<Span> &row = m_rows[p.y];
+  auto it = std::upper_bound(
+      row.begin(), row.end(), p.x,
+      [](int x, const Span &span) { return x < span.m_x0; });
+  if (it == row.begin() || (--it)->m_x1 < p.x) return -1;
+  return findRoot(it->m_region);
+}
+
+//-----------------------------------------------------------------------------
+
+int FillRegionMap::getRegion(const TPoint &p) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return regionAt(p);
+}
+
+//-----------------------------------------------------------------------------
+
+void FillRegionMap::getBorderRanges(int root, int xa, int xb, int y,
+                                    std::vector<std::pair<int, int>> &ranges) {
+  ranges.clear();
+  if (y < 0 || y >= m_size.ly) return;
+  const std::vector<Span> &row = m_rows[y];
+  auto it = std::upper_bound(
+      row.begin(), row.end(), xa,
+      [](int x, const Span &span) { return x < span.m_x0; });
+  if (it != row.begin()) --it;
+  int x = xa;
+  for (; it != row.end() && it->m_x0 <= xb; ++it) {
+    if (it->m_x1 < x || findRoot(it->m_region) != root) continue;
+    if (it->m_x0 > x) ranges.push_back(std::make_pair(x, it->m_x0 - 1));
+    x = it->m_x1 + 1;
+  }
+  if (x <= xb) ranges.push_back(std::make_pair(x, xb));
+}
+
+//-----------------------------------------------------------------------------
+
+void FillRegionMap::mergeRegions(int root, int paint) {
+  m_regions[root].m_paint = paint;
+
+  // Regions of the new paint touching the filled one now belong to it
+  std::vector<int> neighbours, kept;
+  neighbours.swap(m_regions[root].m_neighbours);
+  for (int i = 0; i < (int)neighbours.size(); ++i) {
+    int n = findRoot(neighbours[i]);
+    if (n == root) continue;
+    Region &other = m_regions[n];
+    if (other.m_paint != paint) {
+      kept.push_back(n);
+      continue;
+    }
+    other.m_parent = root;
+    m_regions[root].m_bbox += other.m_bbox;
+    neighbours.insert(neighbours.end(), other.m_neighbours.begin(),
+                      other.m_neighbours.end());
+    other.m_neighbours.clear();
+  }
+  std::sort(kept.begin(), kept.end());
+  kept.erase(std::unique(kept.begin(), kept.end()), kept.end());
+  m_regions[root].m_neighbours.swap(kept);
+}
+
+//-----------------------------------------------------------------------------
+
+bool FillRegionMap::fill(const TRasterCM32P &r, const FillParameters &params,
+                         TTileSaverCM32 *saver) {
+  if (params.m_shiftFill || params.m_extendFill ||
+      !params.m_defRegionWithPaint)
+    return false;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_valid || r->getSize() != m_size) return false;
+
+  int root = regionAt(params.m_p);
+  if (root < 0) return false;
+
+  int paint             = params.m_styleId;
+  int paintAtClickedPos = r->pixels(params.m_p.y)[params.m_p.x].getPaint();
+  if (m_regions[root].m_paint != paintAtClickedPos) {
+    m_valid = false;
+    return false;
+  }
+  if (paintAtClickedPos == paint) return true;
+  if (params.m_emptyOnly && paintAtClickedPos != 0 && paint != 0) return true;
+
+  // Check that the raster still matches the map before touching it
+  const TRect bbox = m_regions[root].m_bbox;
+  for (int y = bbox.y0; y <= bbox.y1; ++y) {
+    TPixelCM32 *line = r->pixels(y);
+    for (const Span &span : m_rows[y]) {
+      if (span.m_x1 < bbox.x0) continue;
+      if (span.m_x0 > bbox.x1) break;
+      if (findRoot(span.m_region) != root) continue;
+      for (TPixelCM32 *pix = line + span.m_x0, *end = line + span.m_x1;
+           pix <= end; ++pix)
+        if (!pix->isPurePaint() || pix->getPaint() != paintAtClickedPos) {
+          m_valid = false;
+          return false;
+        }
+    }
+  }
+
+  // Relabel the region. fillRow() also takes care of the antialiased
+  // pixels at the ends of each span.
+  std::stack<FillSeed> seeds;
+  std::vector<std::pair<int, int>> ranges;
+  bool leaked = false;
+  int xa, xb;
+  for (int y = bbox.y0; y <= bbox.y1; ++y) {
+    TPixelCM32 *line = r->pixels(y);
+    for (const Span &span : m_rows[y]) {
+      if (span.m_x1 < bbox.x0) continue;
+      if (span.m_x0 > bbox.x1) break;
+      if (findRoot(span.m_region) != root) continue;
+      if (line[span.m_x0].getPaint() == paint) continue;
+      fillRow(r, TPoint(span.m_x0, y), xa, xb, paint, params.m_palette, saver,
+              params.m_prevailing, paintAtClickedPos, true,
+              params.m_usePrevailingReferFill);
+      for (int x = xa; x <= xb && !leaked; ++x) {
+        if (x == span.m_x0) x = span.m_x1 + 1;
+        leaked = x <= xb && line[x].isPurePaint() &&
+                 regionAt(TPoint(x, y)) != root;
+      }
+
+      // Only the rows bordering the region need the flood fill
+      for (int dy = -1; dy <= 1; dy += 2) {
+        getBorderRanges(root, xa, xb, y + dy, ranges);
+        for (const std::pair<int, int> &range : ranges)
+          seeds.push(FillSeed(range.first, range.second, y, dy));
+      }
     }
   }
+
+  fillSeeds(r, seeds, params, paint, paintAtClickedPos,
+            adjustFillDepth(params.m_minFillDepth), saver, &leaked);
+
+  if (leaked)
+    m_valid = false;
+  else
+    mergeRegions(root, paint);
   return true;
 }
+
+//-----------------------------------------------------------------------------
+
+std::shared_ptr<FillRegionMap> FillRegionMap::getMap(const std::string &id,
+                                                     const TRasterCM32P &ras) {
+  {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto it = m_cache.find(id);
+    if (it != m_cache.end() && it->second->isValid() &&
+        it->second->getSize() == ras->getSize())
+      return it->second;
+  }
+  std::shared_ptr<FillRegionMap> map(new FillRegionMap(ras));
+  setMap(id, map);
+  return map;
+}
+
+//-----------------------------------------------------------------------------
+
+void FillRegionMap::setMap(const std::string &id,
+                           const std::shared_ptr<FillRegionMap> &map) {
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+  constexpr size_t MAX_CACHE_SIZE = 8;  // maps are as large as the raster
+
+  m_cache[id] = map;
+  if (m_cache.size() > MAX_CACHE_SIZE) {
+    auto it = m_cache.begin();
+    if (it->first == id) ++it;
+    m_cache.erase(it);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void FillRegionMap::invalidate(const std::string &id) {
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  m_cache.erase(id);
+  m_cache.erase(id + "s");
+}
+
+//-----------------------------------------------------------------------------
+
+void FillRegionMap::clear() {
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  m_cache.clear();
+}
+
 //-----------------------------------------------------------------------------
 void fill(const TRaster32P &ras, const TRaster32P &ref,
           const FillParameters &params, TTileSaverFullColor *saver) {
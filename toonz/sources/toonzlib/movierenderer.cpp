@@ -3,6 +3,7 @@
 // TnzCore includes
 #include "tsystem.h"
 #include "tstopwatch.h"
+#include "tthread.h"
 #include "tthreadmessage.h"
 #include "timagecache.h"
 #include "tlevel_io.h"
@@ -30,6 +31,7 @@
 // Qt includes
 #include <QCoreApplication>
 #include <QTimer>
+#include <QWaitCondition>
 
 #include "toonz/movierenderer.h"
 
@@ -105,6 +107,9 @@ QString getPreviewName(unsigned long renderSessionId) {
 //**************************************************************************
 
 class MovieRenderer::Imp final : public TRenderPort, public TSmartObject {
+public:
+  class WriterTask;
+
 public:
   ToonzScene *m_scene;
   TRenderer m_renderer;
@@ -128,11 +133,26 @@ public:
 
   TThread::Mutex m_mutex;
 
+  /*--- Output stage. Completed frames are encoded and written by m_writer's
+  tasks, so that render threads may go on rendering. Render threads wait only
+  while more than m_maxQueuedFrames frames are still to be written.
+  ---*/
+  TThread::Executor m_writer;
+  QMutex m_writerMutex;  //!< Guards the counters below; not recursive
+  QWaitCondition m_writerCondition;
+  int m_framesToWrite;        //!< Frames handed to the writer, not yet written
+  int m_activeWritesCount;    //!< Frames being written right now
+  int m_pendingWriterTasks;   //!< Writer tasks not yet finished
+  int m_waitingThreadsCount;  //!< Render threads waiting on the writer
+  int m_maxQueuedFrames;
+  int m_threadCount;
+
   int m_renderSessionId;
   long m_whiteSample;
 
   int m_nextFrameIdxToSave;
   int m_savingThreadsCount;
+  bool m_sequentialSave;  //!< Whether frames must be saved in render order
   bool m_firstCompletedRaster;
   bool m_failure;
   bool m_cacheResults;
@@ -157,6 +177,12 @@ public:
   void doRenderRasterCompleted(const RenderData &renderData);
   void doPreviewRasterCompleted(const RenderData &renderData);
 
+  //! Writes all the completed frames that can be saved. Invoked by writer
+  //! tasks.
+  void writeFrames();
+  void waitForWriter(int framesCount);
+  void waitForWriterTasks();
+
   // Helper methods
 
   void prepareForStart();
@@ -176,7 +202,8 @@ public:
   //! frames were successfully saved, and
   //! the associated time-adjusted level frame.
   std::pair<bool, int> saveFrame(double frame,
-                                 const std::pair<TRasterP, TRasterP> &rasters);
+                                 const std::pair<TRasterP, TRasterP> &rasters,
+                                 bool applyGamma);
   std::string getRenderCacheId();
 
   // returns board duration in frame
@@ -187,6 +214,28 @@ public:
 
 //---------------------------------------------------------
 
+class MovieRenderer::Imp::WriterTask final : public TThread::Runnable {
+  // Not a smart pointer: onRenderFinished() waits for all writer tasks before
+  // releasing the Imp, which must not be destroyed by its own writer thread.
+  MovieRenderer::Imp *m_imp;
+
+public:
+  WriterTask(MovieRenderer::Imp *imp) : m_imp(imp) {}
+
+  void run() override {
+    try {
+      m_imp->writeFrames();
+    } catch (...) {
+    }
+
+    QMutexLocker locker(&m_imp->m_writerMutex);
+    --m_imp->m_pendingWriterTasks;
+    m_imp->m_writerCondition.wakeAll();
+  }
+};
+
+//---------------------------------------------------------
+
 MovieRenderer::Imp::Imp(ToonzScene *scene, const TFilePath &moviePath,
                         int threadCount, bool cacheResults)
     : m_scene(scene)
@@ -195,9 +244,16 @@ MovieRenderer::Imp::Imp(ToonzScene *scene, const TFilePath &moviePath,
     , m_frameSize(scene->getCurrentCamera()->getRes())
     , m_xDpi(72)
     , m_yDpi(72)
+    , m_framesToWrite(0)
+    , m_activeWritesCount(0)
+    , m_pendingWriterTasks(0)
+    , m_waitingThreadsCount(0)
+    , m_maxQueuedFrames(std::max(4, 2 * threadCount))
+    , m_threadCount(threadCount)
     , m_renderSessionId(RenderSessionId++)
     , m_nextFrameIdxToSave(0)
     , m_savingThreadsCount(0)
+    , m_sequentialSave(false)
     , m_whiteSample(0)
     , m_firstCompletedRaster(
           true)         //< I know, sounds weird - it's just set to false
@@ -283,6 +339,15 @@ void MovieRenderer::Imp::prepareForStart() {
                     cameraPos.y + cameraRes.ly);
   setRenderArea(renderArea);
 
+  // Movie formats require frames in sequence, and are written by a single
+  // writer thread. Image sequences have each frame encoded in parallel.
+  bool allowMT     = Preferences::instance()->getFfmpegMultiThread();
+  m_sequentialSave = allowMT ? m_seqRequired : m_movieType;
+
+  m_writer.setMaxActiveTasks(m_sequentialSave ? 1
+                                             : std::max(1, m_threadCount));
+  m_writer.setDedicatedThreads(true, false);
+
   if (!m_fp.isEmpty()) {
     try  // Construction of a LevelUpdater may throw (well, almost ANY operation
          // on a LevelUpdater
@@ -422,7 +487,8 @@ void MovieRenderer::Imp::postProcessImage(const TRasterImageP &img,
 //---------------------------------------------------------------------
 
 std::pair<bool, int> MovieRenderer::Imp::saveFrame(
-    double frame, const std::pair<TRasterP, TRasterP> &rasters) {
+    double frame, const std::pair<TRasterP, TRasterP> &rasters,
+    bool applyGamma) {
   bool success = false;
 
   // Build the frame number to write to
@@ -475,7 +541,7 @@ std::pair<bool, int> MovieRenderer::Imp::saveFrame(
     /*--- When caching the same raster, gamma only the first one and use the
 result in subsequent frames
 ---*/
-    if (m_renderSettings.m_gamma != 1.0 && m_toBeAppliedGamma[frame]) {
+    if (m_renderSettings.m_gamma != 1.0 && applyGamma) {
       TRop::gammaCorrect(rasterA, m_renderSettings.m_gamma);
       if (rasterB) TRop::gammaCorrect(rasterB, m_renderSettings.m_gamma);
     }
@@ -484,7 +550,7 @@ result in subsequent frames
     try {
       TRasterImageP imgA(rasterA);
       postProcessImage(imgA, has64bitOutputSupport, writeInLinearColorSpace,
-                       m_toBeAppliedGamma[frame], writingGamma,
+                       applyGamma, writingGamma,
                        m_renderSettings.m_colorSpaceGamma,
                        m_renderSettings.m_mark, fid.getNumber());
 
@@ -493,7 +559,7 @@ result in subsequent frames
       if (rasterB) {
         TRasterImageP imgB(rasterB);
         postProcessImage(imgB, has64bitOutputSupport, writeInLinearColorSpace,
-                         m_toBeAppliedGamma[frame], writingGamma,
+                         applyGamma, writingGamma,
                          m_renderSettings.m_colorSpaceGamma,
                          m_renderSettings.m_mark, fid.getNumber());
 
@@ -536,9 +602,6 @@ void MovieRenderer::Imp::doRenderRasterCompleted(const RenderData &renderData) {
 
   QMutexLocker locker(&m_mutex);
 
-  bool allowMT    = Preferences::instance()->getFfmpegMultiThread();
-  bool requireSeq = allowMT ? m_seqRequired : m_movieType;
-
   // Build soundtrack at the first time a frame is completed - and the filetype
   // is that of a movie.
   if (m_firstCompletedRaster) {
@@ -588,6 +651,57 @@ void MovieRenderer::Imp::doRenderRasterCompleted(const RenderData &renderData) {
     m_toBeAppliedGamma[*jt] = false;
   }
 
+  m_firstCompletedRaster = false;
+
+  locker.unlock();
+
+  // Hand the frames over to the writer, and wait if it is too far behind
+  waitForWriter((int)renderData.m_frames.size());
+}
+
+//---------------------------------------------------------
+
+void MovieRenderer::Imp::waitForWriter(int framesCount) {
+  QMutexLocker locker(&m_writerMutex);
+
+  m_framesToWrite += framesCount;
+  ++m_pendingWriterTasks;
+  m_writer.addTask(new WriterTask(this));
+
+  // Waiting is pointless while the writer is idle, ie when the frames to be
+  // written are still missing a previous one in the sequence
+  if (m_framesToWrite <= m_maxQueuedFrames || m_activeWritesCount == 0) return;
+
+  // Time the waiting, as for saving
+  if (m_waitingThreadsCount++ == 0) TStopWatch::global(1).start();
+
+  while (m_framesToWrite > m_maxQueuedFrames && m_activeWritesCount > 0)
+    m_writerCondition.wait(&m_writerMutex);
+
+  if (--m_waitingThreadsCount == 0) TStopWatch::global(1).stop();
+}
+
+//---------------------------------------------------------
+
+void MovieRenderer::Imp::waitForWriterTasks() {
+  QMutexLocker locker(&m_writerMutex);
+
+  // Writer tasks are assigned to threads by the main thread, which is the one
+  // usually waiting here - so keep processing its events
+  while (m_pendingWriterTasks > 0) {
+    locker.unlock();
+    QCoreApplication::processEvents();
+    locker.relock();
+
+    if (m_pendingWriterTasks > 0) m_writerCondition.wait(&m_writerMutex, 10);
+  }
+}
+
+//---------------------------------------------------------
+
+void MovieRenderer::Imp::writeFrames() {
+  QMutexLocker locker(&m_mutex);
+
   // Attempt flushing as many frames as possible to the level updater(s)
   while (!m_toBeSaved.empty()) {
     std::map<double, std::pair<TRasterP, TRasterP>>::iterator ft =
@@ -596,7 +710,7 @@ void MovieRenderer::Imp::doRenderRasterCompleted(const RenderData &renderData) {
     // In the *movie type* case, frames must be saved sequentially.
     // If the frame is not the next one in the sequence, wait until *that* frame
     // is available.
-    if (requireSeq &&
+    if (m_sequentialSave &&
         (ft->first != m_framesToBeRendered[m_nextFrameIdxToSave].first))
       break;
 
@@ -605,6 +719,7 @@ void MovieRenderer::Imp::doRenderRasterCompleted(const RenderData &renderData) {
     // thread from interfering
     double frame                          = ft->first;
     std::pair<TRasterP, TRasterP> rasters = ft->second;
+    bool applyGamma                       = m_toBeAppliedGamma[frame];
 
     ++m_nextFrameIdxToSave;
     m_toBeSaved.erase(ft);
@@ -623,17 +738,31 @@ void MovieRenderer::Imp::doRenderRasterCompleted(const RenderData &renderData) {
         }
       } saveTimer(m_savingThreadsCount);
 
-      // Unlock the mutex only in case this is NOT a movie type. Single images
-      // can be saved concurrently.
+      // Unlock the mutex while saving, so that render threads can queue
+      // their frames. Sequential saves are still serialized, since they are
+      // performed by a single writer thread.
       struct MutexUnlocker {
         QMutexLocker *m_locker;
         ~MutexUnlocker() {
           if (m_locker) m_locker->relock();
         }
-      } unlocker = {requireSeq ? (QMutexLocker *)0
-                               : (locker.unlock(), &locker)};
+      } unlocker = {(locker.unlock(), &locker)};
+
+      // Count the frame as being written - see waitForWriter()
+      struct WriteCounter {
+        Imp *m_imp;
+        WriteCounter(Imp *imp) : m_imp(imp) {
+          QMutexLocker writerLocker(&m_imp->m_writerMutex);
+          ++m_imp->m_activeWritesCount;
+        }
+        ~WriteCounter() {
+          QMutexLocker writerLocker(&m_imp->m_writerMutex);
+          --m_imp->m_activeWritesCount, --m_imp->m_framesToWrite;
+          m_imp->m_writerCondition.wakeAll();
+        }
+      } writeCounter(this);
 
-      savedFrame = saveFrame(frame, rasters);
+      savedFrame = saveFrame(frame, rasters, applyGamma);
     }
 
     // Report status and deal with responses
@@ -675,8 +804,6 @@ void MovieRenderer::Imp::doRenderRasterCompleted(const RenderData &renderData) {
       m_levelUpdaterB.reset();  // will be rejected and treated as failures.
     }
   }
-
-  m_firstCompletedRaster = false;
 }
 
 //---------------------------------------------------------
@@ -756,9 +883,6 @@ void MovieRenderer::Imp::onRenderFailure(const RenderData &renderData,
                               // No sense making it later in this case!
   m_failure = true;
 
-  bool allowMT    = Preferences::instance()->getFfmpegMultiThread();
-  bool requireSeq = allowMT ? m_seqRequired : m_movieType;
-
   // If the saver object has already been destroyed - or it was never
   // created to begin with, nothing to be done
   if (!m_levelUpdaterA.get()) return;  // The preview case would fall here
@@ -770,7 +894,7 @@ void MovieRenderer::Imp::onRenderFailure(const RenderData &renderData,
   std::map<double, std::pair<TRasterP, TRasterP>>::iterator it =
       m_toBeSaved.begin();
   while (it != m_toBeSaved.end()) {
-    if (requireSeq &&
+    if (m_sequentialSave &&
         (it->first != m_framesToBeRendered[m_nextFrameIdxToSave].first))
       break;
 
@@ -798,6 +922,13 @@ void MovieRenderer::Imp::onRenderFailure(const RenderData &renderData,
 
     if (!okToContinue) m_renderer.stopRendering();
 
+    // Frames rendered successfully were handed to the writer
+    if (it->second.first) {
+      QMutexLocker writerLocker(&m_writerMutex);
+      --m_framesToWrite;
+      m_writerCondition.wakeAll();
+    }
+
     ++m_nextFrameIdxToSave;
     m_toBeSaved.erase(it++);
   }
@@ -811,6 +942,9 @@ void MovieRenderer::Imp::onRenderFinished(bool isCanceled) {
           ? m_fp
           : TFilePath(getPreviewName(m_renderSessionId).toStdWString()));
 
+  // Let the writer flush the remaining frames
+  waitForWriterTasks();
+
   if (m_waitAfterFinish) {
     // Wait half a second to add some stability before finalizing
     QEventLoop eloop;
@@ -602,6 +602,7 @@ public:
   int m_whichLevels;
   bool m_isPreview;
   bool m_expandXSheet;
+  bool m_skipIdentityFxs;
 
   // in the makePF() methods m_particleDescendentCount>0 iff the TFx* is an
   // ancestor
@@ -617,7 +618,8 @@ public:
 
 public:
   FxBuilder(ToonzScene *scene, TXsheet *xsh, double frame, int whichLevels,
-            bool isPreview = false, bool expandXSheet = true);
+            bool isPreview = false, bool expandXSheet = true,
+            bool skipIdentityFxs = true);
 
   TFxP buildFx();
   TFxP buildFx(const TFxP &root, BSFX_Transforms_Enum transforms);
@@ -633,18 +635,24 @@ public:
   TFxP getFxWithColumnMovements(const PlacedFx &pf);
 
   bool addPlasticDeformerFx(PlacedFx &pf);
+
+  //! Returns whether fx is inserted in the render-tree. Disabled fxs and, if
+  //! required, identity fxs are replaced by their preferred input.
+  bool isRendered(TFx *fx) const;
 };
 
 //===================================================================
 
 FxBuilder::FxBuilder(ToonzScene *scene, TXsheet *xsh, double frame,
-                     int whichLevels, bool isPreview, bool expandXSheet)
+                     int whichLevels, bool isPreview, bool expandXSheet,
+                     bool skipIdentityFxs)
     : m_scene(scene)
     , m_xsh(xsh)
     , m_frame(frame)
     , m_whichLevels(whichLevels)
     , m_isPreview(isPreview)
     , m_expandXSheet(expandXSheet)
+    , m_skipIdentityFxs(skipIdentityFxs)
     , m_particleDescendentCount(0) {
   TStageObjectId cameraId;
   if (m_isPreview)
@@ -746,6 +754,15 @@ bool FxBuilder::addPlasticDeformerFx(PlacedFx &pf) {
 
 //-------------------------------------------------------------------
 
+bool FxBuilder::isRendered(TFx *fx) const {
+  if (!fx->getAttributes()->isEnabled()) return false;
+
+  TRasterFx *rasFx = dynamic_cast<TRasterFx *>(fx);
+  return !(m_skipIdentityFxs && rasFx && rasFx->isIdentity());
+}
+
+//-------------------------------------------------------------------
+
 PlacedFx FxBuilder::makePF(TFx *fx) {
   if (!fx) return PlacedFx();
 
@@ -911,7 +928,8 @@ PlacedFx FxBuilder::makePF(TLevelColumnFx *lcfx) {
     TXsheet *xsh = cell.m_level->getChildLevel()->getXsheet();
 
     // Build the sub-render-tree
-    FxBuilder builder(m_scene, xsh, levelFrame, m_whichLevels, m_isPreview);
+    FxBuilder builder(m_scene, xsh, levelFrame, m_whichLevels, m_isPreview,
+                      true, m_skipIdentityFxs);
 
     // Then, add the TimeShuffleFx
     pf.m_fx = timeShuffle(builder.buildFx(), levelFrame, lcfx->getTimeRegion(),
@@ -1146,7 +1164,7 @@ PlacedFx FxBuilder::makePFfromUnaryFx(TFx *fx) {
   // inherit the column placement even if the current cell is empty
   if (!pf.m_fx) return pf;
 
-  if (fx->getAttributes()->isEnabled()) {
+  if (isRendered(fx)) {
     // Fx is enabled, so insert it in the render-tree
 
     // Clone this fx necessary
@@ -1200,7 +1218,7 @@ PlacedFx FxBuilder::makePFfromGenericFx(TFx *fx) {
 
   PlacedFx pf;
 
-  if (!fx->getAttributes()->isEnabled()) {
+  if (!isRendered(fx)) {
     if (fx->getInputPortCount() == 0) return PlacedFx();
 
     TFxP inputFx = fx->getInputPort(fx->getPreferredInputPort())->getFx();
@@ -1498,7 +1516,8 @@ DVAPI TFxP buildPostSceneFx(ToonzScene *scene, double frame, int shrink,
 
 DVAPI TFxP buildSceneFx(ToonzScene *scene, double frame, TXsheet *xsh,
                         const TFxP &root, BSFX_Transforms_Enum transforms,
-                        bool isPreview, int whichLevels, int shrink) {
+                        bool isPreview, int whichLevels, int shrink,
+                        bool skipIdentityFxs) {
   // NOTE: Should whichLevels access output AND PREVIEW settings?
   if (whichLevels == -1)
     whichLevels =
@@ -1506,7 +1525,8 @@ DVAPI TFxP buildSceneFx(ToonzScene *scene, double frame, TXsheet *xsh,
 
   if (!xsh) xsh = scene->getXsheet();
 
-  FxBuilder builder(scene, xsh, frame, whichLevels, isPreview);
+  FxBuilder builder(scene, xsh, frame, whichLevels, isPreview, true,
+                    skipIdentityFxs);
 
   TFxP fx = root ? builder.buildFx(root, transforms) : builder.buildFx();
 
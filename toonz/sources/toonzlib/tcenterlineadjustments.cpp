@@ -14,11 +14,13 @@
 //    Skeleton re-organization Globals
 //----------------------------------------
 
+// NOTE: Thread-local, as multiple images may be vectorized concurrently
+
 namespace {
-VectorizerCoreGlobals *globals;
-std::vector<unsigned int> contourFamilyOfOrganized;
-JointSequenceGraph *currJSGraph;
-ContourFamily *currContourFamily;
+thread_local VectorizerCoreGlobals *globals;
+thread_local std::vector<unsigned int> contourFamilyOfOrganized;
+thread_local JointSequenceGraph *currJSGraph;
+thread_local ContourFamily *currContourFamily;
 };
 
 //==========================================================================
@@ -550,12 +552,12 @@ inline bool JunctionArea::solveJunctionPosition() {
 // Globals
 
 namespace {
-const std::vector<EnteringSequence> *currEnterings;
-const std::vector<unsigned int> *heightIndicesPtr;
+thread_local const std::vector<EnteringSequence> *currEnterings;
+thread_local const std::vector<unsigned int> *heightIndicesPtr;
 
-std::vector<double> *optHeights;
-double optMeanError;
-double hMax;
+thread_local std::vector<double> *optHeights;
+thread_local double optMeanError;
+thread_local double hMax;
 }
 
 //--------------------------------------------------------------------------
@@ -2,6 +2,14 @@
 
 #include "tcenterlinevectP.h"
 
+// STD includes
+#include <memory>
+#include <random>
+#include <atomic>
+
+// Qt includes
+#include <QThread>
+
 //#define _SSDEBUG                                              // Uncomment to
 // enable the debug viewer
 //#define _UPDATE                                               // Shows borders
@@ -602,6 +610,9 @@ inline void ContourNode::buildNodeInfos(bool forceConvex) {
 // vector is ordered according to those integers - events are calculated
 // following this order. Split events are therefore calculated sparsely
 // along the polygons, allowing a significant time reduction effect.
+// Numbers are drawn from a generator local to each timeline, so that the
+// result does not depend on which thread - or in which order - contour
+// families are processed.
 
 class RandomizedNode {
 public:
@@ -609,7 +620,8 @@ public:
   int m_number;
 
   RandomizedNode() {}
-  RandomizedNode(ContourNode *node) : m_node(node), m_number(rand()) {}
+  RandomizedNode(ContourNode *node, std::minstd_rand &randomizer)
+      : m_node(node), m_number(int(randomizer())) {}
 
   inline ContourNode *operator->(void) { return m_node; }
 };
@@ -629,16 +641,18 @@ void Timeline::build(ContourFamily &polygons, VectorizationContext &context,
                      VectorizerCore *thisVectorizer) {
   unsigned int i, j, current;
   std::vector<RandomizedNode> nodesToBeTreated(context.m_totalNodes);
+  std::minstd_rand randomizer;
   T3DPointD momentum, ray;
 
   // Build casual ordered node-array
   for (i = 0, current = 0; i < polygons.size(); ++i)
     for (j                        = 0; j < polygons[i].size(); ++j)
-      nodesToBeTreated[current++] = RandomizedNode(&polygons[i][j]);
+      nodesToBeTreated[current++] = RandomizedNode(&polygons[i][j], randomizer);
 
   // Same for linear-added nodes
-  for (i                        = 0; i < context.m_linearNodesHeapCount; ++i)
-    nodesToBeTreated[current++] = RandomizedNode(&context.m_linearNodesHeap[i]);
+  for (i = 0; i < context.m_linearNodesHeapCount; ++i)
+    nodesToBeTreated[current++] =
+        RandomizedNode(&context.m_linearNodesHeap[i], randomizer);
 
   double maxThickness = context.m_globals->currConfig->m_maxThickness;
 
@@ -1795,10 +1809,48 @@ static SkeletonGraph *skeletonize(ContourFamily &regionContours,
 
 //--------------------------------------------------------------------------
 
+namespace {
+
+//! Contour families are skeletonized independently - they are distributed
+//! among threads, each using its own context, and results are stored by
+//! family index.
+class FamiliesSkeletonizer final : public QThread {
+  Contours &m_contours;
+  SkeletonList &m_output;
+  VectorizerCoreGlobals &m_globals;
+  VectorizerCore *m_vectorizer;
+  std::atomic<unsigned int> &m_nextFamily;
+
+public:
+  enum { ParallelNodesCount = 1000 };
+
+public:
+  FamiliesSkeletonizer(Contours &contours, SkeletonList &output,
+                       VectorizerCoreGlobals &g, VectorizerCore *vectorizer,
+                       std::atomic<unsigned int> &nextFamily)
+      : m_contours(contours)
+      , m_output(output)
+      , m_globals(g)
+      , m_vectorizer(vectorizer)
+      , m_nextFamily(nextFamily) {}
+
+  void run() override {
+    VectorizationContext context(&m_globals);
+
+    unsigned int i;
+    while ((i = m_nextFamily++) < m_contours.size()) {
+      m_output[i] = skeletonize(m_contours[i], context, m_vectorizer);
+      if (m_vectorizer->isCanceled()) break;
+    }
+  }
+};
+
+}  // namespace
+
+//--------------------------------------------------------------------------
+
 SkeletonList *skeletonize(Contours &contours, VectorizerCore *thisVectorizer,
                           VectorizerCoreGlobals &g) {
-  VectorizationContext context(&g);
-
   SkeletonList *res = new SkeletonList;
   unsigned int i, j;
 
@@ -1810,12 +1862,41 @@ SkeletonList *skeletonize(Contours &contours, VectorizerCore *thisVectorizer,
 
   thisVectorizer->setOverallPartials(overallNodes);
 
-  for (i = 0; i < contours.size(); ++i) {
-    res->push_back(skeletonize(contours[i], context, thisVectorizer));
+  int threadsCount =
+      std::min<int>(contours.size(), thisVectorizer->getMaxThreadsCount());
 
-    if (thisVectorizer->isCanceled()) break;
+  if (threadsCount < 2 ||
+      overallNodes < FamiliesSkeletonizer::ParallelNodesCount) {
+    VectorizationContext context(&g);
+
+    for (i = 0; i < contours.size(); ++i) {
+      res->push_back(skeletonize(contours[i], context, thisVectorizer));
+
+      if (thisVectorizer->isCanceled()) break;
+    }
+
+    return res;
   }
 
+  // Skeletonize families concurrently, each thread picking the next
+  // unprocessed one
+  res->resize(contours.size(), 0);
+
+  std::atomic<unsigned int> nextFamily(0);
+
+  std::vector<std::unique_ptr<FamiliesSkeletonizer>> skeletonizers;
+  for (int t = 0; t != threadsCount; ++t)
+    skeletonizers.emplace_back(new FamiliesSkeletonizer(
+        contours, *res, g, thisVectorizer, nextFamily));
+
+  for (int t = 1; t < threadsCount; ++t) skeletonizers[t]->start();
+  skeletonizers[0]->run();
+  for (int t = 1; t < threadsCount; ++t) skeletonizers[t]->wait();
+
+  // Families skipped at user cancels are left out
+  res->erase(std::remove(res->begin(), res->end(), (SkeletonGraph *)0),
+             res->end());
+
   return res;
 }
 
@@ -6,6 +6,7 @@
 #include "tthreadmessage.h"
 #include "tconvert.h"
 #include "tstopwatch.h"
+#include "tprofiler.h"
 #include "tlevel_io.h"
 #include "trasterimage.h"
 #include "ttoonzimage.h"
@@ -85,6 +86,18 @@ TFxDeclarationT<TOutputFx> infoTOutputFx(TFxInfo("Toonz_outputFx", true));
 
 namespace {
 
+// Opens the span of a level frame read in profiler recordings
+void beginLevelReadSpan(TProfileSpan &span, TXshSimpleLevel *sl,
+                        const TFrameId &fid) {
+  if (!TProfiler::isActive()) return;
+
+  std::string path = sl->getPath().getQString().toStdString();
+  span.begin("level", ::to_string(sl->getName()) + " " + fid.expand(),
+             TProfiler::arg("path", path));
+}
+
+//--------------------------------------------------------------------------
+
 void setMaxMatte(TRasterP r) {
   TRaster32P r32 = (TRaster32P)r;
   TRaster64P r64 = (TRaster64P)r;
@@ -758,6 +771,9 @@ public:
     //   flag = flag | ImageManager::isLinearEnabled;
 
     // Load the image
+    TProfileSpan span;
+    beginLevelReadSpan(span, m_sl, m_fid);
+
     TImageP img(m_sl->getFullsampledFrame(m_fid, flag));
 
     if (!img) return;
@@ -1016,6 +1032,9 @@ void TLevelColumnFx::doCompute(TTile &tile, double frame,
   } else {
     // Vector case (loading is immediate)
     if (!img) {
+      TProfileSpan span;
+      beginLevelReadSpan(span, sl, fid);
+
       img = sl->getFullsampledFrame(
           fid, ((info.m_bpp == 64) ? ImageManager::is64bitEnabled : 0) |
                    ImageManager::dontPutInCache);
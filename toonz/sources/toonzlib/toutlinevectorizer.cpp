@@ -20,6 +20,9 @@
 #include <cmath>
 #include <functional>
 
+// Qt includes
+#include <QThread>
+
 #undef DEBUG
 
 //---------------------------------------------------------
@@ -1609,6 +1612,14 @@ void removeFillColors(TVectorImageP vi) {
 
 //=================================================================
 
+VectorizerCore::VectorizerCore()
+    : m_currPartial(0)
+    , m_totalPartials(0)
+    , m_maxThreadsCount(QThread::idealThreadCount())
+    , m_isCanceled(false) {}
+
+//-----------------------------------------------------------------
+
 TVectorImageP VectorizerCore::vectorize(const TImageP &img,
                                         const VectorizerConfiguration &c,
                                         TPalette *plt) {
@@ -339,6 +339,31 @@ bool touchEaseAndCompare(const TDoubleKeyframe &kf,
   return true;
 }
 
+//-----------------------------------------------------------------------------
+
+// Placement computation stores intermediate results in every object of the
+// parent chain (see computePlacement()), so it is serialized.
+QMutex placementMutex(QMutex::Recursive);
+
+//-----------------------------------------------------------------------------
+
+inline bool isHookHandle(const std::string &handle) {
+  return handle.length() > 1 && handle[0] == 'H';
+}
+
+//-----------------------------------------------------------------------------
+
+// Expression and similar shape segments may depend on other curves.
+bool isSelfContained(const TDoubleParamP &param) {
+  for (int k = 0; k < param->getKeyframeCount(); ++k) {
+    TDoubleKeyframe::Type type = param->getKeyframe(k).m_type;
+    if (type == TDoubleKeyframe::Expression ||
+        type == TDoubleKeyframe::SimilarShape)
+      return false;
+  }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 }  // namespace
 //-----------------------------------------------------------------------------
@@ -383,7 +408,8 @@ TStageObject::TStageObject(TStageObjectTree *tree, TStageObjectId id)
     , m_noScaleZ(0)
     , m_pinnedRangeSet(0)
     , m_ikflag(0)
-    , m_groupSelector(-1) {
+    , m_groupSelector(-1)
+    , m_placementCacheable(-1) {
   // NOTA: per le unita' di misura controlla anche tooloptions.cpp
   m_x->setName("W_X");
   m_x->setMeasureName("length.x");
@@ -509,10 +535,11 @@ void TStageObject::onChange(const class TParamChange &c) {
   // Thus, we're just SCHEDULING for a data refresh. The actual refresh happens
   // whenever the scheduled data is accessed.
 
+  // The placement tables are cleared right away, since they are read
+  // without accessing the lazy data.
+  invalidate();
   if (c.m_keyframeChanged)
-    m_lazyData.invalidate();  // Both invalidate placement AND keyframes
-  else
-    invalidate();  // Invalidate placement only
+    m_lazyData.invalidate();  // Invalidate keyframes too
 }
 
 //-----------------------------------------------------------------------------
@@ -1252,7 +1279,11 @@ bool TStageObject::isCycleEnabled() const { return m_cycleEnabled; }
 
 //-----------------------------------------------------------------------------
 
-void TStageObject::enableCycle(bool on) { m_cycleEnabled = on; }
+void TStageObject::enableCycle(bool on) {
+  if (m_cycleEnabled == on) return;
+  m_cycleEnabled = on;
+  invalidate();
+}
 
 //-----------------------------------------------------------------------------
 
@@ -1396,14 +1427,33 @@ TAffine TStageObject::computeLocalPlacement(double frame) {
 //-----------------------------------------------------------------------------
 
 TAffine TStageObject::getPlacement(double t) {
+  {
+    QMutexLocker tableLock(&m_placementTableMutex);
+    auto it = m_placementTable.find(t);
+    if (it != m_placementTable.end()) return it->second;
+  }
+
+  QMutexLocker lock(&placementMutex);
+  TAffine place = computePlacement(t);
+  if (isPlacementCacheable()) {
+    QMutexLocker tableLock(&m_placementTableMutex);
+    if (m_placementTable.size() >= 1024) m_placementTable.clear();
+    m_placementTable[t] = place;
+  }
+  return place;
+}
+
+//-----------------------------------------------------------------------------
+
+TAffine TStageObject::computePlacement(double t) {
   double &time = lazyData().m_time;
 
   if (time == t) return m_absPlacement;
   if (time != -1) {
     if (!m_parent)
-      invalidate();
+      invalidateTime();
     else
-      findRoot(t)->invalidate();
+      findRoot(t)->invalidateTime();
   }
 
   double tt = paramsTime(t);
@@ -1470,7 +1520,51 @@ void TStageObject::invalidate(LazyData &ld) const {
 
 //-----------------------------------------------------------------------------
 
-void TStageObject::invalidate() { invalidate(m_lazyData(tcg::direct_access)); }
+void TStageObject::invalidate() {
+  clearPlacementTable();
+  invalidate(m_lazyData(tcg::direct_access));
+}
+
+//-----------------------------------------------------------------------------
+
+/*! Returns true if the placement of this object and of its parents depends
+    only on their own curves, so that it may be stored per frame.
+    Hook handles, paths, inverse kinematics and expressions depend on data
+    that does not notify the stage object when it changes.
+*/
+bool TStageObject::isPlacementCacheable() {
+  if (m_placementCacheable < 0) {
+    bool cacheable =
+        (m_status & STATUS_MASK) == XY && m_ikflag == 0 &&
+        !isHookHandle(m_handle) && !isHookHandle(m_parentHandle) &&
+        isSelfContained(m_x) && isSelfContained(m_y) &&
+        isSelfContained(m_rot) && isSelfContained(m_scalex) &&
+        isSelfContained(m_scaley) && isSelfContained(m_scale) &&
+        isSelfContained(m_shearx) && isSelfContained(m_sheary);
+    m_placementCacheable = cacheable ? 1 : 0;
+  }
+  return m_placementCacheable == 1 &&
+         (!m_parent || m_parent->isPlacementCacheable());
+}
+
+//-----------------------------------------------------------------------------
+
+void TStageObject::clearPlacementTable() {
+  QMutexLocker tableLock(&m_placementTableMutex);
+  m_placementTable.clear();
+  m_placementCacheable = -1;
+}
+
+//-----------------------------------------------------------------------------
+
+//! Resets the internal time of the object and of its children, leaving the
+//! placement tables untouched.
+void TStageObject::invalidateTime() {
+  m_lazyData(tcg::direct_access).m_time = -1;
+
+  std::list<TStageObject *>::const_iterator cit = m_children.begin();
+  for (; cit != m_children.end(); ++cit) (*cit)->invalidateTime();
+}
 
 //-----------------------------------------------------------------------------
 
@@ -5,16 +5,27 @@
 #include "timagecache.h"
 #include "ttoonzimage.h"
 #include "trasterimage.h"
+
+namespace {
+
+// Tiles are seldom accessed (typically on undo/redo only): they are kept
+// compressed in the image cache, which may also move them to disk.
+// Compression fails if the tile image is still referenced outside the cache.
+inline void compressTile(const QString &id) {
+  TImageCache::instance()->compress(id.toStdString());
+}
+
+}  // namespace
+
 //------------------------------------------------------------------------------------------
 
-TTileSet::Tile::Tile() : m_rasterBounds(TRect()), m_dim(), m_pixelSize(0) {}
+TTileSet::Tile::Tile() : m_size(0), m_rasterBounds(TRect()) {}
 
 //------------------------------------------------------------------------------------------
 
 TTileSet::Tile::Tile(const TRasterP &ras, const TPoint &p)
-    : m_rasterBounds(ras->getBounds() + p)
-    , m_dim(ras->getSize())
-    , m_pixelSize(ras->getPixelSize()) {}
+    : m_size(ras->getLy() * ras->getRowSize())
+    , m_rasterBounds(ras->getBounds() + p) {}
 
 //------------------------------------------------------------------------------------------
 
@@ -22,6 +33,16 @@ TTileSet::Tile::~Tile() {}
 
 //------------------------------------------------------------------------------------------
 
+void TTileSet::Tile::compress() {
+  compressTile(id());
+
+  // 0 if the cache moved the tile straight to disk: keep its raw size
+  int size = TImageCache::instance()->getMemUsage(id().toStdString());
+  if (size > 0) m_size = size;
+}
+
+//------------------------------------------------------------------------------------------
+
 TTileSet::~TTileSet() { clearPointerContainer(m_tiles); }
 
 //------------------------------------------------------------------------------------------
@@ -79,10 +100,14 @@ TTileSetCM32::~TTileSetCM32() {}
 //------------------------------------------------------------------------------------------
 
 void TTileSetCM32::Tile::getRaster(TRasterCM32P &ras) const {
-  TToonzImageP timg = (TToonzImageP)TImageCache::instance()->get(id(), true);
-  if (!timg) return;
-  ras = timg->getRaster();
-  assert(ras);
+  {
+    TToonzImageP timg =
+        (TToonzImageP)TImageCache::instance()->get(id(), false);
+    if (!timg) return;
+    ras = timg->getRaster()->clone();
+    assert(ras);
+  }
+  compressTile(id());
 }
 
 //------------------------------------------------------------------------------------------
@@ -90,9 +115,15 @@ void TTileSetCM32::Tile::getRaster(TRasterCM32P &ras) const {
 TTileSetCM32::Tile *TTileSetCM32::Tile::clone() const {
   Tile *tile           = new Tile();
   tile->m_rasterBounds = m_rasterBounds;
-  TToonzImageP timg    = (TToonzImageP)TImageCache::instance()->get(id(), true);
-  if (!timg) return tile;
-  TImageCache::instance()->add(tile->id(), timg->clone());
+  {
+    TToonzImageP timg =
+        (TToonzImageP)TImageCache::instance()->get(id(), false);
+    if (!timg) return tile;
+    TImageCache::instance()->add(tile->id(), timg->clone());
+  }
+  compressTile(id());
+  tile->m_size = m_size;
+  tile->compress();
   return tile;
 }
 
@@ -104,7 +135,9 @@ void TTileSetCM32::add(const TRasterP &ras, TRect rect) {
   rect *= bounds;
   assert(!rect.isEmpty());
   assert(bounds.contains(rect));
-  TTileSet::add(new Tile(ras->extract(rect)->clone(), rect.getP00()));
+  Tile *tile = new Tile(ras->extract(rect)->clone(), rect.getP00());
+  TTileSet::add(tile);
+  tile->compress();
 }
 
 //------------------------------------------------------------------------------------------
@@ -156,10 +189,14 @@ TTileSetFullColor::~TTileSetFullColor() {}
 //------------------------------------------------------------------------------------------
 
 void TTileSetFullColor::Tile::getRaster(TRasterP &ras) const {
-  TRasterImageP img = (TRasterImageP)TImageCache::instance()->get(id(), true);
-  if (!img) return;
-  ras = img->getRaster();
-  assert(!!ras);
+  {
+    TRasterImageP img =
+        (TRasterImageP)TImageCache::instance()->get(id(), false);
+    if (!img) return;
+    ras = img->getRaster()->clone();
+    assert(!!ras);
+  }
+  compressTile(id());
 }
 
 //------------------------------------------------------------------------------------------
@@ -167,10 +204,16 @@ void TTileSetFullColor::Tile::getRaster(TRasterP &ras) const {
 TTileSetFullColor::Tile *TTileSetFullColor::Tile::clone() const {
   Tile *tile           = new Tile();
   tile->m_rasterBounds = m_rasterBounds;
-  TRasterImageP img = (TRasterImageP)TImageCache::instance()->get(id(), true);
-  if (!img) return tile;
-  TRasterImageP clonedImage(img->getRaster()->clone());
-  TImageCache::instance()->add(tile->id(), clonedImage);
+  {
+    TRasterImageP img =
+        (TRasterImageP)TImageCache::instance()->get(id(), false);
+    if (!img) return tile;
+    TRasterImageP clonedImage(img->getRaster()->clone());
+    TImageCache::instance()->add(tile->id(), clonedImage);
+  }
+  compressTile(id());
+  tile->m_size = m_size;
+  tile->compress();
   return tile;
 }
 
@@ -182,7 +225,9 @@ void TTileSetFullColor::add(const TRasterP &ras, TRect rect) {
   rect *= bounds;
   assert(!rect.isEmpty());
   assert(bounds.contains(rect));
-  TTileSet::add(new Tile(ras->extract(rect)->clone(), rect.getP00()));
+  Tile *tile = new Tile(ras->extract(rect)->clone(), rect.getP00());
+  TTileSet::add(tile);
+  tile->compress();
 }
 
 //------------------------------------------------------------------------------------------
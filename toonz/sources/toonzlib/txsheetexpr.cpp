@@ -31,10 +31,13 @@
 
 // Qt includes
 #include <QString>
+#include <QMutex>
 
 #include "toonz/txsheetexpr.h"
 
+#include <map>
 #include <memory>
+#include <set>
 
 using namespace TSyntax;
 
@@ -92,6 +95,26 @@ public:
   QSet<TDoubleParam *> refParams() const { return m_refParams; }
 };
 
+//===================================================================
+
+//! Looks for references to xsheet drawings, whose changes are not notified
+//! to the parameters depending on them.
+class DrawingReferenceFinder final : public TSyntax::CalculatorNodeVisitor {
+  std::set<TDoubleParam *> m_visitedParams;
+  bool m_found;
+
+public:
+  DrawingReferenceFinder() : m_found(false) {}
+
+  //! Returns false if \b param was already visited.
+  bool visit(TDoubleParam *param) {
+    return m_visitedParams.insert(param).second;
+  }
+
+  void setFound() { m_found = true; }
+  bool found() const { return m_found; }
+};
+
 //===================================================================
 //
 // Calculator Nodes
@@ -103,20 +126,61 @@ class ParamCalculatorNode : public CalculatorNode,
                             public boost::noncopyable {
   std::unique_ptr<CalculatorNode> m_frame;
 
+  // Values of the referenced parameter by frame. They are cleared whenever
+  // the parameter (or any parameter it references) changes.
+  mutable std::map<double, double> m_values;
+  mutable int m_memoizable;  //!< -1 = unknown
+  mutable QMutex m_valuesMutex;
+
 protected:
   TDoubleParamP m_param;
 
+  bool acceptDrawingReferenceFinder(TSyntax::CalculatorNodeVisitor &visitor) {
+    DrawingReferenceFinder *drf =
+        dynamic_cast<DrawingReferenceFinder *>(&visitor);
+    if (!drf) return false;
+    if (drf->visit(m_param.getPointer())) m_param->accept(visitor);
+    return true;
+  }
+
 public:
   ParamCalculatorNode(Calculator *calculator, const TDoubleParamP &param,
                       std::unique_ptr<CalculatorNode> frame)
-      : CalculatorNode(calculator), m_param(param), m_frame(std::move(frame)) {
+      : CalculatorNode(calculator)
+      , m_param(param)
+      , m_frame(std::move(frame))
+      , m_memoizable(-1) {
     param->addObserver(this);
   }
 
   ~ParamCalculatorNode() { m_param->removeObserver(this); }
 
+  double getParamValue(double frame) const {
+    {
+      QMutexLocker locker(&m_valuesMutex);
+      if (m_memoizable < 0) {
+        DrawingReferenceFinder finder;
+        finder.visit(m_param.getPointer());
+        m_param->accept(finder);
+        m_memoizable = finder.found() ? 0 : 1;
+      }
+      if (!m_memoizable) return m_param->getValue(frame);
+
+      std::map<double, double>::const_iterator it = m_values.find(frame);
+      if (it != m_values.end()) return it->second;
+    }
+
+    // Evaluated unlocked, since it may recurse into other references
+    double value = m_param->getValue(frame);
+
+    QMutexLocker locker(&m_valuesMutex);
+    if (m_values.size() >= 4096) m_values.clear();
+    m_values[frame] = value;
+    return value;
+  }
+
   double compute(double vars[3]) const override {
-    double value      = m_param->getValue(m_frame->compute(vars) - 1);
+    double value      = getParamValue(m_frame->compute(vars) - 1);
     TMeasure *measure = m_param->getMeasure();
     if (measure) {
       const TUnit *unit = measure->getCurrentUnit();
@@ -131,6 +195,7 @@ public:
       prf->registerRefParam(m_param.getPointer());
       return;
     }
+    if (acceptDrawingReferenceFinder(visitor)) return;
 
     ParamDependencyFinder *pdf =
         dynamic_cast<ParamDependencyFinder *>(&visitor);
@@ -141,6 +206,12 @@ public:
   }
 
   void onChange(const TParamChange &paramChange) override {
+    {
+      QMutexLocker locker(&m_valuesMutex);
+      m_values.clear();
+      m_memoizable = -1;
+    }
+
     // The referenced parameter changed. This means the parameter owning the
     // expression this node is part of, changes too.
 
@@ -181,6 +252,7 @@ public:
       prf->registerColumnIndex(m_columnIndex);
       return;
     }
+    if (acceptDrawingReferenceFinder(visitor)) return;
 
     ParamDependencyFinder *pdf =
         dynamic_cast<ParamDependencyFinder *>(&visitor);
@@ -224,6 +296,10 @@ public:
   void accept(TSyntax::CalculatorNodeVisitor &visitor) override {
     ParamReferenceFinder *prf = dynamic_cast<ParamReferenceFinder *>(&visitor);
     if (prf) prf->registerColumnIndex(m_columnIndex);
+
+    DrawingReferenceFinder *drf =
+        dynamic_cast<DrawingReferenceFinder *>(&visitor);
+    if (drf) drf->setFound();
   }
 
   bool hasReference() const override { return true; }
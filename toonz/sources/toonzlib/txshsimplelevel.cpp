@@ -18,6 +18,7 @@
 #include "toonz/mypaintbrushstyle.h"
 #include "toonz/levelset.h"
 #include "toonz/tcamera.h"
+#include "toonz/fill.h"
 
 // TnzBase includes
 #include "tenv.h"
@@ -327,6 +328,7 @@ void TXshSimpleLevel::touchFrame(const TFrameId& fid) {
     std::string id = filled(getImageId(fid));
     ImageManager::instance()->invalidate(id);
   }
+  if (getType() == TZP_XSHLEVEL) FillRegionMap::invalidate(getImageId(fid, 0));
 }
 
 //-----------------------------------------------------------------------------
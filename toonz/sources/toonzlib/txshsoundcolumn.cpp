@@ -15,6 +15,12 @@
 
 #include <QAudioFormat>
 #include <QAudioDeviceInfo>
+#include <QMutex>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
 
 //=============================================================================
 
@@ -148,15 +154,223 @@ bool lessThan(const ColumnLevel *s1, const ColumnLevel *s2) {
   return s1->getVisibleStartFrame() < s2->getVisibleStartFrame();
 }
 
+//-----------------------------------------------------------------------------
+
+inline int floorDiv(int a, int b) { return a / b - (a % b < 0 ? 1 : 0); }
+
 //-----------------------------------------------------------------------------
 }  // namespace
+//=============================================================================
+//  TXshSoundColumn::MixdownCache
+//-----------------------------------------------------------------------------
+
+/*!
+  Stores the overall sound track of a column by chunks of frames, for the last
+  requested format and frame rate. Each chunk remembers the placement of the
+  levels it was built from: edits to the column rebuild just the chunks whose
+  frame range they affect. The level tracks converted to the requested format
+  are cached too, since each conversion processes a whole level.
+*/
+class TXshSoundColumn::MixdownCache {
+  struct Placement {
+    TSoundTrackP m_track;
+    int m_startFrame, m_startOffset, m_endOffset, m_frameCount;
+
+    int getVisibleStartFrame() const { return m_startFrame + m_startOffset; }
+    int getVisibleEndFrame() const {
+      return m_startFrame + m_frameCount - m_endOffset;
+    }
+    bool operator==(const Placement &p) const {
+      return m_track == p.m_track && m_startFrame == p.m_startFrame &&
+             m_startOffset == p.m_startOffset &&
+             m_endOffset == p.m_endOffset && m_frameCount == p.m_frameCount;
+    }
+  };
+
+  struct Chunk {
+    std::vector<Placement> m_placements;
+    TSoundTrackP m_track;
+    int m_lastAccess;
+  };
+
+  enum { ChunkFrames = 24, MaxChunksCount = 256 };
+
+  QMutex m_mutex;
+  TSoundTrackFormat m_format;
+  double m_fps;
+  std::map<int, Chunk> m_chunks;
+  int m_accessCount;
+
+  std::map<TSoundTrack *, std::pair<TSoundTrackP, TSoundTrackP>>
+      m_convertedTracks;  // source -> (source, converted)
+
+public:
+  MixdownCache() : m_fps(0), m_accessCount(0) {}
+
+  //! Copies the column sound in [fromFrame, toFrame) to the blank track dst.
+  void fill(const TSoundTrackP &dst, const QList<ColumnLevel *> &levels,
+            int fromFrame, int toFrame, TSoundTrackFormat format, double fps);
+
+private:
+  TINT32 sampleAt(int frame) const {
+    return (TINT32)std::floor(frame * (m_format.m_sampleRate / m_fps));
+  }
+
+  void getPlacements(const QList<ColumnLevel *> &levels, int r0, int r1,
+                     std::vector<Placement> &placements) const;
+  TSoundTrackP getConvertedTrack(const TSoundTrackP &track);
+  TSoundTrackP buildChunk(const std::vector<Placement> &placements, int r0,
+                          int r1);
+  void releaseUnused(const QList<ColumnLevel *> &levels);
+};
+
+//-----------------------------------------------------------------------------
+
+void TXshSoundColumn::MixdownCache::fill(const TSoundTrackP &dst,
+                                         const QList<ColumnLevel *> &levels,
+                                         int fromFrame, int toFrame,
+                                         TSoundTrackFormat format,
+                                         double fps) {
+  QMutexLocker locker(&m_mutex);
+
+  if (fps != m_fps || format != m_format) {
+    m_chunks.clear();
+    m_convertedTracks.clear();
+    m_format = format;
+    m_fps    = fps;
+  }
+
+  TINT32 dstSampleCount = dst->getSampleCount();
+  TINT32 dstBase        = sampleAt(fromFrame);
+
+  int c, c0 = floorDiv(fromFrame, ChunkFrames),
+         c1 = floorDiv(toFrame - 1, ChunkFrames);
+  for (c = c0; c <= c1; ++c) {
+    int r0 = c * ChunkFrames, r1 = r0 + ChunkFrames;
+
+    std::vector<Placement> placements;
+    getPlacements(levels, r0, r1, placements);
+    if (placements.empty()) {
+      m_chunks.erase(c);  // silence - dst is already blank
+      continue;
+    }
+
+    Chunk &chunk = m_chunks[c];
+    if (!chunk.m_track || chunk.m_placements != placements) {
+      chunk.m_track = buildChunk(placements, r0, r1);
+      chunk.m_placements.swap(placements);
+    }
+    chunk.m_lastAccess = ++m_accessCount;
+
+    // Copy the requested part of the chunk
+    TINT32 chunkBase = sampleAt(r0);
+    TINT32 srcBegin  = std::max(dstBase - chunkBase, (TINT32)0);
+    TINT32 dstBegin  = std::max(chunkBase - dstBase, (TINT32)0);
+    TINT32 count     = std::min(chunk.m_track->getSampleCount() - srcBegin,
+                            dstSampleCount - dstBegin);
+    if (count > 0)
+      dst->copy(chunk.m_track->extract(srcBegin, srcBegin + count - 1),
+                dstBegin);
+  }
+
+  // Release the least recently accessed chunks
+  while ((int)m_chunks.size() > MaxChunksCount) {
+    auto oldest = m_chunks.begin();
+    for (auto it = m_chunks.begin(); it != m_chunks.end(); ++it)
+      if (it->second.m_lastAccess < oldest->second.m_lastAccess) oldest = it;
+    m_chunks.erase(oldest);
+  }
+  releaseUnused(levels);
+}
+
+//-----------------------------------------------------------------------------
+
+void TXshSoundColumn::MixdownCache::getPlacements(
+    const QList<ColumnLevel *> &levels, int r0, int r1,
+    std::vector<Placement> &placements) const {
+  for (int i = 0; i < levels.size(); i++) {
+    ColumnLevel *l             = levels.at(i);
+    TXshSoundLevel *soundLevel = l->getSoundLevel();
+    TSoundTrackP track         = soundLevel->getSoundTrack();
+    if (!track) continue;
+
+    Placement placement = {track, l->getStartFrame(), l->getStartOffset(),
+                           l->getEndOffset(), soundLevel->getFrameCount()};
+    if (placement.getVisibleStartFrame() < r1 &&
+        placement.getVisibleEndFrame() > r0)
+      placements.push_back(placement);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+TSoundTrackP TXshSoundColumn::MixdownCache::getConvertedTrack(
+    const TSoundTrackP &track) {
+  if (track->getFormat() == m_format) return track;
+
+  auto it = m_convertedTracks.find(track.getPointer());
+  if (it != m_convertedTracks.end()) return it->second.second;
+
+  TSoundTrackP converted = TSop::convert(track, m_format);
+  m_convertedTracks[track.getPointer()] = std::make_pair(track, converted);
+  return converted;
+}
+
+//-----------------------------------------------------------------------------
+
+TSoundTrackP TXshSoundColumn::MixdownCache::buildChunk(
+    const std::vector<Placement> &placements, int r0, int r1) {
+  double samplePerFrame = m_format.m_sampleRate / m_fps;
+  TINT32 chunkBase      = sampleAt(r0);
+
+  TSoundTrackP chunk = TSoundTrack::create(m_format, sampleAt(r1) - chunkBase);
+  chunk->blank(0, chunk->getSampleCount() - 1);
+
+  for (const Placement &placement : placements) {
+    TSoundTrackP track = getConvertedTrack(placement.m_track);
+
+    int levelStartFrame = placement.getVisibleStartFrame();
+    int f0 = std::max(levelStartFrame, r0);
+    int f1 = std::min(placement.getVisibleEndFrame(), r1);
+
+    // Samples of the level track, from its first frame
+    TINT32 s0 = (TINT32)((placement.m_startOffset + f0 - levelStartFrame) *
+                         samplePerFrame);
+    TINT32 s1 = (TINT32)((placement.m_startOffset + f1 - levelStartFrame) *
+                         samplePerFrame) -
+                1;
+    if (s1 < s0 || s0 >= track->getSampleCount()) continue;
+
+    chunk->copy(track->extract(s0, s1), sampleAt(f0) - chunkBase);
+  }
+  return chunk;
+}
+
+//-----------------------------------------------------------------------------
+
+void TXshSoundColumn::MixdownCache::releaseUnused(
+    const QList<ColumnLevel *> &levels) {
+  auto it = m_convertedTracks.begin();
+  while (it != m_convertedTracks.end()) {
+    bool used = false;
+    for (int i = 0; i < levels.size() && !used; i++)
+      used = levels.at(i)->getSoundLevel()->getSoundTrack().getPointer() ==
+             it->first;
+    if (used)
+      ++it;
+    else
+      it = m_convertedTracks.erase(it);
+  }
+}
+
 //=============================================================================
 
 TXshSoundColumn::TXshSoundColumn()
     : m_player(0)
     , m_volume(0.4)
     , m_currentPlaySoundTrack(0)
-    , m_isOldVersion(false) {
+    , m_isOldVersion(false)
+    , m_mixdownCache(new MixdownCache()) {
   m_timer.setInterval(500);
   m_timer.setSingleShot(true);
   m_timer.stop();
@@ -1025,8 +1239,6 @@ TSoundTrackP TXshSoundColumn::getOverallSoundTrack(int fromFrame, int toFrame,
   }
 #endif
   // Create the soundTrack
-  double samplePerFrame = format.m_sampleRate / fps;
-
   // In seconds
   double duration = double(toFrame - fromFrame) / fps;
 
@@ -1047,42 +1259,9 @@ TSoundTrackP TXshSoundColumn::getOverallSoundTrack(int fromFrame, int toFrame,
 
   if (levelsCount == 0) return overallSoundTrack;
 
-  for (int i = 0; i < levelsCount; i++) {
-    ColumnLevel *l             = m_levels.at(i);
-    TXshSoundLevel *soundLevel = l->getSoundLevel();
-
-    // Check if the soundtrack is inside the frame Range.
-    int levelStartFrame = l->getStartFrame() + l->getStartOffset();
-    int levelEndFrame   = levelStartFrame + soundLevel->getFrameCount() -
-                        l->getStartOffset() - l->getEndOffset();
-    // If the soundSequence is completely before fromFrame I will skip it
-    if ((levelStartFrame < fromFrame && levelEndFrame < fromFrame)) continue;
-    // If the soundSequence is after toFrame I don't check the others (that
-    // comes later..)
-    if ((levelStartFrame > toFrame && levelEndFrame > toFrame)) break;
-
-    // Extract the right soundTrack (using the offsets)
-    // (pay attention to convert it before)
-    TSoundTrackP s = soundLevel->getSoundTrack();
-    if (!s) continue;
-    TSoundTrackP soundTrack = TSop::convert(s, format);
-
-    int s0delta = 0;
-    if (fromFrame > levelStartFrame) s0delta = fromFrame - levelStartFrame;
-
-    int s0 = (l->getStartOffset() + s0delta) * samplePerFrame;
-
-    int s1delta = 0;
-    if (toFrame < levelEndFrame) s1delta = levelEndFrame - toFrame;
-    int s1 = (soundLevel->getFrameCount() - l->getEndOffset() - s1delta) *
-             samplePerFrame;
-
-    if (s1 > 0 && s1 >= s0) {
-      soundTrack = soundTrack->extract(s0, s1);
-      overallSoundTrack->copy(
-          soundTrack, int((levelStartFrame - fromFrame) * samplePerFrame));
-    }
-  }
+  // Copy the levels' sound, through the chunks cache
+  m_mixdownCache->fill(overallSoundTrack, m_levels, fromFrame, toFrame, format,
+                       fps);
   return overallSoundTrack;
 }
 
@@ -1119,9 +1298,8 @@ TSoundTrackP TXshSoundColumn::mixingTogether(
     c                     = vect[j];
     if (j == 0) {
       mix = c->getOverallSoundTrack(fromFrame, toFrame, fps, format);
-      TSoundTrackP mixedTrack =
-          TSoundTrack::create(mix->getFormat(), mix->getSampleCount());
-      mix = TSop::mix(mixedTrack, mix, 1.0, c->getVolume());
+      // The overall track is a new one: scale it by the volume in place
+      mix = TSop::mixInPlace(mix, mix, c->getVolume(), 0.0);
       continue;
     }
     assert(oldC);
@@ -1129,9 +1307,10 @@ TSoundTrackP TXshSoundColumn::mixingTogether(
       c = oldC;
       continue;
     }
-    mix =
-        TSop::mix(mix, c->getOverallSoundTrack(fromFrame, toFrame, fps, format),
-                  1.0, c->getVolume());
+    // All the overall tracks have the same length: accumulate in mix
+    mix = TSop::mixInPlace(
+        mix, c->getOverallSoundTrack(fromFrame, toFrame, fps, format), 1.0,
+        c->getVolume());
   }
 
   // Per ora perche mov vuole solo 16 bit